@@ -0,0 +1,51 @@
+#include "../src/driver.h"
+#include "../src/optimizer.h"
+#include "bench_util.h"
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+/** 批量编译扩展性基准测试：
+ * 生成若干合成源文件，按 -O2 并生成汇编与字节码执行结果，分别用 1、2、4……直到 N 个线程批量编译，
+ * 报告吞吐量（文件/秒）与相对单线程的加速比
+ * 用法：./bench_batch [文件数，默认400] [每个文件的变量数，默认200] [最大线程数，默认为CPU核数]
+ */
+
+int main(int argc, char* argv[]) {
+    int fileCount = argc > 1 ? std::atoi(argv[1]) : 400;
+    int vars = argc > 2 ? std::atoi(argv[2]) : 200;
+    int maxThreads = argc > 3 ? std::atoi(argv[3]) : (int)std::thread::hardware_concurrency();
+    maxThreads = std::max(1, maxThreads);
+    std::string inputDir = "bench_batch_input", outRoot = "bench_batch_output";
+    std::filesystem::create_directories(inputDir);
+    for (int i = 0; i < fileCount; ++i) generateSource(inputDir + "/p" + std::to_string(i) + ".txt", vars + i % 16);
+    std::vector<std::string> inputs = listSourceFiles(inputDir);
+
+    CompileOptions options;
+    options.passes = passesForLevel(2);
+    options.emitAsm = true;
+    options.run = true;
+    std::vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    std::cout << std::right << std::setw(8) << "线程数" << std::setw(12) << "耗时(ms)" << std::setw(14) << "文件/秒"
+              << std::setw(10) << "加速比" << "\n";
+    double singleMs = 0;
+    for (int threads : threadCounts) {
+        std::filesystem::remove_all(outRoot);
+        BatchResult result = compileBatch(inputs, outRoot, options, threads);
+        if (result.failed != 0) {
+            std::cerr << result.failed << " 个文件编译失败\n";
+            return 1;
+        }
+        if (threads == 1) singleMs = result.elapsedMs;
+        std::cout << std::setw(8) << threads << std::setw(12) << std::fixed << std::setprecision(1) << result.elapsedMs
+                  << std::setw(14) << result.files * 1000.0 / result.elapsedMs << std::setw(10) << std::setprecision(2)
+                  << singleMs / result.elapsedMs << "\n";
+    }
+    std::filesystem::remove_all(inputDir);
+    std::filesystem::remove_all(outRoot);
+    return 0;
+}
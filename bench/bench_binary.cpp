@@ -0,0 +1,132 @@
+#include "../src/binary.h"
+#include "../src/semantic.h"
+#include "../src/ast_visualize.h"
+#include "bench_util.h"
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+/** 输出格式基准测试：
+ * 合成源文件经词法、语法、语义分析与IR生成后，分别以文本（tokens.txt、两个符号表、ast.dot、ir.txt）
+ * 与二进制容器 out.mjb 写出，比较写出耗时、读回耗时与文件总大小
+ *   文本读回：下游工具重新解析各文本文件（token与四元式拆成字段，其余按行读入）
+ *   二进制读回：mmap 打开容器并遍历各节的全部记录，并校验读到的 token 与内存中的一致
+ * 用法：./bench_binary [变量数，默认100000]
+ */
+
+static const char* const TEXT_FILES[] = {"tokens.txt", "identifier_table.txt", "constant_table.txt", "ast.dot",
+                                         "ir.txt"};
+
+static void writeTokenText(const std::vector<Token>& tokens, const std::string& filename) {
+    std::ofstream fout(filename);
+    for (const Token& tok : tokens) fout << tok.type << " " << tok.value << "\n";
+}
+
+static void writeTable(const Interner& table, const std::string& filename) {
+    std::ofstream fout(filename);
+    for (size_t i = 0; i < table.size(); ++i) fout << i << ": " << table[i] << "\n";
+}
+
+// 重新解析文本输出，返回读到的字段数，防止读取被优化掉
+static size_t readText(const std::string& dir) {
+    size_t fields = 0;
+    std::ifstream tokens(dir + "/tokens.txt");
+    for (int type, value; tokens >> type >> value;) fields += 2;
+    for (const char* name : {"identifier_table.txt", "constant_table.txt", "ast.dot"}) {
+        std::ifstream fin(dir + "/" + name);
+        for (std::string line; std::getline(fin, line);) ++fields;
+    }
+    std::ifstream ir(dir + "/ir.txt");
+    for (std::string line; std::getline(ir, line);) {
+        std::istringstream quad(line);
+        for (std::string field; quad >> field;) ++fields;
+    }
+    return fields;
+}
+
+static uint64_t totalSize(const std::string& dir, std::initializer_list<std::string> names) {
+    uint64_t bytes = 0;
+    for (const std::string& name : names) bytes += std::filesystem::file_size(dir + "/" + name);
+    return bytes;
+}
+
+int main(int argc, char* argv[]) {
+    int vars = argc > 1 ? std::atoi(argv[1]) : 100000;
+    std::string dir = "bench_binary_work";
+    std::filesystem::create_directories(dir);
+    generateSource(dir + "/input.txt", vars);
+
+    CompilationContext ctx;
+    std::vector<Token> tokens = runLexer(ctx, dir + "/input.txt");
+    AST ast = parse(ctx, tokens);
+    checkSemantics(ctx, ast);
+    IRProgram ir = generateIR(ctx, ast);
+
+    auto start = std::chrono::steady_clock::now();
+    writeTokenText(tokens, dir + "/tokens.txt");
+    writeTable(ctx.identifierTable, dir + "/identifier_table.txt");
+    writeTable(ctx.constantTable, dir + "/constant_table.txt");
+    exportASTtoDot(ctx, ast, dir + "/ast.dot");
+    {
+        std::ofstream irOut(dir + "/ir.txt");
+        writeIR(ir, irOut);
+    }
+    double textWrite = elapsedMs(start);
+    start = std::chrono::steady_clock::now();
+    size_t fields = readText(dir);
+    double textRead = elapsedMs(start);
+
+    std::string error;
+    start = std::chrono::steady_clock::now();
+    if (!writeBinary(dir + "/out.mjb", ctx, tokens, &ast, &ir, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    double binWrite = elapsedMs(start);
+    start = std::chrono::steady_clock::now();
+    BinaryFile file;
+    if (!file.open(dir + "/out.mjb", error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    // 遍历各节的全部记录
+    uint64_t checksum = 0;
+    const BinSection& tokenSection = *file.section(SEC_TOKENS);
+    const BinToken* binTokens = file.records<BinToken>(tokenSection);
+    for (uint64_t i = 0; i < tokenSection.count; ++i) checksum += binTokens[i].type + binTokens[i].value;
+    for (BinSectionKind kind : {SEC_IDENTIFIERS, SEC_CONSTANTS}) {
+        const BinSection& table = *file.section(kind);
+        for (uint64_t i = 0; i < table.count; ++i) checksum += file.string(table, i).size();
+    }
+    const BinSection& nodes = *file.section(SEC_AST);
+    for (uint64_t i = 0; i < nodes.count; ++i) checksum += file.records<BinNode>(nodes)[i].kind;
+    const BinSection& quads = *file.section(SEC_IR);
+    for (uint64_t i = 0; i < quads.count; ++i) checksum += file.records<BinQuad>(quads)[i].arg1;
+    double binRead = elapsedMs(start);
+
+    bool same = tokenSection.count == tokens.size();
+    for (size_t i = 0; same && i < tokens.size(); ++i) {
+        same = binTokens[i].type == tokens[i].type && binTokens[i].value == tokens[i].value &&
+               binTokens[i].line == tokens[i].line && binTokens[i].column == tokens[i].column;
+    }
+    if (!same) {
+        std::cerr << "容器中的 token流与内存中的不一致\n";
+        return 1;
+    }
+
+    uint64_t textBytes = totalSize(dir, {TEXT_FILES[0], TEXT_FILES[1], TEXT_FILES[2], TEXT_FILES[3], TEXT_FILES[4]});
+    uint64_t binBytes = totalSize(dir, {"out.mjb"});
+    std::filesystem::remove_all(dir);
+
+    std::cout << tokens.size() << " 个token，" << ast.nodes.size() << " 个AST节点，" << ir.size() << " 条四元式"
+              << "（文本字段 " << fields << "，校验和 " << checksum << "）\n";
+    std::cout << std::left << std::setw(10) << "格式" << std::right << std::setw(14) << "写出(ms)" << std::setw(14)
+              << "读回(ms)" << std::setw(14) << "大小(KB)" << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(10) << "文本" << std::right << std::setw(14) << textWrite << std::setw(14)
+              << textRead << std::setw(14) << textBytes / 1024.0 << "\n";
+    std::cout << std::left << std::setw(10) << "二进制" << std::right << std::setw(14) << binWrite << std::setw(14)
+              << binRead << std::setw(14) << binBytes / 1024.0 << "\n";
+    return 0;
+}
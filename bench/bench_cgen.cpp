@@ -0,0 +1,143 @@
+#include "../src/lex.h"
+#include "../src/parser.h"
+#include "../src/semantic.h"
+#include "../src/irgen.h"
+#include "../src/optimizer.h"
+#include "../src/vm.h"
+#include "../src/cgen.h"
+#include "bench_util.h"
+#include "ir_interp.h"
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+/** C 转译基准测试：两种嵌套循环合成程序按 -O0/-O2 优化后，比较三种执行方式的耗时（取 repeats 次中最短）与吞吐量：
+ *   interp：四元式参考解释器（ir_interp.h）
+ *   vm：带超指令的字节码虚拟机
+ *   native：emitC 生成的 C 源码经 cc -O2 编译后运行（耗时含进程启动，另列出 cc 的编译耗时）
+ * 程序：affine 为 generateLoopSource 的线性累加，cc 通常能在编译期求出循环的结果，native 的耗时接近进程启动；
+ *       recur 的累加值每次乘31再加（按64位回绕），循环必须逐次执行，反映生成代码本身的吞吐量
+ * 吞吐量按参考解释器执行的非标号四元式条数每秒计；native 的输出须与虚拟机的变量终值逐行相同
+ * 用法：./bench_cgen [循环组数，默认50] [外层迭代次数，默认20000] [重复次数，默认3]
+ */
+
+// 每组一个两层循环，内层的累加值依赖上一次的值做乘法，无法化为封闭形式
+static void generateRecurrenceSource(const std::string& filename, int groups, int iterations) {
+    std::ofstream fout(filename);
+    fout << "class Main {\n    public static void main(String[] args) {\n";
+    for (int g = 0; g < groups; ++g) {
+        std::string i = "i" + std::to_string(g), j = "j" + std::to_string(g), h = "h" + std::to_string(g);
+        fout << "        int " << h << " = " << g + 1 << ";\n"
+             << "        int " << i << " = 0;\n"
+             << "        while (" << i << " < " << iterations << ") {\n"
+             << "            int " << j << " = 0;\n"
+             << "            while (" << j << " < 8) {\n"
+             << "                " << h << " = " << h << " * 31 + " << i << " - " << j << ";\n"
+             << "                " << j << " = " << j << " + 1;\n"
+             << "            }\n"
+             << "            " << i << " = " << i << " + 1;\n"
+             << "        }\n";
+    }
+    fout << "    }\n}\n$\n";
+}
+
+template <typename Run>
+static double bestOf(int repeats, Run run) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, elapsedMs(start));
+    }
+    return best;
+}
+
+// 运行编译好的程序，返回其标准输出
+static bool runProgram(const std::string& path, std::string& output) {
+    FILE* pipe = popen(path.c_str(), "r");
+    if (!pipe) return false;
+    output.clear();
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) output.append(buffer, n);
+    return pclose(pipe) == 0;
+}
+
+int main(int argc, char* argv[]) {
+    int groups = argc > 1 ? std::atoi(argv[1]) : 50;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20000;
+    int repeats = argc > 3 ? std::atoi(argv[3]) : 3;
+    std::string filename = "bench_cgen_input.txt", source = "bench_cgen_prog.c", program = "./bench_cgen_prog";
+
+    std::cout << std::left << std::setw(8) << "程序" << std::setw(6) << "级别" << std::setw(8) << "方式" << std::right
+              << std::setw(14) << "四元式条数" << std::setw(12) << "耗时(ms)" << std::setw(14) << "百万条/秒"
+              << std::setw(10) << "加速比" << "\n";
+    bool ok = true;
+    for (const char* workload : {"affine", "recur"}) {
+        if (workload[0] == 'a') generateLoopSource(filename, groups, iterations);
+        else generateRecurrenceSource(filename, groups, iterations);
+        CompilationContext ctx;
+        std::vector<Token> tokens = runLexer(ctx, filename);
+        std::remove(filename.c_str());
+        AST ast = parse(ctx, tokens);
+        if (!ctx.parseErrors.empty() || !checkSemantics(ctx, ast)) {
+            std::cerr << workload << "：合成程序有误\n";
+            return 1;
+        }
+        IRProgram base = generateIR(ctx, ast);
+
+        for (int level : {0, 2}) {
+            IRProgram ir = base;
+            std::vector<PassStats> stats;
+            std::string error;
+            runPasses(ir, passesForLevel(level), stats, error);
+            ExecCounts counts;
+            interpretIR(ir, counts);
+            uint64_t quads = counts.total - counts.byOp[OP_LABEL];
+            std::string label = std::string(workload) + " -O" + std::to_string(level);
+
+            double interpMs = bestOf(repeats, [&] {
+                ExecCounts discarded;
+                interpretIR(ir, discarded);
+            });
+            Bytecode bc = compileBytecode(ir, true);
+            std::vector<int64_t> registers;
+            double vmMs = bestOf(repeats, [&] { registers = runBytecode(bc); });
+            std::ostringstream expected;
+            writeFinalValues(ir, registers, expected);
+
+            {
+                std::ofstream fout(source);
+                emitC(ir, fout);
+            }
+            auto start = std::chrono::steady_clock::now();
+            if (std::system(("cc -O2 -o " + program + " " + source).c_str()) != 0) {
+                std::cerr << label << "：cc 编译失败\n";
+                return 1;
+            }
+            double ccMs = elapsedMs(start);
+            std::string output;
+            bool ran = true;
+            double nativeMs = bestOf(repeats, [&] { ran = runProgram(program, output) && ran; });
+            std::remove(source.c_str());
+            std::remove(program.c_str());
+            if (!ran || output != expected.str()) {
+                std::cerr << label << "：native 的输出与虚拟机不一致\n";
+                ok = false;
+            }
+
+            auto report = [&](const char* name, double ms) {
+                std::cout << std::left << std::setw(8) << workload << std::setw(6) << ("-O" + std::to_string(level))
+                          << std::setw(8) << name << std::right << std::setw(14) << quads << std::setw(12) << std::fixed
+                          << std::setprecision(3) << ms << std::setw(14) << std::setprecision(1) << quads / ms / 1000
+                          << std::setw(10) << std::setprecision(2) << interpMs / ms << "\n";
+            };
+            report("interp", interpMs);
+            report("vm", vmMs);
+            report("native", nativeMs);
+            std::cout << "              cc -O2 编译: " << std::fixed << std::setprecision(1) << ccMs << " ms\n";
+        }
+    }
+    return ok ? 0 : 1;
+}
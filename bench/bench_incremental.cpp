@@ -0,0 +1,212 @@
+#include "../src/incremental.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+/** 增量分析基准测试：
+ * 在合成源文件上按固定随机种子录制一段编辑会话，然后逐条回放：
+ *   在某行后新起一行逐字符键入赋值语句，再逐字符退格删除并合并回上一行
+ *   修改整数常量、重命名变量后改回、删掉分号后补回
+ *   粘贴多行 while 语句块，之后整体删除
+ * 每条编辑后对编辑后的全文完整做一次词法与语法分析，校验 token流、AST（从根逐节点比较）、
+ * 词法错误与语法错误都与增量结果一致，并统计两者每次编辑的延迟 p50/p99/最大值
+ * 用法：./bench_incremental [变量数，默认5000] [编辑片段数，默认200]
+ */
+
+// 与 IncrementalDocument 相同的文本替换，用于录制时跟踪每步编辑后的各行
+static void applyToLines(std::vector<std::string>& lines, const TextEdit& edit) {
+    std::string merged = lines[edit.startLine - 1].substr(0, edit.startColumn - 1) + edit.text +
+                         lines[edit.endLine - 1].substr(edit.endColumn - 1);
+    std::vector<std::string> replacement;
+    std::istringstream in(merged);
+    for (std::string line; std::getline(in, line);) replacement.push_back(line);
+    if (merged.empty() || merged.back() == '\n') replacement.push_back("");
+    lines.erase(lines.begin() + edit.startLine - 1, lines.begin() + edit.endLine);
+    lines.insert(lines.begin() + edit.startLine - 1, replacement.begin(), replacement.end());
+}
+
+class SessionRecorder {
+public:
+    SessionRecorder(std::vector<std::string> lines) : lines(std::move(lines)) {}
+
+    void edit(int startLine, int startColumn, int endLine, int endColumn, const std::string& text) {
+        TextEdit e{startLine, startColumn, endLine, endColumn, text};
+        applyToLines(lines, e);
+        edits.push_back(e);
+    }
+    int lineEnd(int line) const { return lines[line - 1].size() + 1; }
+
+    std::vector<std::string> lines;
+    std::vector<TextEdit> edits;
+};
+
+static std::vector<TextEdit> recordSession(const std::string& source, int episodes) {
+    std::vector<std::string> initial;
+    std::istringstream in(source);
+    for (std::string line; std::getline(in, line);) initial.push_back(line);
+    initial.push_back("");
+    SessionRecorder rec(initial);
+    std::mt19937 rng(12345);
+
+    // 语句行位于 main 的 { 之后、main 的 } 之前（最后4行是 "    }"、"}"、"$" 和空行）
+    auto statementLine = [&] { return 3 + (int)(rng() % (rec.lines.size() - 6)); };
+    // 以 prefix 开头的语句行，找不到时返回0
+    auto findLine = [&](const std::string& prefix) {
+        for (int tries = 0; tries < 64; ++tries) {
+            int line = statementLine();
+            if (rec.lines[line - 1].compare(0, prefix.size(), prefix) == 0) return line;
+        }
+        return 0;
+    };
+
+    for (int e = 0; e < episodes; ++e) {
+        switch (e % 5) {
+        case 0: { // 新起一行逐字符键入，再逐字符退格并合并回上一行
+            int line = statementLine();
+            std::string var = "v" + std::to_string(rng() % 64);
+            std::string stmt = var + " = " + var + " + " + std::to_string(rng() % 1000) + ";";
+            rec.edit(line, rec.lineEnd(line), line, rec.lineEnd(line), "\n        ");
+            for (size_t i = 0; i < stmt.size(); ++i) rec.edit(line + 1, 9 + i, line + 1, 9 + i, stmt.substr(i, 1));
+            for (size_t i = stmt.size(); i > 0; --i) rec.edit(line + 1, 8 + i, line + 1, 9 + i, "");
+            rec.edit(line, rec.lineEnd(line), line + 1, rec.lineEnd(line + 1), "");
+            break;
+        }
+        case 1: { // 修改整数常量
+            int line = findLine("        int v");
+            if (!line) break;
+            size_t eq = rec.lines[line - 1].find("= ") + 2, semi = rec.lines[line - 1].find(';');
+            rec.edit(line, eq + 1, line, semi + 1, std::to_string(rng() % 100000));
+            break;
+        }
+        case 2: { // 重命名赋值语句的目标变量后改回
+            int line = findLine("        v");
+            if (!line) break;
+            size_t space = rec.lines[line - 1].find(' ', 8);
+            std::string name = rec.lines[line - 1].substr(8, space - 8);
+            rec.edit(line, 9, line, space + 1, "renamed" + name);
+            rec.edit(line, 9, line, 9 + 7 + name.size(), name);
+            break;
+        }
+        case 3: { // 删掉分号（产生语法错误）后补回
+            int line = findLine("        int v");
+            if (!line) break;
+            size_t semi = rec.lines[line - 1].find(';');
+            rec.edit(line, semi + 1, line, semi + 2, "");
+            rec.edit(line, semi + 1, line, semi + 1, ";");
+            break;
+        }
+        case 4: { // 粘贴多行语句块，之后整体删除
+            int line = statementLine();
+            std::string var = "v" + std::to_string(rng() % 64);
+            rec.edit(line, rec.lineEnd(line), line, rec.lineEnd(line),
+                     "\n        while (" + var + " < 10) {\n            " + var + " = " + var +
+                         " + 1;\n            if (" + var + " < 5) { " + var + " = 5; } else { " + var +
+                         " = 6; }\n        }");
+            rec.edit(line, rec.lineEnd(line), line + 4, rec.lineEnd(line + 4), "");
+            break;
+        }
+        }
+    }
+    return rec.edits;
+}
+
+static bool sameTokens(const std::vector<Token>& x, const std::vector<Token>& y) {
+    return std::equal(x.begin(), x.end(), y.begin(), y.end(), [](const Token& s, const Token& t) {
+        return s.type == t.type && s.value == t.value && s.line == t.line && s.column == t.column;
+    });
+}
+
+// 从根开始逐节点比较两棵树的结构，节点id可以不同
+static bool sameTree(const AST& x, const AST& y) {
+    std::vector<std::pair<NodeId, NodeId>> stack{{x.root, y.root}};
+    while (!stack.empty()) {
+        auto [u, v] = stack.back();
+        stack.pop_back();
+        if (u == NO_NODE || v == NO_NODE) {
+            if (u != v) return false;
+            continue;
+        }
+        const ASTNode &s = x[u], &t = y[v];
+        if (s.kind != t.kind || s.varType != t.varType || s.value != t.value || s.line != t.line ||
+            s.childCount != t.childCount) {
+            return false;
+        }
+        for (uint32_t i = 0; i < s.childCount; ++i) stack.push_back({x.child(s, i), y.child(t, i)});
+    }
+    return true;
+}
+
+static bool sameErrors(const CompilationContext& ctx, const std::vector<LexError>& lexErrors,
+                       const std::vector<ParseError>& parseErrors) {
+    return std::equal(ctx.lexErrors.begin(), ctx.lexErrors.end(), lexErrors.begin(), lexErrors.end(),
+                      [](const LexError& s, const LexError& t) {
+                          return s.type == t.type && s.line == t.line && s.column == t.column &&
+                                 s.message == t.message;
+                      }) &&
+           std::equal(ctx.parseErrors.begin(), ctx.parseErrors.end(), parseErrors.begin(), parseErrors.end(),
+                      [](const ParseError& s, const ParseError& t) {
+                          return s.message == t.message && s.line == t.line && s.column == t.column;
+                      });
+}
+
+static void report(const char* name, std::vector<double> ms) {
+    std::sort(ms.begin(), ms.end());
+    double p50 = ms[ms.size() / 2], p99 = ms[std::min(ms.size() - 1, ms.size() * 99 / 100)];
+    std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(4)
+              << std::setw(12) << p50 << std::setw(12) << p99 << std::setw(12) << ms.back() << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    int vars = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int episodes = argc > 2 ? std::atoi(argv[2]) : 200;
+    generateSource("bench_incremental_input.txt", vars);
+    std::ifstream fin("bench_incremental_input.txt");
+    std::string source((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+    std::remove("bench_incremental_input.txt");
+    std::vector<TextEdit> edits = recordSession(source, episodes);
+
+    std::ostringstream sink; // 完整分析时输出的词法错误
+    CompilationContext ctx;
+    ctx.diagnostics = &sink;
+    IncrementalDocument doc(ctx, source);
+
+    std::vector<double> incremental, full;
+    size_t fallbacks = 0, reparsedTokens = 0;
+    for (size_t i = 0; i < edits.size(); ++i) {
+        auto start = std::chrono::steady_clock::now();
+        EditStats stats = doc.applyEdit(edits[i]);
+        incremental.push_back(elapsedMs(start));
+        fallbacks += stats.fullReparse;
+        reparsedTokens += stats.reparsedTokens;
+
+        // 完整分析会覆盖 ctx 中的错误列表，先取出增量结果
+        std::string text = doc.text();
+        std::vector<LexError> lexErrors = ctx.lexErrors;
+        std::vector<ParseError> parseErrors = ctx.parseErrors;
+        start = std::chrono::steady_clock::now();
+        std::vector<Token> tokens = runLexerBuffer(ctx, text);
+        AST ast = parse(ctx, tokens);
+        full.push_back(elapsedMs(start));
+
+        bool same = sameTokens(tokens, doc.tokens()) && sameTree(ast, doc.ast()) &&
+                    sameErrors(ctx, lexErrors, parseErrors);
+        ctx.lexErrors = std::move(lexErrors);
+        ctx.parseErrors = std::move(parseErrors);
+        if (!same) {
+            std::cerr << "第 " << i + 1 << " 次编辑（第 " << edits[i].startLine << " 行）后增量结果与完整分析不一致\n";
+            return 1;
+        }
+    }
+
+    std::cout << "源文件 " << doc.tokens().size() << " 个token，回放 " << edits.size() << " 次编辑，其中 " << fallbacks
+              << " 次整体重新分析，平均每次重新分析 " << reparsedTokens / edits.size() << " 个token\n";
+    std::cout << std::left << std::setw(16) << "方式" << std::right << std::setw(12) << "p50(ms)" << std::setw(12)
+              << "p99(ms)" << std::setw(12) << "max(ms)" << "\n";
+    report("增量分析", incremental);
+    report("完整分析", full);
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "../src/lex.h"
+#include "../src/context.h"
+#include "bench_util.h"
+#include "lexer_reference.h"
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+/** 词法分析基准测试：
+ * 生成包含大量互不相同标识符的合成源文件，分别统计以下词法分析的吞吐量（token/s 与 MB/s，取 rounds 次中最快的一次）：
+ *   reference：参照实现（lexer_reference.h，cctype 分类 + unordered_map 关键字表）
+ *   runLexer：逐行读入，表驱动DFA
+ *   runLexerMapped：内存映射，表驱动DFA
+ * 并以参照实现为准逐个比较token与词法错误
+ * 用法：./bench_lexer [标识符数量，默认100000] [重复次数，默认5]
+ */
+
+static bool sameToken(const Token& a, const Token& b) {
+    return a.type == b.type && a.value == b.value && a.line == b.line && a.column == b.column;
+}
+
+static bool sameErrors(const std::vector<LexError>& a, const std::vector<LexError>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].type != b[i].type || a[i].line != b[i].line || a[i].column != b[i].column ||
+            a[i].problematicChar != b[i].problematicChar) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 第一个不同的token位置，完全相同时返回 SIZE_MAX
+static size_t firstMismatch(const std::vector<Token>& expected, const std::vector<Token>& actual) {
+    for (size_t i = 0; i < std::min(expected.size(), actual.size()); ++i) {
+        if (!sameToken(expected[i], actual[i])) return i;
+    }
+    return expected.size() == actual.size() ? SIZE_MAX : std::min(expected.size(), actual.size());
+}
+
+struct LexRun {
+    double ms = 1e300;
+    std::vector<Token> tokens;
+    std::vector<LexError> errors;
+};
+
+// 每轮使用新的上下文，符号表从空开始
+template <typename Lexer>
+static LexRun measure(int rounds, Lexer lexer) {
+    LexRun run;
+    for (int i = 0; i < rounds; ++i) {
+        std::ostringstream discarded;
+        CompilationContext ctx;
+        ctx.diagnostics = &discarded;
+        auto start = std::chrono::steady_clock::now();
+        run.tokens = lexer(ctx);
+        run.ms = std::min(run.ms, elapsedMs(start));
+        run.errors = ctx.lexErrors;
+    }
+    return run;
+}
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::string filename = "bench_lexer_input.txt";
+    generateSource(filename, count);
+    std::ifstream fin(filename, std::ios::binary | std::ios::ate);
+    double mb = fin.tellg() / (1024.0 * 1024.0);
+    fin.close();
+
+    LexRun reference = measure(rounds, [&](CompilationContext& ctx) { return reference::runLexer(ctx, filename); });
+    LexRun line = measure(rounds, [&](CompilationContext& ctx) { return runLexer(ctx, filename); });
+    LexRun mapped = measure(rounds, [&](CompilationContext& ctx) { return runLexerMapped(ctx, filename); });
+    std::remove(filename.c_str());
+
+    double tokens = reference.tokens.size();
+    std::cout << "输入大小: " << mb << " MB\n"
+              << "token数: " << reference.tokens.size() << "\n";
+    auto report = [&](const char* name, const LexRun& run) {
+        std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << run.ms << " ms" << std::setw(10) << tokens / run.ms / 1000 << " Mtoken/s"
+                  << std::setw(10) << mb / run.ms * 1000 << " MB/s" << std::setw(8) << reference.ms / run.ms << "x\n";
+    };
+    report("reference", reference);
+    report("runLexer", line);
+    report("runLexerMapped", mapped);
+
+    bool ok = true;
+    const std::pair<const char*, const LexRun*> checks[] = {{"runLexer", &line}, {"runLexerMapped", &mapped}};
+    for (const auto& [name, run] : checks) {
+        size_t mismatch = firstMismatch(reference.tokens, run->tokens);
+        if (mismatch != SIZE_MAX) {
+            std::cerr << name << "：token流与参照实现不一致，位置: " << mismatch << "\n";
+            ok = false;
+        }
+        if (!sameErrors(reference.errors, run->errors)) {
+            std::cerr << name << "：词法错误与参照实现不一致\n";
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
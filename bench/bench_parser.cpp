@@ -0,0 +1,41 @@
+#include "../src/lex.h"
+#include "../src/parser.h"
+#include "../src/context.h"
+#include "../src/stats.h"
+#include "bench_util.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+/** 语法分析基准测试：
+ * 统计 parse 阶段的耗时、堆分配次数/字节数、AST节点数及进程峰值内存
+ * 用法：./bench_parser [变量数量，默认100000]
+ */
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    std::string filename = "bench_parser_input.txt";
+    generateSource(filename, count);
+    CompilationContext ctx;
+    std::vector<Token> tokens = runLexer(ctx, filename);
+    std::remove(filename.c_str());
+
+    uint64_t allocsBefore = threadAllocations, bytesBefore = threadAllocBytes;
+    auto start = std::chrono::steady_clock::now();
+    AST ast = parse(ctx, tokens);
+    double ms = elapsedMs(start);
+
+    std::cout << "token数: " << tokens.size() << "\n"
+              << "AST节点数: " << ast.nodes.size() << "\n"
+              << "语法错误数: " << ctx.parseErrors.size() << "\n"
+              << "parse耗时: " << ms << " ms\n"
+              << "parse分配次数: " << threadAllocations - allocsBefore << "\n"
+              << "parse分配字节: " << threadAllocBytes - bytesBefore << "\n"
+              << "峰值内存: " << peakRssKB() << " KB\n";
+
+    // 释放整棵树只需一次重置
+    start = std::chrono::steady_clock::now();
+    ast.reset();
+    std::cout << "释放耗时: " << elapsedMs(start) << " ms\n";
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include "../src/lex.h"
+#include "../src/parser.h"
+#include "../src/semantic.h"
+#include "../src/irgen.h"
+#include "bench_util.h"
+#include <cstdio>
+#include <iostream>
+
+/** 语义分析与中间代码生成基准测试：
+ * 对同一棵AST重复执行各遍，取最快一次，并折算为每个AST节点的耗时
+ * 用法：./bench_passes [变量数量，默认100000] [重复次数，默认5]
+ */
+
+template <typename Pass>
+static double bestOf(int rounds, Pass pass) {
+    double best = 1e300;
+    for (int i = 0; i < rounds; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        pass();
+        best = std::min(best, elapsedMs(start));
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::string filename = "bench_passes_input.txt";
+    generateSource(filename, count);
+    CompilationContext ctx;
+    std::vector<Token> tokens = runLexer(ctx, filename);
+    std::remove(filename.c_str());
+    AST ast = parse(ctx, tokens);
+    double nodes = ast.nodes.size();
+
+    size_t quads = 0;
+    double semanticMs = bestOf(rounds, [&] { checkSemantics(ctx, ast); });
+    double irgenMs = bestOf(rounds, [&] { quads = generateIR(ctx, ast).size(); });
+
+    std::cout << "AST节点数: " << ast.nodes.size() << "\n"
+              << "四元式数: " << quads << "\n"
+              << "checkSemantics: " << semanticMs << " ms (" << semanticMs * 1e6 / nodes << " ns/节点)\n"
+              << "generateIR: " << irgenMs << " ms (" << irgenMs * 1e6 / nodes << " ns/节点)\n";
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include "../src/server.h"
+#include "../src/optimizer.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/** 编译服务器延迟基准测试：
+ * 同一个合成源文件按 -O2 编译，分别统计每次请求的延迟 p50/p99：
+ *   冷启动：每次启动一个编译器进程直接编译（相当于构建系统逐个调用 test）
+ *   客户端进程：每次启动一个 test --connect 客户端进程，由常驻服务器编译
+ *   进程内请求：直接调用 sendRequest，只剩套接字通信与编译本身
+ * 服务器运行在本进程的线程中，并校验服务器返回的IR与冷启动写出的 ir.txt 一致
+ * 用法：./bench_server <新编译的test可执行文件> [请求数，默认200] [变量数，默认200]
+ */
+
+// 在 dir 中运行 argv 并等待结束，输出丢弃
+static int runProcess(const std::string& dir, const std::vector<std::string>& args) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (chdir(dir.c_str()) != 0) _exit(127);
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, 1);
+        dup2(null, 2);
+        std::vector<char*> argv;
+        for (const std::string& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+        argv.push_back(nullptr);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static void report(const char* name, std::vector<double> ms) {
+    std::sort(ms.begin(), ms.end());
+    double p50 = ms[ms.size() / 2], p99 = ms[std::min(ms.size() - 1, ms.size() * 99 / 100)];
+    std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(12) << p50 << std::setw(12) << p99 << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "用法: ./bench_server <test可执行文件> [请求数] [变量数]\n";
+        return 1;
+    }
+    std::string binary = std::filesystem::absolute(argv[1]).string();
+    int requests = argc > 2 ? std::atoi(argv[2]) : 200;
+    int vars = argc > 3 ? std::atoi(argv[3]) : 200;
+
+    // 按编译器的目录约定准备 src（工作目录）、test（输入）、res（输出）
+    std::string root = std::filesystem::absolute("bench_server_work").string();
+    std::string srcDir = root + "/src", socketPath = root + "/server.sock";
+    std::filesystem::create_directories(srcDir);
+    std::filesystem::create_directories(root + "/test");
+    std::filesystem::create_directories(root + "/res");
+    generateSource(root + "/test/input.txt", vars);
+
+    std::ostringstream serverLog;
+    std::thread server([&] { runServer(socketPath, serverLog); });
+    CompileRequest request;
+    request.path = root + "/test/input.txt";
+    request.passes = passesForLevel(2);
+    CompileResponse response;
+    std::string error;
+    for (int tries = 0; !sendRequest(socketPath, request, response, error); ++tries) {
+        if (tries == 100) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::vector<double> cold, client, inProcess;
+    for (int i = 0; i < requests; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        if (runProcess(srcDir, {binary, "-O2", "input.txt"}) != 0) {
+            std::cerr << "编译器进程执行失败: " << binary << "\n";
+            return 1;
+        }
+        cold.push_back(elapsedMs(start));
+    }
+    std::ifstream irFile(root + "/res/ir.txt");
+    std::string coldIR((std::istreambuf_iterator<char>(irFile)), std::istreambuf_iterator<char>());
+    if (response.ir != coldIR) {
+        std::cerr << "服务器返回的IR与直接编译的结果不一致\n";
+        return 1;
+    }
+    for (int i = 0; i < requests; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        if (runProcess(srcDir, {binary, "--connect=" + socketPath, "-O2", "input.txt"}) != 0) {
+            std::cerr << "客户端进程执行失败\n";
+            return 1;
+        }
+        client.push_back(elapsedMs(start));
+    }
+    for (int i = 0; i < requests; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        if (!sendRequest(socketPath, request, response, error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        inProcess.push_back(elapsedMs(start));
+    }
+
+    CompileRequest stop;
+    stop.phases = 0;
+    stop.shutdown = true;
+    sendRequest(socketPath, stop, response, error);
+    server.join();
+    std::filesystem::remove_all(root);
+
+    std::cout << std::left << std::setw(16) << "方式" << std::right << std::setw(12) << "p50(ms)" << std::setw(12)
+              << "p99(ms)" << "\n";
+    report("冷启动", cold);
+    report("客户端进程", client);
+    report("进程内请求", inProcess);
+    return 0;
+}
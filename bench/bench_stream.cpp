@@ -0,0 +1,147 @@
+#include "bench_util.h"
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/** 流式编译基准测试：
+ * 生成指定大小的源文件，在子进程中分别用默认方式与 --stream 编译，比较峰值常驻内存（子进程的 ru_maxrss）与耗时，
+ * 并校验两种方式写出的 tokens.txt、ir.txt、identifier_table.txt、constant_table.txt 完全相同
+ * 源文件只使用固定的256个变量名与有限的常量，符号表大小不随文件增长，内存差异只来自 token流、AST 与 IR
+ * 默认方式的内存约为源文件的数倍，超过 fullLimitMB 的文件只运行流式编译
+ * 用法：./bench_stream <新编译的test可执行文件> [各文件大小MB，默认16,128,2048] [fullLimitMB，默认128]
+ */
+
+static const int VARS = 256;
+
+// 生成约 bytes 字节的源文件：先声明所有变量，再循环写入赋值、if、while 与嵌套语句块
+static void generateStreamSource(const std::string& filename, uint64_t bytes) {
+    std::ofstream fout(filename);
+    fout << "class Main {\n    public static void main(String[] args) {\n";
+    for (int i = 0; i < VARS; ++i) fout << "        int v" << i << " = " << i << ";\n";
+    std::ostringstream chunk;
+    for (uint64_t i = 0; (uint64_t)fout.tellp() < bytes; ++i) {
+        std::string a = "v" + std::to_string(i % VARS), b = "v" + std::to_string(i * 7 % VARS),
+                    c = "v" + std::to_string(i * 13 % VARS), k = std::to_string(i % 1000);
+        chunk.str("");
+        chunk << "        " << a << " = " << b << " * 2 + (" << c << " - " << k << "); // 注释\n"
+              << "        if (" << a << " < " << k << ") { " << b << " = " << b << " + 1; } else { " << c << " = " << k
+              << "; }\n"
+              << "        while (" << a << " < " << k << ") { " << a << " = " << a << " + 1; }\n"
+              << "        {\n            " << b << " = " << b << " + " << c << ";\n        }\n";
+        fout << chunk.str();
+    }
+    fout << "    }\n}\n$\n";
+}
+
+struct RunResult {
+    int status = -1;
+    double seconds = 0;
+    long peakRssKB = 0;
+};
+
+// 在 dir 中运行 args，标准输出与错误丢弃
+static RunResult runProcess(const std::string& dir, const std::vector<std::string>& args) {
+    RunResult result;
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (chdir(dir.c_str()) != 0) _exit(127);
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, 1);
+        dup2(null, 2);
+        std::vector<char*> argv;
+        for (const std::string& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+        argv.push_back(nullptr);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    int status = 0;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    result.seconds = elapsedMs(start) / 1000;
+    result.peakRssKB = usage.ru_maxrss;
+    result.status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    return result;
+}
+
+static bool sameFile(const std::string& x, const std::string& y) {
+    std::ifstream fx(x, std::ios::binary), fy(y, std::ios::binary);
+    if (!fx || !fy) return false;
+    std::vector<char> bx(1 << 20), by(1 << 20);
+    while (true) {
+        fx.read(bx.data(), bx.size());
+        fy.read(by.data(), by.size());
+        if (fx.gcount() != fy.gcount() || !std::equal(bx.begin(), bx.begin() + fx.gcount(), by.begin())) return false;
+        if (fx.gcount() == 0) return true;
+    }
+}
+
+static void report(const char* name, uint64_t bytes, const RunResult& r) {
+    std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << r.seconds << std::setw(14) << r.peakRssKB / 1024.0 << std::setw(14)
+              << r.peakRssKB * 1024.0 / bytes << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "用法: ./bench_stream <test可执行文件> [各文件大小MB] [fullLimitMB]\n";
+        return 1;
+    }
+    std::string binary = std::filesystem::absolute(argv[1]).string();
+    std::string sizes = argc > 2 ? argv[2] : "16,128,2048";
+    uint64_t fullLimit = (argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 128) << 20;
+
+    std::string root = std::filesystem::absolute("bench_stream_work").string();
+    std::string srcDir = root + "/src", resDir = root + "/res";
+    std::filesystem::create_directories(srcDir);
+    std::filesystem::create_directories(root + "/test");
+    std::filesystem::create_directories(resDir);
+    const char* outputs[] = {"tokens.txt", "ir.txt", "identifier_table.txt", "constant_table.txt"};
+
+    std::istringstream list(sizes);
+    for (std::string item; std::getline(list, item, ',');) {
+        uint64_t bytes = std::strtoull(item.c_str(), nullptr, 10) << 20;
+        generateStreamSource(root + "/test/input.txt", bytes);
+        bytes = std::filesystem::file_size(root + "/test/input.txt");
+        std::cout << "源文件 " << std::fixed << std::setprecision(1) << bytes / 1048576.0 << " MB\n";
+        std::cout << std::left << std::setw(12) << "方式" << std::right << std::setw(10) << "耗时(s)" << std::setw(14)
+                  << "峰值RSS(MB)" << std::setw(14) << "RSS/源文件" << "\n";
+
+        bool full = bytes <= fullLimit;
+        if (full) {
+            RunResult r = runProcess(srcDir, {binary, "input.txt"});
+            if (r.status != 0) {
+                std::cerr << "默认方式编译失败\n";
+                return 1;
+            }
+            report("默认", bytes, r);
+            for (const char* name : outputs) {
+                std::filesystem::rename(resDir + "/" + name, resDir + "/full_" + name);
+            }
+        }
+        RunResult r = runProcess(srcDir, {binary, "--stream", "input.txt"});
+        if (r.status != 0) {
+            std::cerr << "流式编译失败\n";
+            return 1;
+        }
+        report("--stream", bytes, r);
+        if (full) {
+            for (const char* name : outputs) {
+                if (!sameFile(resDir + "/" + name, resDir + "/full_" + name)) {
+                    std::cerr << name << " 与默认方式的结果不一致\n";
+                    return 1;
+                }
+            }
+        } else {
+            std::cout << "（超过 " << (fullLimit >> 20) << " MB，未运行默认方式）\n";
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(resDir)) std::filesystem::remove(entry.path());
+    }
+    std::filesystem::remove_all(root);
+    return 0;
+}
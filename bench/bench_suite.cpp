@@ -0,0 +1,217 @@
+#include "../src/lex.h"
+#include "../src/parser.h"
+#include "../src/semantic.h"
+#include "../src/irgen.h"
+#include "../src/optimizer.h"
+#include "../src/codegen.h"
+#include "../src/context.h"
+#include "bench_util.h"
+#include "program_gen.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+/** 基准测试套件：
+ * 用 program_gen.h 按几组参数生成合成程序作为语料，每个程序在进程内依次运行
+ * lex（内存中的源码）、parse、semantic、irgen、optimize（-O2）、codegen（x86-64 汇编写入内存），
+ * 重复 repeat 次取各阶段的最短耗时，输出各阶段的 MB/s（源文件字节数/耗时）与 tokens/s
+ * 结果写成 JSON（每条结果一行），--compare 读入之前保存的 JSON，逐条比较耗时，变慢超过 threshold% 时返回1
+ * 用法：./bench_suite [--repeat=3] [--scale=1] [--label=名称] [--json=结果.json] [--compare=旧结果.json]
+ *                     [--threshold=10] [--emit-corpus=目录]
+ *   scale 按倍数放大各语料的语句数；--emit-corpus 只把语料写入目录，不运行基准
+ */
+
+struct Corpus {
+    const char* name;
+    GenOptions options;
+};
+
+struct PhaseResult {
+    std::string corpus;
+    std::string phase;
+    double ms = 0;
+    double mbPerSec = 0;
+    double tokensPerSec = 0;
+};
+
+static std::vector<Corpus> makeCorpora(int scale) {
+    std::vector<Corpus> corpora;
+    auto add = [&](const char* name, int statements, int identifiers, int exprDepth, int nesting, int stringPercent) {
+        GenOptions o;
+        o.statements = statements * scale;
+        o.identifiers = identifiers;
+        o.exprDepth = exprDepth;
+        o.nesting = nesting;
+        o.stringPercent = stringPercent;
+        o.seed = corpora.size() + 1;
+        corpora.push_back({name, o});
+    };
+    add("base", 20000, 1000, 3, 3, 10); // 一般的程序
+    add("wide_ids", 20000, 50000, 3, 2, 10); // 大量不同的标识符，符号表的压力
+    add("deep_expr", 5000, 1000, 10, 2, 5); // 深层表达式
+    add("deep_nest", 10000, 1000, 2, 10, 10); // 深层 if/while/语句块嵌套
+    add("strings", 20000, 500, 2, 2, 70); // 以 String 赋值为主
+    return corpora;
+}
+
+// 对一个程序运行各阶段 repeat 次，每阶段取最短耗时
+static bool runCorpus(const std::string& name, const std::string& source, int repeat,
+                      std::vector<PhaseResult>& results) {
+    static const char* const phases[] = {"lex", "parse", "semantic", "irgen", "optimize", "codegen"};
+    double best[6];
+    std::fill(best, best + 6, 1e300);
+    size_t tokenCount = 0;
+    std::ostringstream discarded;
+    for (int r = 0; r < repeat; ++r) {
+        CompilationContext ctx;
+        ctx.diagnostics = &discarded;
+        double ms[6];
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Token> tokens = runLexerBuffer(ctx, source);
+        ms[0] = elapsedMs(start);
+        start = std::chrono::steady_clock::now();
+        AST ast = parse(ctx, tokens);
+        ms[1] = elapsedMs(start);
+        start = std::chrono::steady_clock::now();
+        checkSemantics(ctx, ast);
+        ms[2] = elapsedMs(start);
+        if (!ctx.lexErrors.empty() || !ctx.parseErrors.empty() || ctx.semanticErrors > 0) {
+            std::cerr << name << "：生成的程序有误\n" << discarded.str();
+            return false;
+        }
+        start = std::chrono::steady_clock::now();
+        IRProgram ir = generateIR(ctx, ast);
+        ms[3] = elapsedMs(start);
+        start = std::chrono::steady_clock::now();
+        std::vector<PassStats> stats;
+        std::string error;
+        runPasses(ir, passesForLevel(2), stats, error);
+        ms[4] = elapsedMs(start);
+        std::ostringstream assembly;
+        start = std::chrono::steady_clock::now();
+        emitAssembly(ir, assembly);
+        ms[5] = elapsedMs(start);
+        for (int p = 0; p < 6; ++p) best[p] = std::min(best[p], ms[p]);
+        tokenCount = tokens.size();
+    }
+    for (int p = 0; p < 6; ++p) {
+        PhaseResult result;
+        result.corpus = name;
+        result.phase = phases[p];
+        result.ms = best[p];
+        result.mbPerSec = source.size() / 1048576.0 / (best[p] / 1000);
+        result.tokensPerSec = tokenCount / (best[p] / 1000);
+        results.push_back(result);
+    }
+    return true;
+}
+
+static void writeJson(const std::string& label, int repeat, int scale, const std::vector<PhaseResult>& results,
+                      std::ostream& out) {
+    out << "{\"label\":\"" << label << "\",\"repeat\":" << repeat << ",\"scale\":" << scale << ",\"results\":[\n";
+    out << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const PhaseResult& r = results[i];
+        out << "{\"corpus\":\"" << r.corpus << "\",\"phase\":\"" << r.phase << "\",\"ms\":" << r.ms
+            << ",\"mb_per_s\":" << r.mbPerSec << ",\"tokens_per_s\":" << std::setprecision(0) << r.tokensPerSec
+            << std::setprecision(3) << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]}\n";
+}
+
+// 读入 writeJson 写出的文件：每条结果一行，取 corpus、phase 与 ms
+static std::map<std::string, double> readJson(const std::string& filename) {
+    std::map<std::string, double> ms;
+    std::ifstream fin(filename);
+    auto field = [](const std::string& line, const std::string& key) {
+        size_t pos = line.find("\"" + key + "\":");
+        if (pos == std::string::npos) return std::string();
+        pos += key.size() + 3;
+        if (line[pos] == '"') return line.substr(pos + 1, line.find('"', pos + 1) - pos - 1);
+        return line.substr(pos, line.find_first_of(",}", pos) - pos);
+    };
+    for (std::string line; std::getline(fin, line);) {
+        std::string corpus = field(line, "corpus"), phase = field(line, "phase"), value = field(line, "ms");
+        if (!corpus.empty() && !phase.empty() && !value.empty()) ms[corpus + "/" + phase] = std::atof(value.c_str());
+    }
+    return ms;
+}
+
+int main(int argc, char* argv[]) {
+    int repeat = 3, scale = 1;
+    double threshold = 10;
+    std::string label = "local", jsonPath, comparePath, corpusDir;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 9, "--repeat=") == 0) repeat = std::max(1, std::atoi(arg.c_str() + 9));
+        else if (arg.compare(0, 8, "--scale=") == 0) scale = std::max(1, std::atoi(arg.c_str() + 8));
+        else if (arg.compare(0, 8, "--label=") == 0) label = arg.substr(8);
+        else if (arg.compare(0, 7, "--json=") == 0) jsonPath = arg.substr(7);
+        else if (arg.compare(0, 10, "--compare=") == 0) comparePath = arg.substr(10);
+        else if (arg.compare(0, 12, "--threshold=") == 0) threshold = std::atof(arg.c_str() + 12);
+        else if (arg.compare(0, 14, "--emit-corpus=") == 0) corpusDir = arg.substr(14);
+        else {
+            std::cerr << "未知参数: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<Corpus> corpora = makeCorpora(scale);
+    if (!corpusDir.empty()) {
+        std::filesystem::create_directories(corpusDir);
+        for (const Corpus& c : corpora) {
+            std::ofstream fout(corpusDir + "/" + c.name + ".txt");
+            generateProgram(c.options, fout);
+        }
+        return 0;
+    }
+
+    std::vector<PhaseResult> results;
+    std::cout << std::left << std::setw(12) << "语料" << std::setw(12) << "阶段" << std::right << std::setw(12)
+              << "耗时(ms)" << std::setw(12) << "MB/s" << std::setw(16) << "Mtokens/s" << "\n";
+    for (const Corpus& c : corpora) {
+        std::ostringstream source;
+        generateProgram(c.options, source);
+        size_t first = results.size();
+        if (!runCorpus(c.name, source.str(), repeat, results)) return 1;
+        std::cout << c.name << "：" << std::fixed << std::setprecision(1) << source.str().size() / 1048576.0
+                  << " MB\n";
+        for (size_t i = first; i < results.size(); ++i) {
+            const PhaseResult& r = results[i];
+            std::cout << std::left << std::setw(10) << "" << std::setw(10) << r.phase << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(10) << r.ms << std::setw(12) << r.mbPerSec
+                      << std::setw(16) << r.tokensPerSec / 1e6 << "\n";
+        }
+    }
+
+    if (!jsonPath.empty()) {
+        std::filesystem::path parent = std::filesystem::path(jsonPath).parent_path();
+        if (!parent.empty()) std::filesystem::create_directories(parent);
+        std::ofstream fout(jsonPath);
+        writeJson(label, repeat, scale, results, fout);
+    }
+
+    if (comparePath.empty()) return 0;
+    std::map<std::string, double> base = readJson(comparePath);
+    if (base.empty()) {
+        std::cerr << "无法读取 " << comparePath << "\n";
+        return 1;
+    }
+    int regressions = 0;
+    std::cout << "\n与 " << comparePath << " 比较（耗时变化，正数为变慢）\n";
+    for (const PhaseResult& r : results) {
+        auto it = base.find(r.corpus + "/" + r.phase);
+        if (it == base.end() || it->second <= 0) continue;
+        double change = (r.ms / it->second - 1) * 100;
+        bool slower = change > threshold;
+        regressions += slower;
+        std::cout << std::left << std::setw(12) << r.corpus << std::setw(10) << r.phase << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(10) << change << "%" << (slower ? "  变慢" : "") << "\n";
+    }
+    std::cout << regressions << " 项变慢超过 " << threshold << "%\n";
+    return regressions == 0 ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+#include "../src/lex.h"
+#include "../src/parser.h"
+#include "../src/semantic.h"
+#include "../src/context.h"
+#include "bench_util.h"
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+/** 名字解析基准测试：每次变量引用（Var/Assign/VarDecl 节点）的平均耗时
+ *   slots：checkSemantics，按标识符id查作用域表并把槽位写入节点
+ *   names：对照组，以变量名为键的 unordered_map<string, string>，每次引用先 count 再 operator[]，不区分作用域
+ * 两组语料：flat 为 main 中声明的 n 个变量（generateSource），scoped 为 n/100 个并列的语句块，
+ * 各自声明同名的100个局部变量并嵌套一层内部语句块使用它们
+ * 用法：./bench_symbols [变量数，默认100000] [重复次数，默认5]
+ */
+
+template <typename Pass>
+static double bestOf(int rounds, Pass pass) {
+    double best = 1e300;
+    for (int i = 0; i < rounds; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        pass();
+        best = std::min(best, elapsedMs(start));
+    }
+    return best;
+}
+
+static std::string scopedSource(int count) {
+    std::ostringstream out;
+    out << "class Main {\n    public static void main(String[] args) {\n        int total = 0;\n";
+    for (int b = 0; b < count / 100; ++b) {
+        out << "        {\n";
+        for (int i = 0; i < 100; ++i) {
+            if (i % 10 == 0) out << "            String l" << i << " = \"block " << b << "\";\n";
+            else out << "            int l" << i << " = " << i + b << ";\n";
+        }
+        out << "            {\n";
+        for (int i = 1; i < 100; ++i) {
+            if (i % 10 != 0) out << "                total = total + l" << i << " * 2 - l" << i - 1 + (i % 10 == 1) << ";\n";
+        }
+        out << "            }\n        }\n";
+    }
+    out << "    }\n}\n$\n";
+    return out.str();
+}
+
+// 对照组：先序遍历，以变量名为键查找类型
+static size_t resolveByName(const CompilationContext& ctx, const AST& ast) {
+    std::unordered_map<std::string, std::string> symbols;
+    std::vector<NodeId> stack = {ast.root};
+    size_t found = 0;
+    while (!stack.empty()) {
+        NodeId id = stack.back();
+        stack.pop_back();
+        if (id == NO_NODE) continue;
+        const ASTNode& node = ast[id];
+        const std::string& name = nodeText(ctx, node);
+        if (node.kind == NK_VAR_DECL) symbols[name] = typeName(node.varType);
+        if ((node.kind == NK_VAR || node.kind == NK_ASSIGN) && symbols.count(name)) found += symbols[name].size();
+        for (const NodeId* c = ast.childEnd(node); c != ast.childBegin(node);) stack.push_back(*--c);
+    }
+    return found;
+}
+
+static void run(const char* name, const std::string& source, int rounds) {
+    std::ostringstream discarded;
+    CompilationContext ctx;
+    ctx.diagnostics = &discarded;
+    std::vector<Token> tokens = runLexerBuffer(ctx, source);
+    AST ast = parse(ctx, tokens);
+    size_t references = 0;
+    for (const ASTNode& node : ast.nodes) {
+        references += node.kind == NK_VAR || node.kind == NK_ASSIGN || node.kind == NK_VAR_DECL;
+    }
+
+    double slotsMs = bestOf(rounds, [&] { checkSemantics(ctx, ast); });
+    if (ctx.semanticErrors > 0) {
+        std::cerr << name << "：生成的程序有语义错误\n" << discarded.str();
+        std::exit(1);
+    }
+    size_t sink = 0;
+    double namesMs = bestOf(rounds, [&] { sink += resolveByName(ctx, ast); });
+
+    std::cout << std::left << std::setw(8) << name << std::right << std::setw(10) << references << std::fixed
+              << std::setprecision(2) << std::setw(12) << slotsMs << std::setw(12) << slotsMs * 1e6 / references
+              << std::setw(12) << namesMs << std::setw(12) << namesMs * 1e6 / references
+              << (sink == 0 ? " ?" : "") << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::string filename = "bench_symbols_input.txt";
+    generateSource(filename, count);
+    std::ifstream fin(filename);
+    std::ostringstream flat;
+    flat << fin.rdbuf();
+    fin.close();
+    std::remove(filename.c_str());
+
+    std::cout << std::left << std::setw(8) << "语料" << std::right << std::setw(10) << "引用数" << std::setw(12)
+              << "slots(ms)" << std::setw(12) << "ns/引用" << std::setw(12) << "names(ms)" << std::setw(12)
+              << "ns/引用" << "\n";
+    run("flat", flat.str(), rounds);
+    run("scoped", scopedSource(count), rounds);
+    return 0;
+}
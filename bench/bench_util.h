@@ -0,0 +1,64 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <sys/resource.h>
+
+/** 基准测试公共工具：合成源文件、计时、峰值内存
+ * 需要分配计数的基准程序与编译器一样链接 ../src/stats.cpp 与 ../src/alloc_hook.cpp，读取 stats.h 中的线程计数器
+ */
+
+// 生成合成源文件，每个变量声明后跟一段使用它的表达式语句和分支/循环
+inline void generateSource(const std::string& filename, int count) {
+    std::ofstream fout(filename);
+    fout << "class Main {\n    public static void main(String[] args) {\n";
+    for (int i = 0; i < count; ++i) {
+        fout << "        int v" << i << " = " << i << ";\n";
+        fout << "        v" << i << " = v" << i << " * 2 + (v" << i << " - 1); // 注释\n";
+        if (i % 16 == 0) fout << "        String s" << i << " = \"text " << i << "\";\n";
+        if (i % 8 == 0) {
+            fout << "        if (v" << i << " < 10) { v" << i << " = 1; } else { v" << i << " = 2; }\n";
+            fout << "        while (v" << i << " < 100) { v" << i << " = v" << i << " + 1; }\n";
+        }
+    }
+    fout << "    }\n}\n$\n";
+}
+
+// 生成以嵌套 While 为主的合成程序。每组：外层循环内有不变量运算、归纳变量乘常量，内层循环固定8次
+inline void generateLoopSource(const std::string& filename, int groups, int iterations) {
+    std::ofstream fout(filename);
+    fout << "class Main {\n    public static void main(String[] args) {\n";
+    for (int g = 0; g < groups; ++g) {
+        std::string n = "n" + std::to_string(g), i = "i" + std::to_string(g), j = "j" + std::to_string(g),
+                    acc = "acc" + std::to_string(g);
+        fout << "        int " << n << " = " << g << ";\n"
+             << "        int " << i << " = 0;\n"
+             << "        int " << acc << " = 0;\n"
+             << "        while (" << i << " < " << iterations << ") {\n"
+             << "            int " << j << " = 0;\n"
+             << "            while (" << j << " < 8) {\n"
+             << "                " << acc << " = " << acc << " + " << i << " * 12 + " << n << " * 3 + " << j
+             << " * 4 + (" << n << " + 5) * 7;\n"
+             << "                " << j << " = " << j << " + 1;\n"
+             << "            }\n"
+             << "            " << acc << " = " << acc << " - " << i << " * 10 + " << n << " * 1 + 0;\n"
+             << "            " << i << " = " << i << " + 1;\n"
+             << "        }\n";
+    }
+    fout << "    }\n}\n$\n";
+}
+
+inline double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 进程峰值常驻内存（KB）
+inline long peakRssKB() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+#endif
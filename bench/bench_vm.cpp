@@ -0,0 +1,72 @@
+#include "../src/lex.h"
+#include "../src/parser.h"
+#include "../src/semantic.h"
+#include "../src/irgen.h"
+#include "../src/optimizer.h"
+#include "../src/vm.h"
+#include "bench_util.h"
+#include "ir_interp.h"
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+
+/** 字节码虚拟机基准测试：
+ * 嵌套循环合成程序按 -O0/-O2 优化后分别生成不带/带超指令的字节码，取多次执行的最短耗时，
+ * 吞吐量按等价的四元式条数（参考解释器执行的非标号四元式）每秒计，并校验变量终值与参考解释器一致
+ * 用法：./bench_vm [循环组数，默认200] [外层迭代次数，默认2000] [重复次数，默认5]
+ */
+
+int main(int argc, char* argv[]) {
+    int groups = argc > 1 ? std::atoi(argv[1]) : 200;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 2000;
+    int repeats = argc > 3 ? std::atoi(argv[3]) : 5;
+    std::string filename = "bench_vm_input.txt";
+    generateLoopSource(filename, groups, iterations);
+    CompilationContext ctx;
+    std::vector<Token> tokens = runLexer(ctx, filename);
+    std::remove(filename.c_str());
+    AST ast = parse(ctx, tokens);
+    if (!ctx.parseErrors.empty() || !checkSemantics(ctx, ast)) {
+        std::cerr << "合成程序有误\n";
+        return 1;
+    }
+    IRProgram base = generateIR(ctx, ast);
+
+    std::cout << std::left << std::setw(6) << "级别" << std::setw(10) << "超指令" << std::right << std::setw(12)
+              << "指令条数" << std::setw(14) << "四元式条数" << std::setw(12) << "耗时(ms)" << std::setw(14)
+              << "百万条/秒" << std::setw(10) << "加速比" << "\n";
+    for (int level : {0, 2}) {
+        IRProgram ir = base;
+        std::vector<PassStats> stats;
+        std::string error;
+        runPasses(ir, passesForLevel(level), stats, error);
+        ExecCounts counts;
+        std::vector<int64_t> expected = interpretIR(ir, counts);
+        uint64_t quads = counts.total - counts.byOp[OP_LABEL];
+        std::vector<char> stringVar = stringVariables(ir);
+        double plainMs = 0;
+        for (bool super : {false, true}) {
+            Bytecode bc = compileBytecode(ir, super);
+            double bestMs = 0;
+            for (int r = 0; r < repeats; ++r) {
+                auto start = std::chrono::steady_clock::now();
+                std::vector<int64_t> registers = runBytecode(bc);
+                double ms = elapsedMs(start);
+                if (r == 0 || ms < bestMs) bestMs = ms;
+                for (size_t id = 0; id < expected.size(); ++id) {
+                    if (!stringVar[id] && registers[id] != expected[id]) {
+                        std::cerr << "-O" << level << " 变量 " << ctx.slotName(id) << " 的终值与参考解释器不一致\n";
+                        return 1;
+                    }
+                }
+            }
+            if (!super) plainMs = bestMs;
+            std::cout << std::left << std::setw(6) << ("-O" + std::to_string(level)) << std::setw(10)
+                      << (super ? "开" : "关") << std::right << std::setw(12) << bc.code.size() << std::setw(14) << quads
+                      << std::setw(12) << std::fixed << std::setprecision(3) << bestMs << std::setw(14)
+                      << std::setprecision(1) << quads / bestMs / 1000 << std::setw(10) << std::setprecision(2)
+                      << plainMs / bestMs << "\n";
+        }
+    }
+    return 0;
+}
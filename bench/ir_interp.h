@@ -0,0 +1,63 @@
+#ifndef IR_INTERP_H
+#define IR_INTERP_H
+
+#include "../src/irgen.h"
+#include <cstdint>
+#include <vector>
+
+/** 四元式参考解释器（基准测试用）：
+ * 变量和临时变量都按64位整数保存，字符串常量取其在 constantTable 中的id（驻留后相等即id相等），
+ * 未赋值的变量为0。统计各操作码的执行次数
+ */
+
+struct ExecCounts {
+    uint64_t total = 0;
+    uint64_t byOp[OP_JNE + 1] = {};
+};
+
+// 执行四元式序列，返回各变量（按槽位）的终值
+inline std::vector<int64_t> interpretIR(const IRProgram& ir, ExecCounts& counts) {
+    std::vector<int64_t> vars(ir.context->slotCount(), 0), temps(ir.tempCount, 0);
+    std::vector<size_t> labelAt(ir.labelCount, 0);
+    for (size_t i = 0; i < ir.size(); ++i) {
+        if (ir.ops[i] == OP_LABEL) labelAt[ir.result[i].index()] = i;
+    }
+    auto value = [&](Operand o) -> int64_t {
+        switch (o.kind()) {
+            case OPD_VAR: return vars[o.index()];
+            case OPD_TEMP: return temps[o.index()];
+            case OPD_INT: return ir.intPool[o.index()];
+            case OPD_STR: return o.index();
+            default: return 0;
+        }
+    };
+    size_t pc = 0;
+    while (pc < ir.size()) {
+        OpCode op = ir.ops[pc];
+        ++counts.total;
+        ++counts.byOp[op];
+        uint64_t a = value(ir.arg1[pc]), b = value(ir.arg2[pc]);
+        int64_t r = 0;
+        switch (op) {
+            case OP_ASSIGN: r = a; break;
+            case OP_ADD: r = a + b; break;
+            case OP_SUB: r = a - b; break;
+            case OP_MUL: r = a * b; break;
+            case OP_SHL: r = a << (b & 63); break;
+            case OP_LT: r = (int64_t)a < (int64_t)b; break;
+            case OP_EQ: r = a == b; break;
+            case OP_LABEL: ++pc; continue;
+            case OP_JMP: pc = labelAt[ir.result[pc].index()]; continue;
+            case OP_JLT: pc = (int64_t)a < (int64_t)b ? labelAt[ir.result[pc].index()] : pc + 1; continue;
+            case OP_JEQ: pc = a == b ? labelAt[ir.result[pc].index()] : pc + 1; continue;
+            case OP_JNE: pc = a != b ? labelAt[ir.result[pc].index()] : pc + 1; continue;
+        }
+        Operand res = ir.result[pc];
+        if (res.kind() == OPD_VAR) vars[res.index()] = r;
+        else temps[res.index()] = r;
+        ++pc;
+    }
+    return vars;
+}
+
+#endif
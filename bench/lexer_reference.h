@@ -0,0 +1,122 @@
+#ifndef LEXER_REFERENCE_H
+#define LEXER_REFERENCE_H
+
+#include "../src/lex.h"
+#include "../src/context.h"
+#include <cctype>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/** 参照词法分析器：表驱动词法分析之前的 runLexer，逐行读入，用 isalpha/isalnum/isdigit 与比较链分类字符，
+ * 每个单词构造 std::string 查 unordered_map 关键字表；只用于基准测试的对照与校验token流，错误记入 ctx.lexErrors 但不输出
+ */
+
+namespace reference {
+
+static const std::unordered_map<std::string, int> keywordMap = {
+    {"class", KW_CLASS}, {"public", KW_PUBLIC}, {"static", KW_STATIC}, {"void", KW_VOID},
+    {"main", KW_MAIN}, {"if", KW_IF}, {"else", KW_ELSE}, {"while", KW_WHILE},
+    {"return", KW_RETURN}, {"true", KW_TRUE}, {"false", KW_FALSE}, {"String", KW_STRING}, {"int", KW_INT}};
+
+inline bool isDelimiter(char c) {
+    return c == '{' || c == '}' || c == '(' || c == ')' || c == '[' || c == ']' || c == ';' || c == ',';
+}
+
+inline bool isOperator(char c) { return c == '+' || c == '-' || c == '*' || c == '<' || c == '='; }
+
+// 与原实现相同，字符按 unsigned char 传给 <cctype>
+inline bool alpha(char c) { return std::isalpha((unsigned char)c); }
+inline bool alnum(char c) { return std::isalnum((unsigned char)c); }
+inline bool digit(char c) { return std::isdigit((unsigned char)c); }
+
+inline void addError(CompilationContext& ctx, LexErrorType type, int line, int column, char c) {
+    static const char* const messages[] = {"无法识别的字符", "非法标识符格式", "非法数字格式", "字符串未正确终止"};
+    ctx.lexErrors.push_back({type, line, column, messages[(int)type], c});
+}
+
+inline bool isValidIdentifier(const std::string& id) {
+    if (!alpha(id[0]) && id[0] != '_') return false;
+    for (char c : id) {
+        if (!alnum(c) && c != '_') return false;
+    }
+    return true;
+}
+
+inline std::vector<Token> runLexer(CompilationContext& ctx, const std::string& filename) {
+    std::ifstream fin(filename);
+    std::vector<Token> tokens;
+    std::string line;
+    int lineNumber = 1;
+    ctx.lexErrors.clear();
+    while (std::getline(fin, line)) {
+        size_t i = 0;
+        while (i < line.size()) {
+            int column = i + 1;
+            if (std::isspace((unsigned char)line[i])) { ++i; continue; }
+            if (alpha(line[i]) || line[i] == '_') {
+                std::string word;
+                while (i < line.size() && (alnum(line[i]) || line[i] == '_')) word += line[i++];
+                if (!isValidIdentifier(word)) {
+                    addError(ctx, LexErrorType::INVALID_IDENTIFIER, lineNumber, column, line[i - 1]);
+                    continue;
+                }
+                if (keywordMap.count(word)) {
+                    tokens.push_back({KEYWORD, keywordMap.at(word), lineNumber, column});
+                } else {
+                    tokens.push_back({IDENTIFIER, ctx.identifierTable.intern(word), lineNumber, column});
+                }
+            } else if (digit(line[i])) {
+                std::string num;
+                bool hasError = false;
+                if (line[i] == '0' && i + 1 < line.size() && digit(line[i + 1])) {
+                    addError(ctx, LexErrorType::INVALID_NUMBER, lineNumber, column, line[i]);
+                    hasError = true;
+                }
+                while (digit(line[i])) num += line[i++];
+                if (i < line.size() && (alpha(line[i]) || line[i] == '_')) {
+                    addError(ctx, LexErrorType::INVALID_IDENTIFIER, lineNumber, column, line[i]);
+                    while (i < line.size() && (alnum(line[i]) || line[i] == '_')) ++i;
+                    continue;
+                }
+                if (!hasError) tokens.push_back({INTEGER_LITERAL, ctx.constantTable.intern(num, CONST_INT), lineNumber, column});
+            } else if (line[i] == '"') {
+                std::string str;
+                bool terminated = false;
+                i++;
+                while (i < line.size()) {
+                    if (line[i] == '"') {
+                        terminated = true;
+                        i++;
+                        break;
+                    }
+                    str += line[i++];
+                }
+                if (!terminated) {
+                    addError(ctx, LexErrorType::UNTERMINATED_STRING, lineNumber, column, '"');
+                } else {
+                    tokens.push_back({STRING_LITERAL, ctx.constantTable.intern(str, CONST_STRING), lineNumber, column});
+                }
+            } else if (isOperator(line[i])) {
+                tokens.push_back({OPERATOR, (int)line[i++], lineNumber, column});
+            } else if (isDelimiter(line[i])) {
+                tokens.push_back({DELIMITER, (int)line[i++], lineNumber, column});
+            } else if (line[i] == '$') {
+                tokens.push_back({END_OF_FILE, -1, lineNumber, column});
+                ++i;
+            } else if (line[i] == '/' && i + 1 < line.size() && line[i + 1] == '/') {
+                break;
+            } else {
+                addError(ctx, LexErrorType::UNKNOWN_CHAR, lineNumber, column, line[i]);
+                ++i;
+            }
+        }
+        ++lineNumber;
+    }
+    return tokens;
+}
+
+} // namespace reference
+
+#endif
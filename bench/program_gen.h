@@ -0,0 +1,139 @@
+#ifndef PROGRAM_GEN_H
+#define PROGRAM_GEN_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/** 合成 MiniJava 程序生成器：输出的程序符合 parseMainClass/parseStatement 的文法，且没有语义错误
+ *   所有变量在 main 开头声明一次：int 变量 v0..v(identifiers-1)、String 变量 s0..、循环计数器 c0..c(nesting)
+ *   语句从赋值、String 赋值、if/else、while、语句块中随机选取，if/while/语句块最多嵌套 nesting 层
+ *   第 d 层的 while 只用 c<d> 计数且循环体不给计数器赋值，程序一定终止
+ * 同一组参数（含 seed）总是生成相同的程序，伪随机数由 splitmix64 产生，不依赖标准库分布的实现
+ */
+
+struct GenOptions {
+    int statements = 10000; // main 中的顶层语句数（不含声明）
+    int identifiers = 1000; // 不同 int 变量的个数
+    int exprDepth = 3; // 表达式的最大嵌套深度
+    int nesting = 3; // if/while/语句块的最大嵌套层数
+    int stringPercent = 10; // String 赋值语句所占的百分比
+    uint64_t seed = 1;
+};
+
+class ProgramGenerator {
+public:
+    ProgramGenerator(const GenOptions& options, std::ostream& out) : opt(options), out(out), state(options.seed) {}
+
+    void generate() {
+        out << "class Main {\n    public static void main(String[] args) {\n";
+        for (int i = 0; i < opt.identifiers; ++i) out << "        int v" << i << " = " << i % 1000 << ";\n";
+        for (int i = 0; i < stringCount(); ++i) out << "        String s" << i << " = \"init " << i << "\";\n";
+        for (int d = 0; d <= opt.nesting; ++d) out << "        int c" << d << " = 0;\n";
+        for (int i = 0; i < opt.statements; ++i) statement(0, 2);
+        out << "    }\n}\n$\n";
+    }
+
+private:
+    uint64_t next() {
+        // splitmix64
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+    int below(int n) { return n <= 0 ? 0 : (int)(next() % (uint64_t)n); }
+    int stringCount() const { return opt.identifiers / 8 + 1; }
+
+    void indent(int level) {
+        for (int i = 0; i < level; ++i) out << "    ";
+    }
+    std::string intVar() { return "v" + std::to_string(below(opt.identifiers)); }
+
+    void expression(int depth) {
+        if (depth >= opt.exprDepth || below(3) == 0) {
+            if (opt.identifiers > 0 && below(2) == 0) out << intVar();
+            else out << below(1000);
+            return;
+        }
+        static const char* const ops[] = {" + ", " - ", " * "};
+        bool paren = depth > 0 && below(2) == 0;
+        if (paren) out << "(";
+        expression(depth + 1);
+        out << ops[below(3)];
+        expression(depth + 1);
+        if (paren) out << ")";
+    }
+
+    void condition() {
+        expression(1);
+        out << (below(4) == 0 ? " = " : " < ");
+        expression(1);
+    }
+
+    // 赋值；没有 int 变量时退化为 String 赋值
+    void assignment(int level) {
+        indent(level);
+        if (opt.identifiers == 0 || below(100) < opt.stringPercent) {
+            out << "s" << below(stringCount()) << " = ";
+            if (below(2) == 0) out << "\"str " << below(10000) << "\"";
+            else out << "s" << below(stringCount());
+        } else {
+            out << intVar() << " = ";
+            expression(0);
+        }
+        out << ";";
+        if (below(16) == 0) out << " // 注释";
+        out << "\n";
+    }
+
+    // 语句块内的若干条语句，每条语句的嵌套层数为 depth
+    void body(int depth, int level) {
+        for (int n = 1 + below(3); n > 0; --n) statement(depth, level);
+    }
+
+    void statement(int depth, int level) {
+        int choice = depth < opt.nesting ? below(10) : 0;
+        if (choice <= 6) {
+            assignment(level);
+        } else if (choice == 7) {
+            indent(level);
+            out << "if (";
+            condition();
+            out << ") {\n";
+            body(depth + 1, level + 1);
+            indent(level);
+            out << "} else {\n";
+            body(depth + 1, level + 1);
+            indent(level);
+            out << "}\n";
+        } else if (choice == 8) {
+            std::string counter = "c" + std::to_string(depth);
+            indent(level);
+            out << counter << " = 0;\n";
+            indent(level);
+            out << "while (" << counter << " < " << 1 + below(8) << ") {\n";
+            body(depth + 1, level + 1);
+            indent(level + 1);
+            out << counter << " = " << counter << " + 1;\n";
+            indent(level);
+            out << "}\n";
+        } else {
+            indent(level);
+            out << "{\n";
+            body(depth + 1, level + 1);
+            indent(level);
+            out << "}\n";
+        }
+    }
+
+    GenOptions opt;
+    std::ostream& out;
+    uint64_t state;
+};
+
+inline void generateProgram(const GenOptions& options, std::ostream& out) {
+    ProgramGenerator(options, out).generate();
+}
+
+#endif
@@ -0,0 +1,18 @@
+#include "stats.h"
+#include <cstdlib>
+#include <new>
+
+/** 分配钩子：替换全局 operator new/delete，在当前线程的计数器上累加分配次数与字节数
+ * 链接进编译器本身、stress_nesting 与需要分配计数的基准程序，计数为线程局部变量，批量编译时各文件的统计互不干扰
+ */
+
+static const bool installed = (allocationHookInstalled = true);
+
+void* operator new(size_t size) {
+    ++threadAllocations;
+    threadAllocBytes += size;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
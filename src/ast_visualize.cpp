@@ -1,30 +1,313 @@
-#include "parser.h"
-#include <fstream>
-#include <sstream>
-
-static int nodeCounter = 0;
-
-void writeDotNode(std::ofstream& out, const std::shared_ptr<ASTNode>& node, int parentId = -1) {
-    if (!node) return;
-    int myId = nodeCounter++;
-    std::ostringstream label;
-    label << node->type;
-    if (!node->value.empty()) label << "\\n" << node->value;
-    out << "  node" << myId << " [label=\"" << label.str() << "\"]" << std::endl;
-    if (parentId != -1) {
-        out << "  node" << parentId << " -> node" << myId << std::endl;
-    }
-    for (const auto& child : node->children) {
-        writeDotNode(out, child, myId);
-    }
-}
-
-void exportASTtoDot(const std::shared_ptr<ASTNode>& root, const std::string& filename) {
-    std::ofstream fout(filename);
-    fout << "digraph AST {" << std::endl;
-    fout << "  node [shape=box, style=filled, fillcolor=lightgray];" << std::endl;
-    nodeCounter = 0;
-    writeDotNode(fout, root);
-    fout << "}" << std::endl;
-    fout.close();
-}
\ No newline at end of file
+#include "ast_visualize.h"
+#include "context.h"
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/** 导出流程：
+ * 1.有深度、折叠或行号限制时，先求出每棵子树的节点数与行号范围（先序序列逆序累加，不递归）
+ * 2.先序遍历，栈元素为 (节点, 父节点编号, 深度)；有子节点的节点先压入闭合标记，JSON 与 S 表达式在标记出栈时闭合
+ * 3.节点按输出顺序编号，文本直接追加到 1MB 缓冲区，缓冲区满时整块写出
+ */
+
+static const size_t WRITE_BUFFER = 1 << 20;
+
+// 整块写出的文本写入器
+class TextWriter {
+public:
+    explicit TextWriter(FILE* file) : file(file), buffer(WRITE_BUFFER) {}
+
+    void put(const char* text, size_t size) {
+        while (size > 0) {
+            size_t n = std::min(size, WRITE_BUFFER - used);
+            std::memcpy(buffer.data() + used, text, n);
+            used += n;
+            text += n;
+            size -= n;
+            if (used == WRITE_BUFFER) flush();
+        }
+    }
+    void put(const char* text) { put(text, std::strlen(text)); }
+    void put(char c) {
+        if (used == WRITE_BUFFER) flush();
+        buffer[used++] = c;
+    }
+    void putNumber(long long n) {
+        char digits[24];
+        put(digits, std::to_chars(digits, digits + sizeof(digits), n).ptr - digits);
+    }
+    // 双引号内的文本：转义 " 与 \，JSON 另外转义控制字符
+    void putEscaped(const std::string& text, bool json) {
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                put('\\');
+                put(c);
+            } else if (json && (unsigned char)c < 0x20) {
+                static const char hex[] = "0123456789abcdef";
+                put("\\u00", 4);
+                put(hex[c >> 4]);
+                put(hex[c & 15]);
+            } else {
+                put(c);
+            }
+        }
+    }
+    bool flush() {
+        if (used > 0 && std::fwrite(buffer.data(), 1, used, file) != used) ok = false;
+        used = 0;
+        return ok;
+    }
+
+private:
+    FILE* file;
+    std::vector<char> buffer;
+    size_t used = 0;
+    bool ok = true;
+};
+
+// 子树的节点数（含自身）与行号范围
+struct SubtreeInfo {
+    uint32_t size;
+    int minLine;
+    int maxLine;
+};
+
+static std::vector<SubtreeInfo> subtreeInfo(const AST& ast) {
+    std::vector<SubtreeInfo> info(ast.nodes.size());
+    std::vector<NodeId> order, stack = {ast.root};
+    order.reserve(ast.nodes.size());
+    while (!stack.empty()) {
+        NodeId id = stack.back();
+        stack.pop_back();
+        if (id == NO_NODE) continue;
+        order.push_back(id);
+        const ASTNode& node = ast[id];
+        for (const NodeId* c = ast.childBegin(node); c != ast.childEnd(node); ++c) stack.push_back(*c);
+    }
+    // 逆先序：子节点总在父节点之前累加完
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        const ASTNode& node = ast[*it];
+        // 没有行号的节点（程序、语句块）不参与行号范围
+        SubtreeInfo sum = {1, node.line > 0 ? node.line : INT_MAX, node.line > 0 ? node.line : 0};
+        for (const NodeId* c = ast.childBegin(node); c != ast.childEnd(node); ++c) {
+            if (*c == NO_NODE) continue;
+            sum.size += info[*c].size;
+            sum.minLine = std::min(sum.minLine, info[*c].minLine);
+            sum.maxLine = std::max(sum.maxLine, info[*c].maxLine);
+        }
+        info[*it] = sum;
+    }
+    return info;
+}
+
+class AstExporter {
+public:
+    AstExporter(const CompilationContext& ctx, const AST& ast, const AstExportOptions& options, TextWriter& out)
+        : ctx(ctx), ast(ast), options(options), out(out) {
+        if (options.maxDepth >= 0 || options.collapseAbove > 0 || options.firstLine > 0 || options.lastLine > 0) {
+            info = subtreeInfo(ast);
+        }
+    }
+
+    void run();
+
+private:
+    struct Frame {
+        NodeId id; // CLOSE_NODE 表示闭合栈顶之下最近展开的节点
+        int parent;
+        int depth;
+    };
+    static const NodeId CLOSE_NODE = NO_NODE - 1;
+
+    bool visible(NodeId id) const;
+    bool collapsed(NodeId id, int depth) const;
+    // 节点本身（不含子节点）；summary 非空时写成折叠的摘要节点
+    void writeNode(const ASTNode& node, int number, int parent, int depth, const SubtreeInfo* summary);
+    void close();
+
+    const CompilationContext& ctx;
+    const AST& ast;
+    const AstExportOptions& options;
+    TextWriter& out;
+    std::vector<SubtreeInfo> info; // 无限制时为空
+    bool needComma = false; // JSON：下一个节点前需要逗号
+};
+
+// 根节点总是保留，行号范围内没有节点时导出空的程序
+bool AstExporter::visible(NodeId id) const {
+    if (id == ast.root || (options.firstLine <= 0 && options.lastLine <= 0)) return true;
+    return info[id].maxLine >= options.firstLine && (options.lastLine <= 0 || info[id].minLine <= options.lastLine);
+}
+
+bool AstExporter::collapsed(NodeId id, int depth) const {
+    if (ast[id].childCount == 0) return false;
+    if (options.maxDepth >= 0 && depth >= options.maxDepth) return true;
+    // 程序与语句块只是语句的容器，按节点数折叠时保持展开，折叠其中过大的语句
+    if (ast[id].kind == NK_PROGRAM || ast[id].kind == NK_BLOCK) return false;
+    return options.collapseAbove > 0 && info[id].size > options.collapseAbove;
+}
+
+void AstExporter::writeNode(const ASTNode& node, int number, int parent, int depth, const SubtreeInfo* summary) {
+    const std::string& text = nodeText(ctx, node);
+    switch (options.format) {
+        case AST_DOT:
+            out.put("  node");
+            out.putNumber(number);
+            out.put(" [label=\"");
+            out.put(nodeKindName(node.kind));
+            if (!text.empty()) {
+                out.put("\\n", 2);
+                out.putEscaped(text, false);
+            }
+            if (summary) {
+                out.put("\\n折叠 ");
+                out.putNumber(summary->size);
+                out.put(" 个节点");
+                if (summary->minLine <= summary->maxLine) {
+                    out.put(", 行 ");
+                    out.putNumber(summary->minLine);
+                    out.put('-');
+                    out.putNumber(summary->maxLine);
+                }
+                out.put("\", shape=folder, fillcolor=khaki]\n");
+            } else {
+                out.put("\"]\n");
+            }
+            if (parent != -1) {
+                out.put("  node");
+                out.putNumber(parent);
+                out.put(" -> node");
+                out.putNumber(number);
+                out.put('\n');
+            }
+            break;
+        case AST_JSON:
+            if (needComma) out.put(',');
+            out.put("{\"kind\":\"");
+            out.put(nodeKindName(node.kind));
+            out.put('"');
+            if (!text.empty()) {
+                out.put(",\"text\":\"");
+                out.putEscaped(text, true);
+                out.put('"');
+            }
+            out.put(",\"line\":");
+            out.putNumber(node.line);
+            if (summary) {
+                out.put(",\"collapsed\":");
+                out.putNumber(summary->size);
+                if (summary->minLine <= summary->maxLine) {
+                    out.put(",\"lines\":[");
+                    out.putNumber(summary->minLine);
+                    out.put(',');
+                    out.putNumber(summary->maxLine);
+                    out.put(']');
+                }
+                out.put('}');
+            } else if (node.childCount > 0) {
+                out.put(",\"children\":[");
+            } else {
+                out.put('}');
+            }
+            needComma = summary || node.childCount == 0;
+            break;
+        case AST_SEXPR:
+            if (depth > 0) out.put(' ');
+            out.put('(');
+            out.put(nodeKindName(node.kind));
+            if (!text.empty()) {
+                out.put(' ');
+                if (node.kind == NK_STR) {
+                    out.put('"');
+                    out.putEscaped(text, false);
+                    out.put('"');
+                } else {
+                    out.put(text.data(), text.size());
+                }
+            }
+            if (summary) {
+                out.put(" :collapsed ");
+                out.putNumber(summary->size);
+            }
+            if (summary || node.childCount == 0) out.put(')');
+            break;
+    }
+}
+
+void AstExporter::close() {
+    if (options.format == AST_JSON) {
+        out.put("]}", 2);
+        needComma = true;
+    } else if (options.format == AST_SEXPR) {
+        out.put(')');
+    }
+}
+
+void AstExporter::run() {
+    if (options.format == AST_DOT) out.put("digraph AST {\n  node [shape=box, style=filled, fillcolor=lightgray];\n");
+    else if (ast.root == NO_NODE) out.put(options.format == AST_JSON ? "null" : "()");
+
+    std::vector<Frame> stack = {{ast.root, -1, 0}};
+    int nodeCounter = 0;
+    while (!stack.empty()) {
+        Frame frame = stack.back();
+        stack.pop_back();
+        if (frame.id == CLOSE_NODE) {
+            close();
+            continue;
+        }
+        if (frame.id == NO_NODE || !visible(frame.id)) continue;
+        const ASTNode& node = ast[frame.id];
+        int number = nodeCounter++;
+        if (collapsed(frame.id, frame.depth)) {
+            writeNode(node, number, frame.parent, frame.depth, &info[frame.id]);
+            continue;
+        }
+        writeNode(node, number, frame.parent, frame.depth, nullptr);
+        if (node.childCount == 0) continue;
+        stack.push_back({CLOSE_NODE, -1, 0});
+        // 子节点逆序入栈，按原顺序出栈
+        for (const NodeId* c = ast.childEnd(node); c != ast.childBegin(node);) stack.push_back({*--c, number, frame.depth + 1});
+    }
+
+    if (options.format == AST_DOT) out.put("}\n");
+    else out.put('\n');
+}
+
+bool parseAstFormat(const std::string& name, AstFormat& format) {
+    for (AstFormat f : {AST_DOT, AST_JSON, AST_SEXPR}) {
+        if (name == astFormatName(f)) {
+            format = f;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* astFormatName(AstFormat format) {
+    switch (format) {
+        case AST_DOT: return "dot";
+        case AST_JSON: return "json";
+        case AST_SEXPR: return "sexp";
+    }
+    return "dot";
+}
+
+bool exportAST(const CompilationContext& ctx, const AST& ast, const std::string& filename, const AstExportOptions& options) {
+    FILE* file = std::fopen(filename.c_str(), "wb");
+    if (!file) return false;
+    bool ok;
+    {
+        TextWriter out(file);
+        AstExporter(ctx, ast, options, out).run();
+        ok = out.flush();
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+void exportASTtoDot(const CompilationContext& ctx, const AST& ast, const std::string& filename) {
+    exportAST(ctx, ast, filename, AstExportOptions());
+}
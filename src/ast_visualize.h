@@ -4,6 +4,36 @@
 #include "parser.h"
 #include <string>
 
-void exportASTtoDot(const std::shared_ptr<ASTNode>& root, const std::string& filename);
+// AST 导出格式：DOT（xdot 查看）、嵌套的 JSON、紧凑的 S 表达式
+enum AstFormat {
+    AST_DOT,
+    AST_JSON,
+    AST_SEXPR
+};
+
+/** 导出选项，默认导出整棵树：
+ *   maxDepth：深度（根为0）等于 maxDepth 且有子节点的节点折叠为摘要节点，-1 不限
+ *   collapseAbove：子树节点数超过它的语句或表达式折叠为摘要节点（程序与语句块保持展开），0 不折叠
+ *   firstLine/lastLine：只导出行号范围与 [firstLine, lastLine] 相交的子树（祖先保留，没有相交的子树时只有根节点），0 不限
+ * 摘要节点给出被折叠子树的节点数与行号范围
+ */
+struct AstExportOptions {
+    AstFormat format = AST_DOT;
+    int maxDepth = -1;
+    uint32_t collapseAbove = 0;
+    int firstLine = 0;
+    int lastLine = 0;
+};
+
+// 格式名 dot/json/sexp，未知的名字返回 false
+bool parseAstFormat(const std::string& name, AstFormat& format);
+// 输出文件扩展名，与格式名相同
+const char* astFormatName(AstFormat format);
+
+// 三种格式共用一次先序遍历，输出经 1MB 缓冲区整块写出，不为单个节点分配内存；写入失败时返回 false
+bool exportAST(const CompilationContext& ctx, const AST& ast, const std::string& filename, const AstExportOptions& options);
+
+// 以默认选项导出 DOT
+void exportASTtoDot(const CompilationContext& ctx, const AST& ast, const std::string& filename);
 
 #endif
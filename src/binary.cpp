@@ -0,0 +1,261 @@
+#include "binary.h"
+#include "context.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** 写出流程：
+ * 1.由各部分的大小算出节表（偏移、字节数、记录数），写出前整个文件的布局就已确定
+ * 2.文件头、节表、各节数据依次拷入 1MB 缓冲区，缓冲区满时整块写出，文件只顺序写一遍
+ * 读取：mmap 整个文件，检查文件头、版本与每节的范围和记录大小后直接使用
+ */
+
+static const size_t WRITE_BUFFER = 1 << 20;
+
+const char* sectionName(uint32_t kind) {
+    switch (kind) {
+        case SEC_TOKENS: return "tokens";
+        case SEC_IDENTIFIERS: return "identifiers";
+        case SEC_CONSTANTS: return "constants";
+        case SEC_AST: return "ast";
+        case SEC_AST_CHILDREN: return "ast_children";
+        case SEC_IR: return "ir";
+        case SEC_INT_POOL: return "int_pool";
+        case SEC_SLOTS: return "slots";
+    }
+    return "unknown";
+}
+
+// 整块写出的顺序写入器
+class BlockWriter {
+public:
+    explicit BlockWriter(FILE* file) : file(file), buffer(WRITE_BUFFER) {}
+
+    void put(const void* data, size_t size) {
+        const char* p = static_cast<const char*>(data);
+        written += size;
+        while (size > 0) {
+            size_t n = std::min(size, WRITE_BUFFER - used);
+            std::memcpy(buffer.data() + used, p, n);
+            used += n;
+            p += n;
+            size -= n;
+            if (used == WRITE_BUFFER) flush();
+        }
+    }
+    template <class T>
+    void put(const T& value) { put(&value, sizeof(T)); }
+    // 补0到8字节对齐，下一节从对齐处开始
+    void align() {
+        static const char zeros[8] = {};
+        put(zeros, (8 - written % 8) % 8);
+    }
+    bool flush() {
+        if (used > 0 && std::fwrite(buffer.data(), 1, used, file) != used) ok = false;
+        used = 0;
+        return ok;
+    }
+
+private:
+    FILE* file;
+    std::vector<char> buffer;
+    size_t used = 0;
+    uint64_t written = 0;
+    bool ok = true;
+};
+
+static uint64_t alignUp(uint64_t n) { return (n + 7) & ~(uint64_t)7; }
+
+// 写成字符串表的两种表：驻留表，额外槽位表（种类为 SlotKind）
+static size_t entryCount(const Interner& table) { return table.size(); }
+static const std::string& entryText(const Interner& table, size_t i) { return table[i]; }
+static uint32_t entryKind(const Interner& table, size_t i) { return table.kindOf(i); }
+static size_t entryCount(const std::vector<ExtraSlot>& slots) { return slots.size(); }
+static const std::string& entryText(const std::vector<ExtraSlot>& slots, size_t i) { return slots[i].name; }
+static uint32_t entryKind(const std::vector<ExtraSlot>& slots, size_t i) { return slots[i].kind; }
+
+template <typename Table>
+static uint64_t stringTableSize(const Table& table) {
+    size_t n = entryCount(table);
+    uint64_t chars = 0;
+    for (size_t i = 0; i < n; ++i) chars += entryText(table, i).size();
+    return 8 * (n + 1) + 4 * n + chars;
+}
+
+template <typename Table>
+static void writeStringTable(BlockWriter& out, const Table& table) {
+    size_t n = entryCount(table);
+    uint64_t offset = 0;
+    out.put(offset);
+    for (size_t i = 0; i < n; ++i) {
+        offset += entryText(table, i).size();
+        out.put(offset);
+    }
+    for (size_t i = 0; i < n; ++i) out.put(entryKind(table, i));
+    for (size_t i = 0; i < n; ++i) out.put(entryText(table, i).data(), entryText(table, i).size());
+}
+
+bool writeBinary(const std::string& path, const CompilationContext& ctx, const std::vector<Token>& tokens,
+                 const AST* ast, const IRProgram* ir, std::string& error) {
+    std::vector<BinSection> sections;
+    auto add = [&](BinSectionKind kind, uint64_t size, uint64_t count, uint64_t aux0 = 0, uint64_t aux1 = 0) {
+        BinSection s = {kind, 0, 0, size, count, aux0, aux1};
+        sections.push_back(s);
+    };
+    add(SEC_TOKENS, tokens.size() * sizeof(BinToken), tokens.size());
+    add(SEC_IDENTIFIERS, stringTableSize(ctx.identifierTable), ctx.identifierTable.size());
+    add(SEC_CONSTANTS, stringTableSize(ctx.constantTable), ctx.constantTable.size());
+    if (!ctx.extraSlots.empty()) add(SEC_SLOTS, stringTableSize(ctx.extraSlots), ctx.extraSlots.size(), ctx.firstExtraSlot);
+    if (ast) {
+        add(SEC_AST, ast->nodes.size() * sizeof(BinNode), ast->nodes.size(), ast->root);
+        add(SEC_AST_CHILDREN, ast->childList.size() * sizeof(uint32_t), ast->childList.size());
+    }
+    if (ir) {
+        add(SEC_IR, ir->size() * sizeof(BinQuad), ir->size(), ir->tempCount, ir->labelCount);
+        add(SEC_INT_POOL, ir->intPool.size() * sizeof(int64_t), ir->intPool.size());
+    }
+    uint64_t offset = alignUp(sizeof(BinHeader) + sections.size() * sizeof(BinSection));
+    for (BinSection& s : sections) {
+        s.offset = offset;
+        offset = alignUp(offset + s.size);
+    }
+
+    std::string tmp = path + ".tmp";
+    FILE* file = std::fopen(tmp.c_str(), "wb");
+    if (!file) {
+        error = "无法写入 " + tmp;
+        return false;
+    }
+    BlockWriter out(file);
+    BinHeader header = {{BIN_MAGIC[0], BIN_MAGIC[1], BIN_MAGIC[2], BIN_MAGIC[3]}, BIN_VERSION,
+                        (uint32_t)sections.size(), 0};
+    out.put(header);
+    for (const BinSection& s : sections) out.put(s);
+    out.align();
+
+    for (const Token& t : tokens) out.put(BinToken{t.type, t.value, t.line, t.column});
+    out.align();
+    writeStringTable(out, ctx.identifierTable);
+    out.align();
+    writeStringTable(out, ctx.constantTable);
+    out.align();
+    if (!ctx.extraSlots.empty()) {
+        writeStringTable(out, ctx.extraSlots);
+        out.align();
+    }
+    if (ast) {
+        for (const ASTNode& n : ast->nodes) {
+            out.put(BinNode{n.kind, n.varType, 0, n.value, n.line, n.firstChild, n.childCount});
+        }
+        out.align();
+        out.put(ast->childList.data(), ast->childList.size() * sizeof(uint32_t));
+        out.align();
+    }
+    if (ir) {
+        for (size_t i = 0; i < ir->size(); ++i) {
+            out.put(BinQuad{ir->ops[i], {0, 0, 0}, ir->arg1[i].bits, ir->arg2[i].bits, ir->result[i].bits});
+        }
+        out.align();
+        out.put(ir->intPool.data(), ir->intPool.size() * sizeof(int64_t));
+        out.align();
+    }
+    bool ok = out.flush();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        error = "写入 " + path + " 失败";
+        return false;
+    }
+    return true;
+}
+
+BinaryFile::~BinaryFile() {
+    if (base) munmap(const_cast<char*>(base), length);
+}
+
+// 定长记录节的记录大小，字符串表与未知种类为0
+static uint64_t recordSize(uint32_t kind) {
+    switch (kind) {
+        case SEC_TOKENS: return sizeof(BinToken);
+        case SEC_AST: return sizeof(BinNode);
+        case SEC_AST_CHILDREN: return sizeof(uint32_t);
+        case SEC_IR: return sizeof(BinQuad);
+        case SEC_INT_POOL: return sizeof(int64_t);
+    }
+    return 0;
+}
+
+bool BinaryFile::open(const std::string& path, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "无法打开 " + path;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(BinHeader)) {
+        void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            base = static_cast<const char*>(addr);
+            length = st.st_size;
+        }
+    }
+    close(fd);
+    if (!base) {
+        error = path + " 不是容器文件";
+        return false;
+    }
+
+    const BinHeader* header = reinterpret_cast<const BinHeader*>(base);
+    if (std::memcmp(header->magic, BIN_MAGIC, 4) != 0) {
+        error = path + " 不是容器文件";
+        return false;
+    }
+    if (header->version != BIN_VERSION) {
+        error = "不支持的容器版本 " + std::to_string(header->version);
+        return false;
+    }
+    if (header->sectionCount > (length - sizeof(BinHeader)) / sizeof(BinSection)) {
+        error = "节表超出文件范围";
+        return false;
+    }
+    sections = reinterpret_cast<const BinSection*>(base + sizeof(BinHeader));
+    count = header->sectionCount;
+    for (uint32_t i = 0; i < count; ++i) {
+        const BinSection& s = sections[i];
+        bool ok = s.offset % 8 == 0 && s.offset <= length && s.size <= length - s.offset;
+        if (ok && recordSize(s.kind)) ok = s.count <= s.size / recordSize(s.kind) && s.count * recordSize(s.kind) == s.size;
+        if (ok && (s.kind == SEC_IDENTIFIERS || s.kind == SEC_CONSTANTS || s.kind == SEC_SLOTS)) {
+            ok = s.size >= 8 && s.count <= (s.size - 8) / 12 &&
+                 s.size - 12 * s.count - 8 == records<uint64_t>(s)[s.count];
+        }
+        if (!ok) {
+            error = std::string("节 ") + sectionName(s.kind) + " 已损坏";
+            return false;
+        }
+    }
+    return true;
+}
+
+const BinSection* BinaryFile::section(BinSectionKind kind) const {
+    for (uint32_t i = 0; i < count; ++i) {
+        if (sections[i].kind == kind) return &sections[i];
+    }
+    return nullptr;
+}
+
+std::string_view BinaryFile::string(const BinSection& table, size_t i) const {
+    if (i >= table.count) return {};
+    const uint64_t* offsets = records<uint64_t>(table);
+    const char* chars = base + table.offset + 12 * table.count + 8;
+    if (offsets[i] > offsets[i + 1] || offsets[i + 1] > offsets[table.count]) return {};
+    return std::string_view(chars + offsets[i], offsets[i + 1] - offsets[i]);
+}
+
+uint32_t BinaryFile::stringKind(const BinSection& table, size_t i) const {
+    if (i >= table.count) return 0;
+    return reinterpret_cast<const uint32_t*>(base + table.offset + 8 * (table.count + 1))[i];
+}
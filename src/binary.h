@@ -0,0 +1,114 @@
+#ifndef BINARY_H
+#define BINARY_H
+
+#include "irgen.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/** 版本化二进制容器（out.mjb）：文件头、节表，之后是各节的数据，每节从8字节对齐处开始，按本机（x86-64 小端）布局存放
+ * 每节是定长记录数组，mmap 后直接按记录指针访问，不需要反序列化：
+ *   tokens：BinToken[count]
+ *   identifiers / constants：字符串表，依次为 uint64 偏移[count+1]、uint32 种类[count]、字符数据
+ *   slots：额外槽位的名字，与 identifiers 布局相同，种类为 SlotKind，aux0 为第一个额外槽位的槽位号（firstExtraSlot）
+ *   ast：BinNode[count]，aux0 为根节点id；ast_children：uint32 子节点id[count]
+ *   ir：BinQuad[count]，aux0、aux1 为临时变量数与标号数；int_pool：int64[count]，即 OPD_INT 操作数的取值
+ * 容器在优化之后写出，slots 节含优化遍引入的变量（如 "i*12"）；identifiers 节与 identifier_table.txt 相同
+ * 有语法错误时没有 ast 与 ir 节，未生成IR时没有 ir 与 int_pool 节，没有额外槽位时没有 slots 节；新增节种类不改变版本号，布局变化时版本号加1
+ */
+
+const char BIN_MAGIC[4] = {'M', 'J', 'B', '\0'};
+const uint32_t BIN_VERSION = 1;
+
+enum BinSectionKind : uint32_t {
+    SEC_TOKENS = 1,
+    SEC_IDENTIFIERS,
+    SEC_CONSTANTS,
+    SEC_AST,
+    SEC_AST_CHILDREN,
+    SEC_IR,
+    SEC_INT_POOL,
+    SEC_SLOTS
+};
+
+struct BinHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t sectionCount;
+    uint32_t reserved;
+};
+
+struct BinSection {
+    uint32_t kind; // BinSectionKind
+    uint32_t reserved;
+    uint64_t offset; // 距文件开头的字节数
+    uint64_t size; // 字节数
+    uint64_t count; // 记录数（字符串表为字符串个数）
+    uint64_t aux0;
+    uint64_t aux1;
+};
+
+struct BinToken {
+    int32_t type;
+    int32_t value;
+    int32_t line;
+    int32_t column;
+};
+
+struct BinNode {
+    uint8_t kind; // NodeKind
+    uint8_t varType; // ValueType
+    uint16_t reserved;
+    int32_t value;
+    int32_t line;
+    uint32_t firstChild;
+    uint32_t childCount;
+};
+
+struct BinQuad {
+    uint8_t op; // OpCode
+    uint8_t reserved[3];
+    uint32_t arg1; // Operand::bits
+    uint32_t arg2;
+    uint32_t result;
+};
+
+// 节种类名（"tokens"、"ir" 等），未知种类为 "unknown"
+const char* sectionName(uint32_t kind);
+
+/* 一次顺序写出整个容器：先写入 path.tmp 再 rename，读者不会看到写了一半的文件
+ * ast、ir 为空时不写对应的节；失败时返回false并设置error
+ */
+bool writeBinary(const std::string& path, const CompilationContext& ctx, const std::vector<Token>& tokens,
+                 const AST* ast, const IRProgram* ir, std::string& error);
+
+// 只读映射的容器文件，open 只检查文件头与节表，各节数据直接指向映射区
+class BinaryFile {
+public:
+    BinaryFile() = default;
+    ~BinaryFile();
+    BinaryFile(const BinaryFile&) = delete;
+    BinaryFile& operator=(const BinaryFile&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+
+    uint32_t sectionCount() const { return count; }
+    const BinSection& sectionAt(uint32_t i) const { return sections[i]; }
+    // 第一个 kind 种类的节，不存在时为 nullptr
+    const BinSection* section(BinSectionKind kind) const;
+
+    template <class T>
+    const T* records(const BinSection& s) const { return reinterpret_cast<const T*>(base + s.offset); }
+    // 字符串表的第 i 项及其种类；i 超出 table.count 时为空串与0，需要区分时由调用者先检查
+    std::string_view string(const BinSection& table, size_t i) const;
+    uint32_t stringKind(const BinSection& table, size_t i) const;
+
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+    const BinSection* sections = nullptr;
+    uint32_t count = 0;
+};
+
+#endif
@@ -0,0 +1,420 @@
+#include "cache.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char ENTRY_MAGIC[4] = {'M', 'J', 'C', '1'};
+static const size_t ENTRY_HEADER = 4 + 8 + 8; // 魔数、内容长度、内容校验和
+
+// ---------------- 哈希 ----------------
+
+static inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+static inline uint64_t fmix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// 双路64位哈希（结构同 MurmurHash3 x64_128 的分块混合），按8字节一块吸收输入
+struct Hasher {
+    uint64_t a = 0x9e3779b97f4a7c15ULL, b = 0x632be59bd9b4e019ULL;
+
+    void block(uint64_t w) {
+        a = rotl(a ^ fmix(w ^ 0x87c37b91114253d5ULL), 27) * 5 + 0x52dce729;
+        b = rotl(b ^ fmix(w ^ 0x4cf5ad432745937fULL), 31) * 5 + 0x38495ab5;
+    }
+    void update(std::string_view data) {
+        block(data.size()); // 先吸收长度，使多个部分的拼接方式不同则哈希不同
+        size_t i = 0;
+        for (; i + 8 <= data.size(); i += 8) {
+            uint64_t w;
+            std::memcpy(&w, data.data() + i, 8);
+            block(w);
+        }
+        uint64_t tail = 0;
+        std::memcpy(&tail, data.data() + i, data.size() - i);
+        block(tail);
+    }
+};
+
+/* 编译器版本：编译器任何部分改动都可能改变输出，因此取整个可执行文件（/proc/self/exe）内容的哈希，
+ * 只重新编译了部分源文件的增量构建也会让旧条目失效；读不到可执行文件时退回本文件的构建时间
+ * 每个进程只计算一次
+ */
+static const std::string& compilerVersion() {
+    static const std::string version = [] {
+        std::ifstream fin("/proc/self/exe", std::ios::binary);
+        std::string image((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+        if (image.empty()) return std::string("minijava-cache-1 " __DATE__ " " __TIME__);
+        Hasher h;
+        h.update(image);
+        std::ostringstream id;
+        id << "minijava-cache-1 " << std::hex << fmix(h.a ^ h.b) << fmix(h.b + h.a);
+        return id.str();
+    }();
+    return version;
+}
+
+std::string cacheKey(std::initializer_list<std::string_view> parts) {
+    Hasher h;
+    h.update(compilerVersion());
+    for (std::string_view part : parts) h.update(part);
+    std::ostringstream key;
+    key << std::hex << std::setfill('0') << std::setw(16) << fmix(h.a ^ h.b) << std::setw(16) << fmix(h.b + h.a);
+    return key.str();
+}
+
+static uint64_t checksum(std::string_view data) {
+    Hasher h;
+    h.update(data);
+    return fmix(h.a ^ rotl(h.b, 17));
+}
+
+// ---------------- 目录锁 ----------------
+
+// 对目录中的 lock 文件加排他锁，析构时释放
+class DirectoryLock {
+public:
+    explicit DirectoryLock(const std::string& dir) {
+        fd = open((dir + "/lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd >= 0) flock(fd, LOCK_EX);
+    }
+    ~DirectoryLock() {
+        if (fd >= 0) close(fd); // 关闭即释放锁
+    }
+    DirectoryLock(const DirectoryLock&) = delete;
+    DirectoryLock& operator=(const DirectoryLock&) = delete;
+
+private:
+    int fd = -1;
+};
+
+// ---------------- 缓存目录 ----------------
+
+// 条目文件名是32个十六进制字符，其余文件（lock、stats、临时文件）不计入条目
+static bool isEntryName(const std::string& name) {
+    return name.size() == 32 && std::all_of(name.begin(), name.end(), [](char c) { return isxdigit((unsigned char)c); });
+}
+
+CompileCache::CompileCache(const std::string& dir, uint64_t limitBytes) : dir(dir), limit(limitBytes) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+}
+
+bool CompileCache::load(const std::string& key, std::string& data) {
+    std::string path = dir + "/" + key;
+    std::ifstream fin(path, std::ios::binary);
+    std::string raw;
+    if (fin) {
+        std::ostringstream buffer;
+        buffer << fin.rdbuf();
+        raw = buffer.str();
+    }
+    uint64_t size = 0, sum = 0;
+    if (raw.size() >= ENTRY_HEADER) {
+        std::memcpy(&size, raw.data() + 4, 8);
+        std::memcpy(&sum, raw.data() + 12, 8);
+    }
+    if (raw.size() < ENTRY_HEADER || std::memcmp(raw.data(), ENTRY_MAGIC, 4) != 0 ||
+        size != raw.size() - ENTRY_HEADER || checksum(std::string_view(raw).substr(ENTRY_HEADER)) != sum) {
+        ++local.misses;
+        return false;
+    }
+    data = raw.substr(ENTRY_HEADER);
+    utimensat(AT_FDCWD, path.c_str(), nullptr, 0); // 修改时间即最近使用时间
+    ++local.hits;
+    return true;
+}
+
+void CompileCache::store(const std::string& key, const std::string& data) {
+    if (data.size() + ENTRY_HEADER > limit) return;
+    // 临时文件名在进程和线程间唯一
+    static std::atomic<unsigned> counter(0);
+    std::ostringstream tmpName;
+    tmpName << dir << "/tmp." << getpid() << "." << std::hash<std::thread::id>()(std::this_thread::get_id()) << "."
+            << counter++;
+    std::string tmp = tmpName.str();
+    {
+        std::ofstream fout(tmp, std::ios::binary);
+        uint64_t size = data.size(), sum = checksum(data);
+        fout.write(ENTRY_MAGIC, 4);
+        fout.write((const char*)&size, 8);
+        fout.write((const char*)&sum, 8);
+        fout.write(data.data(), data.size());
+        if (!fout) {
+            fout.close();
+            std::remove(tmp.c_str());
+            return;
+        }
+    }
+    if (std::rename(tmp.c_str(), (dir + "/" + key).c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return;
+    }
+    evict();
+}
+
+void CompileCache::usage(size_t& entries, uint64_t& bytes) const {
+    entries = 0;
+    bytes = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (!isEntryName(entry.path().filename().string())) continue;
+        std::error_code sizeError;
+        uint64_t size = entry.file_size(sizeError);
+        if (sizeError) continue; // 已被其他进程淘汰
+        ++entries;
+        bytes += size;
+    }
+}
+
+void CompileCache::evict() {
+    DirectoryLock lock(dir);
+    struct Entry {
+        std::string path;
+        uint64_t size;
+        timespec used;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    time_t now = time(nullptr);
+    std::error_code ec;
+    for (const auto& item : std::filesystem::directory_iterator(dir, ec)) {
+        std::string name = item.path().filename().string();
+        struct stat st;
+        if (stat(item.path().c_str(), &st) != 0) continue;
+        if (name.compare(0, 4, "tmp.") == 0) {
+            if (now - st.st_mtime > 3600) std::remove(item.path().c_str()); // 异常退出的进程遗留的临时文件
+            continue;
+        }
+        if (!isEntryName(name)) continue;
+        entries.push_back({item.path().string(), (uint64_t)st.st_size, st.st_mtim});
+        total += st.st_size;
+    }
+    if (total <= limit) return;
+    std::sort(entries.begin(), entries.end(), [](const Entry& x, const Entry& y) {
+        return x.used.tv_sec != y.used.tv_sec ? x.used.tv_sec < y.used.tv_sec : x.used.tv_nsec < y.used.tv_nsec;
+    });
+    for (const Entry& e : entries) {
+        if (total <= limit) break;
+        if (std::remove(e.path.c_str()) == 0) ++local.evictions;
+        total -= e.size;
+    }
+}
+
+CacheStats CompileCache::flushStats() {
+    DirectoryLock lock(dir);
+    std::string path = dir + "/stats";
+    CacheStats total;
+    std::ifstream fin(path);
+    fin >> total.hits >> total.misses >> total.evictions;
+    fin.close();
+    total.hits += local.hits;
+    total.misses += local.misses;
+    total.evictions += local.evictions;
+    // 同样先写临时文件再 rename，读 stats 不需要加锁
+    std::string tmp = path + ".tmp";
+    std::ofstream(tmp) << total.hits << " " << total.misses << " " << total.evictions << "\n";
+    std::rename(tmp.c_str(), path.c_str());
+    local = CacheStats();
+    return total;
+}
+
+void writeCacheStats(const CacheStats& current, const CacheStats& total, size_t entries, uint64_t bytes,
+                     std::ostream& out) {
+    out << "缓存: 本次命中 " << current.hits << " 未命中 " << current.misses << " 淘汰 " << current.evictions
+        << "；累计命中 " << total.hits << " 未命中 " << total.misses << " 淘汰 " << total.evictions << "；"
+        << entries << " 个条目共 " << (bytes + 1023) / 1024 << " KB\n";
+}
+
+// ---------------- 序列化 ----------------
+
+class ByteWriter {
+public:
+    template <typename T> void pod(const T& value) { out.append((const char*)&value, sizeof(T)); }
+    template <typename T> void vec(const std::vector<T>& items) {
+        pod((uint64_t)items.size());
+        out.append((const char*)items.data(), items.size() * sizeof(T));
+    }
+    void str(const std::string& s) {
+        pod((uint64_t)s.size());
+        out += s;
+    }
+    void interner(const Interner& table) {
+        pod((uint64_t)table.size());
+        for (size_t i = 0; i < table.size(); ++i) {
+            pod(table.kindOf(i));
+            str(table[i]);
+        }
+    }
+    void slots(const CompilationContext& ctx) {
+        pod(ctx.firstExtraSlot);
+        pod((uint64_t)ctx.extraSlots.size());
+        for (const ExtraSlot& slot : ctx.extraSlots) {
+            pod((int)slot.kind);
+            str(slot.name);
+        }
+    }
+    void ir(const IRProgram& program) {
+        vec(program.ops);
+        vec(program.arg1);
+        vec(program.arg2);
+        vec(program.result);
+        vec(program.intPool);
+        pod(program.tempCount);
+        pod(program.labelCount);
+    }
+    std::string out;
+};
+
+// 越界读取时置 ok 为false，之后的读取都不再改变内容
+class ByteReader {
+public:
+    explicit ByteReader(const std::string& in) : in(in) {}
+
+    template <typename T> void pod(T& value) {
+        if (!ok || in.size() - pos < sizeof(T)) {
+            ok = false;
+            return;
+        }
+        std::memcpy(&value, in.data() + pos, sizeof(T));
+        pos += sizeof(T);
+    }
+    template <typename T> void vec(std::vector<T>& items) {
+        uint64_t n = 0;
+        pod(n);
+        if (!ok || n > (in.size() - pos) / sizeof(T)) {
+            ok = false;
+            return;
+        }
+        items.resize(n);
+        std::memcpy(items.data(), in.data() + pos, n * sizeof(T));
+        pos += n * sizeof(T);
+    }
+    void str(std::string& s) {
+        uint64_t n = 0;
+        pod(n);
+        if (!ok || n > in.size() - pos) {
+            ok = false;
+            return;
+        }
+        s.assign(in, pos, n);
+        pos += n;
+    }
+    void interner(Interner& table) {
+        uint64_t n = 0;
+        pod(n);
+        table.clear();
+        for (uint64_t i = 0; ok && i < n; ++i) {
+            int kind = 0;
+            std::string text;
+            pod(kind);
+            str(text);
+            if (ok) table.intern(text, kind);
+        }
+    }
+    void slots(uint32_t& first, std::vector<ExtraSlot>& extra) {
+        uint64_t n = 0;
+        pod(first);
+        pod(n);
+        extra.clear();
+        for (uint64_t i = 0; ok && i < n; ++i) {
+            int kind = 0;
+            std::string name;
+            pod(kind);
+            str(name);
+            if (ok) extra.push_back({(SlotKind)kind, name});
+        }
+    }
+    void ir(IRProgram& program) {
+        vec(program.ops);
+        vec(program.arg1);
+        vec(program.arg2);
+        vec(program.result);
+        std::vector<int64_t> pool;
+        vec(pool);
+        for (int64_t v : pool) program.intConst(v); // 重建去重索引，下标与保存时相同
+        pod(program.tempCount);
+        pod(program.labelCount);
+        ok = ok && program.arg1.size() == program.ops.size() && program.arg2.size() == program.ops.size() &&
+             program.result.size() == program.ops.size();
+    }
+    bool done() const { return ok && pos == in.size(); }
+
+private:
+    const std::string& in;
+    size_t pos = 0;
+    bool ok = true;
+};
+
+std::string encodeFrontEnd(const CompilationContext& ctx, const FrontEnd& front) {
+    ByteWriter w;
+    w.vec(front.tokens);
+    w.interner(ctx.identifierTable);
+    w.interner(ctx.constantTable);
+    w.slots(ctx);
+    w.str(front.diagnostics);
+    w.pod((uint8_t)front.parseFailed);
+    w.pod((uint8_t)front.semanticsFailed);
+    w.vec(front.ast.nodes);
+    w.vec(front.ast.childList);
+    w.pod(front.ast.root);
+    w.ir(front.ir);
+    return w.out;
+}
+
+bool decodeFrontEnd(const std::string& data, CompilationContext& ctx, FrontEnd& front) {
+    ByteReader r(data);
+    uint8_t parseFailed = 0, semanticsFailed = 0;
+    r.vec(front.tokens);
+    r.interner(ctx.identifierTable);
+    r.interner(ctx.constantTable);
+    r.slots(ctx.firstExtraSlot, ctx.extraSlots);
+    r.str(front.diagnostics);
+    r.pod(parseFailed);
+    r.pod(semanticsFailed);
+    r.vec(front.ast.nodes);
+    r.vec(front.ast.childList);
+    r.pod(front.ast.root);
+    r.ir(front.ir);
+    front.parseFailed = parseFailed;
+    front.semanticsFailed = semanticsFailed;
+    front.ir.context = &ctx;
+    return r.done();
+}
+
+std::string encodeOptimizedIR(const IRProgram& ir) {
+    ByteWriter w;
+    w.slots(*ir.context);
+    w.ir(ir);
+    return w.out;
+}
+
+bool decodeOptimizedIR(const std::string& data, IRProgram& ir) {
+    ByteReader r(data);
+    uint32_t first = NO_SLOT;
+    std::vector<ExtraSlot> extra;
+    IRProgram optimized;
+    r.slots(first, extra);
+    r.ir(optimized);
+    if (!r.done()) return false;
+    optimized.context = ir.context;
+    ir = std::move(optimized);
+    ir.context->firstExtraSlot = first;
+    ir.context->extraSlots = std::move(extra);
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "irgen.h"
+#include <cstdint>
+#include <initializer_list>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/** 内容寻址的磁盘编译缓存
+ * 键是各部分内容（源码字节、优化遍列表等）连同编译器版本（可执行文件内容的哈希）的128位哈希，值是一个条目文件
+ *   前端条目：键只含源码，保存 token流、标识符表、常量表、额外槽位表、AST、未优化的IR 和错误输出，命中时跳过词法到IR生成的所有阶段
+ *   优化条目：键为前端键加优化遍列表，保存优化后的IR（及优化器分配的新变量槽位），命中时跳过优化
+ * 多个编译器进程可以同时使用同一目录：
+ *   条目先写入临时文件再 rename，读者要么看到完整的旧条目要么看到完整的新条目；条目头部有长度和校验和，损坏的条目按未命中处理
+ *   命中时更新条目的修改时间，写入后总大小超过上限则在目录锁内按修改时间从旧到新淘汰（LRU）
+ *   命中/未命中/淘汰次数累加到目录中的 stats 文件，同样在目录锁内更新
+ */
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+};
+
+class CompileCache {
+public:
+    CompileCache(const std::string& dir, uint64_t limitBytes);
+
+    // 读取 key 对应的条目内容，不存在或已损坏时返回false
+    bool load(const std::string& key, std::string& data);
+    void store(const std::string& key, const std::string& data);
+
+    // 本对象的统计（命中/未命中/淘汰）
+    const CacheStats& stats() const { return local; }
+    // 把本对象的统计累加到目录的 stats 文件并清零，返回累加后的总计
+    CacheStats flushStats();
+    // 当前条目数与总字节数
+    void usage(size_t& entries, uint64_t& bytes) const;
+
+private:
+    void evict();
+
+    std::string dir;
+    uint64_t limit;
+    CacheStats local;
+};
+
+// 各部分内容连同编译器版本的128位哈希，32个十六进制字符
+std::string cacheKey(std::initializer_list<std::string_view> parts);
+
+// 前端各阶段的产物，只由源码决定；符号表保存在 CompilationContext 中
+struct FrontEnd {
+    std::vector<Token> tokens;
+    AST ast;
+    IRProgram ir; // 未优化的IR，语法错误时为空
+    std::string diagnostics; // 词法/语法/语义错误的输出文本
+    bool parseFailed = false;
+    bool semanticsFailed = false; // 语义分析未通过时不生成IR
+};
+
+std::string encodeFrontEnd(const CompilationContext& ctx, const FrontEnd& front);
+// 恢复 ctx 的符号表与 front，front.ir.context 指向 ctx；内容不完整时返回false
+bool decodeFrontEnd(const std::string& data, CompilationContext& ctx, FrontEnd& front);
+
+// 优化后的IR与额外槽位表（优化器可能分配新变量）
+std::string encodeOptimizedIR(const IRProgram& ir);
+bool decodeOptimizedIR(const std::string& data, IRProgram& ir);
+
+void writeCacheStats(const CacheStats& current, const CacheStats& total, size_t entries, uint64_t bytes,
+                     std::ostream& out);
+
+#endif
@@ -0,0 +1,278 @@
+#include "cfg.h"
+#include <algorithm>
+#include <iterator>
+
+/** 控制流图构建：
+ * 1.首指令、标号、跳转的下一条为块首，划分基本块
+ * 2.按块尾指令连边：jmp 只有跳转目标，条件跳转有跳转目标和顺序后继，其余只有顺序后继
+ * 3.按逆后序迭代计算直接支配者（Cooper-Harvey-Kennedy 算法）
+ * 4.找出回边（后继支配前驱），沿前驱反向收集自然循环，内层循环先找到并合并为一个节点
+ */
+
+bool CFG::dominates(int a, int b) const {
+    if (blocks[a].idom < 0 || blocks[b].idom < 0) return false;
+    return blocks[a].domPre <= blocks[b].domPre && blocks[b].domPost <= blocks[a].domPost;
+}
+
+// 添加边 from -> to，忽略重复边
+static void addEdge(CFG& cfg, int from, int to) {
+    std::vector<int>& succs = cfg.blocks[from].succs;
+    if (std::find(succs.begin(), succs.end(), to) != succs.end()) return;
+    succs.push_back(to);
+    cfg.blocks[to].preds.push_back(from);
+}
+
+// 从入口做深度优先遍历，得到可达块的逆后序
+static void computeOrder(CFG& cfg) {
+    std::vector<int> postorder;
+    std::vector<char> visited(cfg.blocks.size(), 0);
+    std::vector<std::pair<int, size_t>> stack; // (块, 下一个待访问的后继下标)
+    stack.push_back({0, 0});
+    visited[0] = 1;
+    while (!stack.empty()) {
+        int b = stack.back().first;
+        size_t& next = stack.back().second;
+        if (next < cfg.blocks[b].succs.size()) {
+            int s = cfg.blocks[b].succs[next++];
+            if (!visited[s]) {
+                visited[s] = 1;
+                stack.push_back({s, 0});
+            }
+        } else {
+            postorder.push_back(b);
+            stack.pop_back();
+        }
+    }
+    cfg.order.assign(postorder.rbegin(), postorder.rend());
+    for (size_t i = 0; i < cfg.order.size(); ++i) cfg.blocks[cfg.order[i]].rpo = i;
+}
+
+// 沿支配树向上找两个块的最近公共支配者
+static int intersect(const CFG& cfg, int a, int b) {
+    while (a != b) {
+        while (cfg.blocks[a].rpo > cfg.blocks[b].rpo) a = cfg.blocks[a].idom;
+        while (cfg.blocks[b].rpo > cfg.blocks[a].rpo) b = cfg.blocks[b].idom;
+    }
+    return a;
+}
+
+static void computeDominators(CFG& cfg) {
+    cfg.blocks[0].idom = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 1; i < cfg.order.size(); ++i) {
+            int b = cfg.order[i];
+            int newIdom = -1;
+            for (int p : cfg.blocks[b].preds) {
+                if (cfg.blocks[p].idom < 0) continue; // 尚未处理或不可达
+                newIdom = newIdom < 0 ? p : intersect(cfg, p, newIdom);
+            }
+            if (newIdom != cfg.blocks[b].idom) {
+                cfg.blocks[b].idom = newIdom;
+                changed = true;
+            }
+        }
+    }
+}
+
+// 给支配树编先序/后序号
+static void numberDominatorTree(CFG& cfg) {
+    std::vector<std::vector<int>> children(cfg.blocks.size());
+    for (int b : cfg.order) {
+        if (b != 0) children[cfg.blocks[b].idom].push_back(b);
+    }
+    int pre = 0, post = 0;
+    std::vector<std::pair<int, size_t>> stack; // (块, 下一个待访问的子节点下标)
+    stack.push_back({0, 0});
+    cfg.blocks[0].domPre = pre++;
+    while (!stack.empty()) {
+        int b = stack.back().first;
+        size_t next = stack.back().second++;
+        if (next < children[b].size()) {
+            int c = children[b][next];
+            cfg.blocks[c].domPre = pre++;
+            stack.push_back({c, 0});
+        } else {
+            cfg.blocks[b].domPost = post++;
+            stack.pop_back();
+        }
+    }
+}
+
+/* 按循环头逆后序从内到外找循环：已找到的循环用并查集并入其循环头，外层循环反向搜索时
+ * 整个内层循环只当作它的循环头访问一次，总耗时与块数和边数近似成线性，不随嵌套深度平方增长
+ */
+static void findLoops(CFG& cfg) {
+    size_t n = cfg.blocks.size();
+    std::vector<int> rep(n); // 并查集：块 -> 包含它的已找到的最外层循环的循环头，不在循环中为自身
+    for (size_t b = 0; b < n; ++b) rep[b] = b;
+    auto find = [&](int b) {
+        int root = b;
+        while (rep[root] != root) root = rep[root];
+        while (rep[b] != root) {
+            int next = rep[b];
+            rep[b] = root;
+            b = next;
+        }
+        return root;
+    };
+    std::vector<int> mark(n, -1); // 代表块 -> 最近一次加入的循环头
+    std::vector<int> headerLoop(n, -1); // 循环头 -> 发现顺序中的循环编号
+    std::vector<Loop> found; // 发现顺序，内层循环在前
+    std::vector<int> work;
+    for (size_t i = cfg.order.size(); i-- > 0;) {
+        int h = cfg.order[i];
+        Loop loop;
+        loop.header = h;
+        for (int p : cfg.blocks[h].preds) {
+            if (cfg.dominates(h, p)) loop.latches.push_back(p);
+        }
+        if (loop.latches.empty()) continue;
+
+        // 从回边起点沿前驱反向搜索，遇到循环头停止；内层循环的块都由其循环头代表，循环外的前驱只连到循环头
+        int id = found.size();
+        mark[h] = h;
+        work.clear();
+        for (int l : loop.latches) {
+            int r = find(l);
+            if (mark[r] != h) {
+                mark[r] = h;
+                work.push_back(r);
+            }
+        }
+        cfg.blocks[h].loop = id;
+        while (!work.empty()) {
+            int b = work.back();
+            work.pop_back();
+            rep[b] = h;
+            if (headerLoop[b] >= 0) found[headerLoop[b]].parent = id;
+            else cfg.blocks[b].loop = id;
+            for (int p : cfg.blocks[b].preds) {
+                if (cfg.blocks[p].idom < 0) continue;
+                int r = find(p);
+                if (mark[r] != h) {
+                    mark[r] = h;
+                    work.push_back(r);
+                }
+            }
+        }
+        headerLoop[h] = id;
+        found.push_back(std::move(loop));
+    }
+
+    // 改为循环头逆后序（外层在前），外层循环的编号总小于内层
+    size_t count = found.size();
+    cfg.loops.assign(std::make_move_iterator(found.rbegin()), std::make_move_iterator(found.rend()));
+    for (BasicBlock& block : cfg.blocks) {
+        if (block.loop >= 0) block.loop = count - 1 - block.loop;
+    }
+    std::vector<size_t> own(count, 0), size(count, 0), cursor(count, 0);
+    for (const BasicBlock& block : cfg.blocks) {
+        if (block.loop >= 0) ++own[block.loop];
+    }
+    for (size_t l = count; l-- > 0;) {
+        Loop& loop = cfg.loops[l];
+        if (loop.parent >= 0) loop.parent = count - 1 - loop.parent;
+        size[l] += own[l];
+        if (loop.parent >= 0) size[loop.parent] += size[l];
+    }
+    // 循环树先序：各循环的区间接在外层循环自己的块和排在它前面的兄弟循环之后
+    size_t next = 0;
+    for (size_t l = 0; l < count; ++l) {
+        Loop& loop = cfg.loops[l];
+        if (loop.parent >= 0) loop.depth = cfg.loops[loop.parent].depth + 1;
+        size_t& at = loop.parent >= 0 ? cursor[loop.parent] : next;
+        loop.begin = at;
+        loop.end = at + size[l];
+        at = loop.end;
+        cursor[l] = loop.begin + own[l];
+    }
+    cfg.loopBlocks.resize(next);
+    std::fill(own.begin(), own.end(), 0);
+    for (size_t b = 0; b < n; ++b) {
+        int l = cfg.blocks[b].loop;
+        if (l < 0) continue;
+        size_t pos = cfg.loops[l].begin + own[l]++;
+        cfg.loopBlocks[pos] = b;
+        cfg.blocks[b].loopPos = pos;
+    }
+}
+
+CFG buildCFG(const IRProgram& ir) {
+    CFG cfg;
+    size_t n = ir.size();
+
+    // 划分基本块
+    std::vector<char> leader(n + 1, 0);
+    leader[0] = 1;
+    for (size_t i = 0; i < n; ++i) {
+        if (ir.ops[i] == OP_LABEL) leader[i] = 1;
+        if (isJump(ir.ops[i])) leader[i + 1] = 1;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (leader[i]) {
+            if (!cfg.blocks.empty()) cfg.blocks.back().end = i;
+            cfg.blocks.push_back(BasicBlock());
+            cfg.blocks.back().begin = i;
+        }
+    }
+    if (cfg.blocks.empty()) cfg.blocks.push_back(BasicBlock()); // 空程序只有一个空的入口块
+    cfg.blocks.back().end = n;
+
+    cfg.labelBlock.assign(ir.labelCount, -1);
+    for (size_t b = 0; b < cfg.blocks.size(); ++b) {
+        for (size_t i = cfg.blocks[b].begin; i < cfg.blocks[b].end; ++i) {
+            if (ir.ops[i] == OP_LABEL) cfg.labelBlock[ir.result[i].index()] = b;
+        }
+    }
+
+    // 连边
+    for (size_t b = 0; b < cfg.blocks.size(); ++b) {
+        const BasicBlock& block = cfg.blocks[b];
+        bool fallsThrough = true;
+        if (block.end > block.begin) {
+            size_t last = block.end - 1;
+            if (isJump(ir.ops[last])) {
+                addEdge(cfg, b, cfg.labelBlock[ir.result[last].index()]);
+                fallsThrough = isCondJump(ir.ops[last]);
+            }
+        }
+        if (fallsThrough && b + 1 < cfg.blocks.size()) addEdge(cfg, b, b + 1);
+    }
+
+    computeOrder(cfg);
+    computeDominators(cfg);
+    numberDominatorTree(cfg);
+    findLoops(cfg);
+    return cfg;
+}
+
+// 输出块编号列表
+static void writeBlockList(std::ostream& out, const std::vector<int>& list) {
+    for (size_t i = 0; i < list.size(); ++i) out << (i ? " " : "") << "B" << list[i];
+}
+
+void writeCFG(const IRProgram& ir, const CFG& cfg, std::ostream& out) {
+    for (size_t b = 0; b < cfg.blocks.size(); ++b) {
+        const BasicBlock& block = cfg.blocks[b];
+        out << "B" << b << " [" << block.begin << ", " << block.end << ")";
+        out << " preds: ";
+        writeBlockList(out, block.preds);
+        out << " succs: ";
+        writeBlockList(out, block.succs);
+        if (block.idom >= 0) out << " idom: B" << block.idom;
+        else out << " unreachable";
+        out << "\n";
+        for (size_t i = block.begin; i < block.end; ++i) {
+            out << "    " << opName(ir.ops[i]) << " " << operandText(ir, ir.arg1[i]) << " "
+                << operandText(ir, ir.arg2[i]) << " " << operandText(ir, ir.result[i]) << "\n";
+        }
+    }
+    for (const Loop& loop : cfg.loops) {
+        out << "loop header: B" << loop.header << " latches: ";
+        writeBlockList(out, loop.latches);
+        if (loop.parent >= 0) out << " parent: B" << cfg.loops[loop.parent].header;
+        out << " depth: " << loop.depth << "\n";
+    }
+}
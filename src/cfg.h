@@ -0,0 +1,56 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include "irgen.h"
+#include <ostream>
+#include <vector>
+
+// 基本块：四元式区间 [begin, end)
+struct BasicBlock {
+    size_t begin = 0;
+    size_t end = 0;
+    std::vector<int> preds; // 前驱块编号
+    std::vector<int> succs; // 后继块编号（条件跳转时第一个为跳转目标，第二个为顺序后继）
+    int idom = -1; // 直接支配者，入口块为自身，不可达块为-1
+    int rpo = -1; // 逆后序编号，不可达块为-1
+    int domPre = -1; // 支配树先序/后序编号，用于O(1)判断支配关系
+    int domPost = -1;
+    int loop = -1; // 包含该块的最内层循环，不在循环中为-1
+    int loopPos = -1; // 在 CFG::loopBlocks 中的位置，不在循环中为-1
+};
+
+// 自然循环
+struct Loop {
+    int header; // 循环头
+    std::vector<int> latches; // 回边起点
+    int parent = -1; // 直接外层循环在 CFG::loops 中的下标，最外层为-1
+    int depth = 1; // 嵌套深度，最外层为1
+    size_t begin = 0; // 循环包含的块（含循环头与内层循环的块）为 CFG::loopBlocks 的 [begin, end)
+    size_t end = 0;
+};
+
+// 控制流图，块0为入口
+struct CFG {
+    std::vector<BasicBlock> blocks;
+    std::vector<int> labelBlock; // 标号编号 -> 所在块
+    std::vector<int> order; // 可达块的逆后序
+    std::vector<Loop> loops; // 按循环头逆后序排列，外层循环在前
+    // 按循环树先序排列的循环内的块：每个循环先是只属于它的块（升序），再依次是各内层循环的区间，
+    // 每个块只出现一次，循环嵌套再深也只占块数的空间
+    std::vector<int> loopBlocks;
+
+    // a 是否支配 b
+    bool dominates(int a, int b) const;
+    // 块 b 是否在循环 loop 中
+    bool inLoop(int b, const Loop& loop) const {
+        return blocks[b].loopPos >= 0 && (size_t)blocks[b].loopPos >= loop.begin && (size_t)blocks[b].loopPos < loop.end;
+    }
+};
+
+// 划分基本块并连接边，随后计算支配树和自然循环
+CFG buildCFG(const IRProgram& ir);
+
+// 输出基本块、前驱后继、直接支配者和循环；循环只输出循环头、回边起点与外层循环，输出大小与嵌套深度无关
+void writeCFG(const IRProgram& ir, const CFG& cfg, std::ostream& out);
+
+#endif
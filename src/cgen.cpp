@@ -0,0 +1,185 @@
+#include "cgen.h"
+#include <climits>
+#include <string>
+#include <vector>
+
+/** C 代码生成流程：
+ * 1.找出出现过的变量与临时变量，按是否保存字符串确定类型：整数为 int64_t，字符串为 const char*
+ * 2.用到的字符串常量各生成一个 static const char 数组（按 constantTable 的id去重），同一常量总是同一地址，
+ *   与汇编后端一样按地址比较字符串
+ * 3.逐条翻译四元式：运算先转为 uint64_t 再转回 int64_t，与其他后端一样按64位补码回绕，不依赖有符号溢出；
+ *   标号为 "Ln:;"，跳转为 goto
+ * 4.结束时逐个 printf 源程序变量的终值，未赋值的字符串变量输出空串
+ * 变量命名为 v<槽位>、临时变量为 t<编号>，不使用源程序中的名字，因此与 C 关键字同名的变量、
+ * 优化器引入的 "i*12" 与同名不同类型的变量都不需要改写
+ */
+
+class CEmitter {
+public:
+    CEmitter(const IRProgram& ir, std::ostream& out) : ir(ir), out(out) {}
+
+    void run();
+
+private:
+    bool isString(Operand o) const;
+    std::string name(Operand o) const;
+    // 操作数作为 int64_t（asString 为 false）或 const char* 的表达式，类型不同时转换
+    std::string value(Operand o, bool asString) const;
+    // result = expr，expr 为 int64_t 表达式
+    void store(Operand result, const std::string& expr);
+    void emitQuad(size_t q);
+    void emitDeclarations();
+    void emitExit();
+
+    const IRProgram& ir;
+    std::ostream& out;
+    std::vector<char> stringVar; // 变量 -> 是否保存字符串
+    std::vector<char> stringTemp; // 临时变量 -> 是否保存字符串
+    std::vector<int> printVars; // 需要输出终值的源程序变量
+};
+
+// 输出 C 字符串字面量：引号、反斜杠、?（避免三字符组）与不可打印字符转义，八进制转义固定3位
+static void writeCString(std::ostream& out, const std::string& text) {
+    out << "\"";
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\' || c == '?') {
+            out << '\\' << c;
+        } else if (c < 32 || c > 126) {
+            out << '\\' << (char)('0' + (c >> 6)) << (char)('0' + ((c >> 3) & 7)) << (char)('0' + (c & 7));
+        } else {
+            out << c;
+        }
+    }
+    out << "\"";
+}
+
+bool CEmitter::isString(Operand o) const {
+    if (o.kind() == OPD_VAR) return stringVar[o.index()];
+    if (o.kind() == OPD_TEMP) return stringTemp[o.index()];
+    return o.kind() == OPD_STR;
+}
+
+std::string CEmitter::name(Operand o) const {
+    return (o.kind() == OPD_VAR ? "v" : "t") + std::to_string(o.index());
+}
+
+std::string CEmitter::value(Operand o, bool asString) const {
+    std::string text;
+    switch (o.kind()) {
+        case OPD_INT: {
+            int64_t v = ir.intPool[o.index()];
+            text = v == INT64_MIN ? "(-INT64_MAX - 1)" : "INT64_C(" + std::to_string(v) + ")";
+            break;
+        }
+        case OPD_STR:
+            text = "s" + std::to_string(o.index());
+            break;
+        case OPD_VAR:
+        case OPD_TEMP:
+            text = name(o);
+            break;
+        default:
+            text = "0";
+            break;
+    }
+    if (o.kind() == OPD_NONE || isString(o) == asString) return text;
+    return asString ? "(const char*)(intptr_t)" + text : "(int64_t)(intptr_t)" + text;
+}
+
+void CEmitter::store(Operand result, const std::string& expr) {
+    out << "    " << name(result) << " = ";
+    if (isString(result)) out << "(const char*)(intptr_t)(" << expr << ");\n";
+    else out << expr << ";\n";
+}
+
+void CEmitter::emitQuad(size_t q) {
+    OpCode op = ir.ops[q];
+    Operand result = ir.result[q];
+    std::string a = value(ir.arg1[q], false), b = value(ir.arg2[q], false);
+    switch (op) {
+        case OP_ASSIGN:
+            out << "    " << name(result) << " = " << value(ir.arg1[q], isString(result)) << ";\n";
+            return;
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+            store(result, "(int64_t)((uint64_t)" + a + (op == OP_ADD ? " + " : op == OP_SUB ? " - " : " * ") +
+                              "(uint64_t)" + b + ")");
+            return;
+        case OP_SHL:
+            store(result, "(int64_t)((uint64_t)" + a + " << (" + b + " & 63))");
+            return;
+        case OP_LT:
+            store(result, "(int64_t)(" + a + " < " + b + ")");
+            return;
+        case OP_EQ:
+            store(result, "(int64_t)(" + a + " == " + b + ")");
+            return;
+        case OP_LABEL:
+            out << "L" << result.index() << ":;\n";
+            return;
+        case OP_JMP:
+            out << "    goto L" << result.index() << ";\n";
+            return;
+        case OP_JLT:
+        case OP_JEQ:
+        case OP_JNE:
+            out << "    if (" << a << (op == OP_JLT ? " < " : op == OP_JEQ ? " == " : " != ") << b << ") goto L"
+                << result.index() << ";\n";
+            return;
+    }
+}
+
+void CEmitter::emitDeclarations() {
+    std::vector<char> usedVar(stringVar.size(), 0), usedTemp(stringTemp.size(), 0);
+    for (size_t q = 0; q < ir.size(); ++q) {
+        for (Operand o : {ir.arg1[q], ir.arg2[q], ir.result[q]}) {
+            if (o.kind() == OPD_VAR) usedVar[o.index()] = 1;
+            else if (o.kind() == OPD_TEMP) usedTemp[o.index()] = 1;
+        }
+    }
+    // 未赋值就读取的值从0开始，与汇编后端相同
+    for (size_t id = 0; id < usedVar.size(); ++id) {
+        if (!usedVar[id]) continue;
+        out << "    " << (stringVar[id] ? "const char* v" : "int64_t v") << id << " = 0; // "
+            << ir.context->slotName(id) << "\n";
+    }
+    for (size_t t = 0; t < usedTemp.size(); ++t) {
+        if (usedTemp[t]) out << "    " << (stringTemp[t] ? "const char* t" : "int64_t t") << t << " = 0;\n";
+    }
+}
+
+void CEmitter::emitExit() {
+    for (int id : printVars) {
+        out << "    printf(\"%s = " << (stringVar[id] ? "%s" : "%lld") << "\\n\", ";
+        writeCString(out, ir.context->slotName(id));
+        if (stringVar[id]) out << ", v" << id << " ? v" << id << " : \"\");\n";
+        else out << ", (long long)v" << id << ");\n";
+    }
+    out << "    return 0;\n}\n";
+}
+
+void CEmitter::run() {
+    printVars = sourceVariables(ir);
+    stringVar = stringVariables(ir, &stringTemp);
+
+    out << "#include <stdint.h>\n#include <stdio.h>\n\n";
+    std::vector<char> emitted(ir.context->constantTable.size(), 0);
+    for (size_t q = 0; q < ir.size(); ++q) {
+        for (Operand o : {ir.arg1[q], ir.arg2[q]}) {
+            if (o.kind() != OPD_STR || emitted[o.index()]) continue;
+            emitted[o.index()] = 1;
+            out << "static const char s" << o.index() << "[] = ";
+            writeCString(out, ir.context->constantTable[o.index()]);
+            out << ";\n";
+        }
+    }
+    out << "\nint main(void) {\n";
+    emitDeclarations();
+    for (size_t q = 0; q < ir.size(); ++q) emitQuad(q);
+    emitExit();
+}
+
+void emitC(const IRProgram& ir, std::ostream& out) {
+    CEmitter(ir, out).run();
+}
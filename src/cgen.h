@@ -0,0 +1,13 @@
+#ifndef CGEN_H
+#define CGEN_H
+
+#include "irgen.h"
+#include <ostream>
+
+/** C 代码生成（转译为单个自包含的 C 翻译单元，只依赖 <stdint.h> 与 <stdio.h>，可用 cc -O2 编译）：
+ * 四元式序列整体生成为 main 函数，标号与跳转对应 goto，寄存器分配与向量化交给 C 编译器；
+ * 执行结束后输出格式与 emitAssembly 相同：按槽位顺序逐行输出源程序变量的终值 "名字 = 值"
+ */
+void emitC(const IRProgram& ir, std::ostream& out);
+
+#endif
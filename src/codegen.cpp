@@ -0,0 +1,233 @@
+#include "codegen.h"
+#include "cfg.h"
+#include "regalloc.h"
+#include <climits>
+#include <string>
+#include <vector>
+
+/** 汇编生成流程：
+ * 1.确定需要输出终值的源程序变量及其中的字符串变量
+ * 2.寄存器分配，溢出的值放在栈帧中
+ * 3.逐条翻译四元式，rax/r11 作为临时寄存器装载立即数、字符串地址和内存操作数
+ * 4.结束时先把终值存到栈上（printf 会破坏调用者保存的寄存器），再逐个调用 printf 输出
+ */
+
+// 可分配的寄存器：程序主体不调用函数，调用者保存的寄存器也可使用，rax 与 r11 留作临时寄存器
+static const char* const REGISTERS[] = {"%rbx", "%r12", "%r13", "%r14", "%r15", "%rcx",
+                                        "%rdx", "%rsi", "%rdi", "%r8",  "%r9",  "%r10"};
+static const int REGISTER_COUNT = sizeof(REGISTERS) / sizeof(REGISTERS[0]);
+// rbp 之下依次为保存的 rbx、r12~r15，溢出槽，终值区
+static const int SAVED_BYTES = 40;
+
+class AsmEmitter {
+public:
+    AsmEmitter(const IRProgram& ir, std::ostream& out) : ir(ir), out(out) {}
+
+    void run();
+
+private:
+    std::string slotAddress(int slot) const { return std::to_string(-SAVED_BYTES - 8 * (slot + 1)) + "(%rbp)"; }
+    std::string location(Operand o) const;
+    std::string source(Operand o, const char* scratch);
+    static bool isMemory(const std::string& s) { return s.back() == ')'; }
+    void emitMove(const std::string& src, const std::string& dst);
+    void emitCompare(size_t q);
+    void emitQuad(size_t q);
+    void emitExit();
+    void emitData();
+
+    const IRProgram& ir;
+    std::ostream& out;
+    RegisterAllocation alloc;
+    std::vector<char> stringVar; // 变量 -> 是否保存字符串地址
+    std::vector<int> printVars; // 需要输出终值的源程序变量
+};
+
+// 变量/临时变量所在的寄存器或栈槽
+std::string AsmEmitter::location(Operand o) const {
+    int v = alloc.vregOf(o);
+    int loc = v < 0 ? RegisterAllocation::NO_LOCATION : alloc.location[v];
+    if (loc == RegisterAllocation::NO_LOCATION) return "$0";
+    return loc >= 0 ? REGISTERS[loc] : slotAddress(~loc);
+}
+
+// 可直接作为源操作数的形式（寄存器、内存或32位立即数），必要时先装入 scratch
+std::string AsmEmitter::source(Operand o, const char* scratch) {
+    switch (o.kind()) {
+        case OPD_INT: {
+            int64_t value = ir.intPool[o.index()];
+            if (value >= INT32_MIN && value <= INT32_MAX) return "$" + std::to_string(value);
+            out << "    movabsq $" << value << ", " << scratch << "\n";
+            return scratch;
+        }
+        case OPD_STR:
+            out << "    leaq .LS" << o.index() << "(%rip), " << scratch << "\n";
+            return scratch;
+        case OPD_VAR:
+        case OPD_TEMP:
+            return location(o);
+        default:
+            return "$0";
+    }
+}
+
+void AsmEmitter::emitMove(const std::string& src, const std::string& dst) {
+    if (src == dst) return;
+    if (isMemory(src) && isMemory(dst)) {
+        out << "    movq " << src << ", %r11\n";
+        out << "    movq %r11, " << dst << "\n";
+    } else {
+        out << "    movq " << src << ", " << dst << "\n";
+    }
+}
+
+// cmpq arg2, arg1：左操作数不能是立即数，两个操作数不能同为内存
+void AsmEmitter::emitCompare(size_t q) {
+    std::string a = source(ir.arg1[q], "%rax");
+    std::string b = source(ir.arg2[q], "%r11");
+    if (a[0] == '$' || (isMemory(a) && isMemory(b))) {
+        out << "    movq " << a << ", %rax\n";
+        a = "%rax";
+    }
+    out << "    cmpq " << b << ", " << a << "\n";
+}
+
+void AsmEmitter::emitQuad(size_t q) {
+    OpCode op = ir.ops[q];
+    switch (op) {
+        case OP_ASSIGN:
+            emitMove(source(ir.arg1[q], "%r11"), location(ir.result[q]));
+            return;
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_SHL: {
+            // Shl 只由代数化简生成，移位数总是立即数
+            const char* mnemonic = op == OP_ADD ? "addq" : op == OP_SUB ? "subq" : op == OP_MUL ? "imulq" : "shlq";
+            std::string dst = location(ir.result[q]);
+            std::string b = source(ir.arg2[q], "%r11");
+            std::string a = source(ir.arg1[q], "%rax");
+            if (!isMemory(dst) && b != dst) {
+                emitMove(a, dst);
+                out << "    " << mnemonic << " " << b << ", " << dst << "\n";
+            } else {
+                if (a != "%rax") out << "    movq " << a << ", %rax\n";
+                out << "    " << mnemonic << " " << b << ", %rax\n";
+                out << "    movq %rax, " << dst << "\n";
+            }
+            return;
+        }
+        case OP_LT:
+        case OP_EQ:
+            emitCompare(q);
+            out << "    " << (op == OP_LT ? "setl" : "sete") << " %al\n";
+            out << "    movzbl %al, %eax\n";
+            emitMove("%rax", location(ir.result[q]));
+            return;
+        case OP_LABEL:
+            out << ".LB" << ir.result[q].index() << ":\n";
+            return;
+        case OP_JMP:
+            out << "    jmp .LB" << ir.result[q].index() << "\n";
+            return;
+        case OP_JLT:
+        case OP_JEQ:
+        case OP_JNE:
+            emitCompare(q);
+            out << "    " << (op == OP_JLT ? "jl" : op == OP_JEQ ? "je" : "jne") << " .LB" << ir.result[q].index()
+                << "\n";
+            return;
+    }
+}
+
+void AsmEmitter::emitExit() {
+    // 先把终值存入终值区，再逐个输出
+    for (size_t i = 0; i < printVars.size(); ++i) {
+        emitMove(location(Operand::make(OPD_VAR, printVars[i])), slotAddress(alloc.spillSlots + i));
+    }
+    for (size_t i = 0; i < printVars.size(); ++i) {
+        out << "    leaq .LN" << i << "(%rip), %rsi\n";
+        out << "    movq " << slotAddress(alloc.spillSlots + i) << ", %rdx\n";
+        if (stringVar[printVars[i]]) {
+            // 未赋值的字符串变量输出空串
+            out << "    testq %rdx, %rdx\n";
+            out << "    jnz .LP" << i << "\n";
+            out << "    leaq .LEMPTY(%rip), %rdx\n";
+            out << ".LP" << i << ":\n";
+            out << "    leaq .LFMTS(%rip), %rdi\n";
+        } else {
+            out << "    leaq .LFMTI(%rip), %rdi\n";
+        }
+        out << "    xorl %eax, %eax\n";
+        out << "    call printf@PLT\n";
+    }
+    out << "    xorl %eax, %eax\n";
+    out << "    leaq -" << SAVED_BYTES << "(%rbp), %rsp\n";
+    out << "    popq %r15\n    popq %r14\n    popq %r13\n    popq %r12\n    popq %rbx\n    popq %rbp\n    ret\n";
+    out << "    .size main, .-main\n";
+}
+
+// 输出 .string 字面量，引号、反斜杠和不可打印字符按八进制转义
+static void writeStringLiteral(std::ostream& out, const std::string& text) {
+    out << "\"";
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (c < 32 || c > 126) {
+            out << '\\' << (char)('0' + (c >> 6)) << (char)('0' + ((c >> 3) & 7)) << (char)('0' + (c & 7));
+        } else {
+            out << c;
+        }
+    }
+    out << "\"";
+}
+
+void AsmEmitter::emitData() {
+    out << "    .section .rodata\n";
+    out << ".LFMTI:\n    .string \"%s = %ld\\n\"\n";
+    out << ".LFMTS:\n    .string \"%s = %s\\n\"\n";
+    out << ".LEMPTY:\n    .string \"\"\n";
+    for (size_t i = 0; i < printVars.size(); ++i) {
+        out << ".LN" << i << ":\n    .string ";
+        writeStringLiteral(out, ir.context->slotName(printVars[i]));
+        out << "\n";
+    }
+    std::vector<char> emitted(ir.context->constantTable.size(), 0);
+    for (size_t q = 0; q < ir.size(); ++q) {
+        for (Operand o : {ir.arg1[q], ir.arg2[q]}) {
+            if (o.kind() != OPD_STR || emitted[o.index()]) continue;
+            emitted[o.index()] = 1;
+            out << ".LS" << o.index() << ":\n    .string ";
+            writeStringLiteral(out, ir.context->constantTable[o.index()]);
+            out << "\n";
+        }
+    }
+    out << "    .section .note.GNU-stack,\"\",@progbits\n";
+}
+
+void AsmEmitter::run() {
+    printVars = sourceVariables(ir);
+    stringVar = stringVariables(ir);
+    CFG cfg = buildCFG(ir);
+    alloc = allocateRegisters(ir, cfg, REGISTER_COUNT, printVars);
+
+    // 保存寄存器后 rsp 模16余8，栈帧大小也取模16余8，使调用 printf 时 rsp 按16字节对齐
+    int frameBytes = 8 * (alloc.spillSlots + printVars.size());
+    if (frameBytes % 16 == 0) frameBytes += 8;
+    out << "    .text\n    .globl main\n    .type main, @function\nmain:\n";
+    out << "    pushq %rbp\n    movq %rsp, %rbp\n";
+    out << "    pushq %rbx\n    pushq %r12\n    pushq %r13\n    pushq %r14\n    pushq %r15\n";
+    out << "    subq $" << frameBytes << ", %rsp\n";
+    // 先读后写的值（未初始化变量）从0开始
+    for (int v : alloc.liveAtEntry) {
+        int loc = alloc.location[v];
+        out << "    movq $0, " << (loc >= 0 ? REGISTERS[loc] : slotAddress(~loc)) << "\n";
+    }
+    for (size_t q = 0; q < ir.size(); ++q) emitQuad(q);
+    emitExit();
+    emitData();
+}
+
+void emitAssembly(const IRProgram& ir, std::ostream& out) {
+    AsmEmitter(ir, out).run();
+}
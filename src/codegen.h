@@ -0,0 +1,13 @@
+#ifndef CODEGEN_H
+#define CODEGEN_H
+
+#include "irgen.h"
+#include <ostream>
+
+/** x86-64 汇编生成（System V ABI，AT&T 语法，可直接用 cc 汇编链接）：
+ * 四元式序列整体生成为 main 函数，变量与临时变量经线性扫描分配到寄存器，
+ * 执行结束后按槽位顺序逐行输出源程序变量的终值："名字 = 值"，字符串变量输出其内容
+ */
+void emitAssembly(const IRProgram& ir, std::ostream& out);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include "parser.h"
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct CompileStats;
+
+// 额外槽位的种类：语义分析为同名不同类型的变量拆出的槽位按源名字输出终值，优化器引入的变量不输出
+enum SlotKind {
+    SLOT_SPLIT,
+    SLOT_SYNTHETIC
+};
+
+struct ExtraSlot {
+    SlotKind kind;
+    std::string name; // SLOT_SPLIT 为源程序中的名字，SLOT_SYNTHETIC 为优化器起的名字（如 "i*12"）
+};
+
+// 流式编译时额外槽位的起点：语义分析与词法分析交替进行，之后驻留的标识符不会用到这个范围
+const uint32_t STREAM_EXTRA_SLOTS = 1u << 28;
+
+/** 一次编译的全部状态：符号表、常量表与各阶段的错误
+ * 词法、语法、语义分析和中间代码生成都显式接收 ctx，IRProgram 记录生成它的 ctx 供后续各遍使用，
+ * 不同 CompilationContext 之间不共享可变状态，可以在不同线程中同时编译
+ * 变量槽位（IR 中 OPD_VAR 的下标）：标识符的槽位即其id；不对应标识符的槽位从 firstExtraSlot 起编号，
+ * 第 k 个为 extraSlots[k]，标识符表只由词法分析写入
+ */
+struct CompilationContext {
+    Interner identifierTable; // 源程序中的标识符
+    Interner constantTable; // 数字常量和字符串常量
+    uint32_t firstExtraSlot = NO_SLOT; // NO_SLOT 表示尚未分配额外槽位
+    std::vector<ExtraSlot> extraSlots;
+    std::vector<LexError> lexErrors;
+    std::vector<ParseError> parseErrors;
+    int semanticErrors = 0;
+    std::ostream* diagnostics = &std::cerr; // 词法/语法/语义错误的输出位置
+    CompileStats* stats = nullptr; // 非空时记录各阶段耗时与计数（--time-report、--stats=json）
+
+    // 分配一个额外槽位；未指定起点时接在标识符之后编号，此时词法分析须已结束
+    uint32_t addSlot(SlotKind kind, const std::string& name) {
+        if (firstExtraSlot == NO_SLOT) firstExtraSlot = identifierTable.size();
+        extraSlots.push_back({kind, name});
+        return firstExtraSlot + extraSlots.size() - 1;
+    }
+    // 同种类同名的额外槽位，不存在时返回 NO_SLOT
+    uint32_t findSlot(SlotKind kind, const std::string& name) const {
+        for (size_t k = 0; k < extraSlots.size(); ++k) {
+            if (extraSlots[k].kind == kind && extraSlots[k].name == name) return firstExtraSlot + k;
+        }
+        return NO_SLOT;
+    }
+    // 槽位数的上界（不含），按槽位索引的表以此为长度
+    size_t slotCount() const { return extraSlots.empty() ? identifierTable.size() : firstExtraSlot + extraSlots.size(); }
+    bool isExtraSlot(uint32_t slot) const { return slot >= firstExtraSlot; }
+    const std::string& slotName(uint32_t slot) const {
+        return isExtraSlot(slot) ? extraSlots[slot - firstExtraSlot].name : identifierTable[slot];
+    }
+    bool isSynthetic(uint32_t slot) const {
+        return isExtraSlot(slot) && extraSlots[slot - firstExtraSlot].kind == SLOT_SYNTHETIC;
+    }
+};
+
+#endif
@@ -0,0 +1,357 @@
+#include "driver.h"
+#include "context.h"
+#include "semantic.h"
+#include "irgen.h"
+#include "cfg.h"
+#include "optimizer.h"
+#include "codegen.h"
+#include "cgen.h"
+#include "vm.h"
+#include "jit.h"
+#include "threadpool.h"
+#include "ast_visualize.h"
+#include "cache.h"
+#include "binary.h"
+#include "stats.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+void writeTokens(const std::vector<Token>& tokens, std::ostream& out) {
+    for (const auto& tok : tokens) {
+        out << tok.type << " " << tok.value << "\n";
+    }
+}
+
+static void writeTokenStream(const std::vector<Token>& tokens, const std::string& outDir) {
+    std::ofstream fout(outDir + "/tokens.txt");
+    writeTokens(tokens, fout);
+    fout.close();
+}
+
+static void writeInterner(const Interner& table, const std::string& filename) {
+    std::ofstream fout(filename);
+    for (size_t i = 0; i < table.size(); ++i) {
+        fout << i << ": " << table[i] << "\n";
+    }
+    fout.close();
+}
+
+void compileFrontEnd(CompilationContext& ctx, FrontEnd& front) {
+    {
+        PhaseTimer timer(ctx.stats, "parse");
+        front.ast = parse(ctx, front.tokens);
+    }
+    printParseErrors(ctx);
+    // 有语法错误则不继续语义分析和IR生成
+    front.parseFailed = front.ast.root == NO_NODE || !ctx.parseErrors.empty();
+    if (front.parseFailed) return;
+    {
+        PhaseTimer timer(ctx.stats, "semantic");
+        front.semanticsFailed = !checkSemantics(ctx, front.ast);
+    }
+    if (front.semanticsFailed) return;
+    PhaseTimer timer(ctx.stats, "irgen");
+    front.ir = generateIR(ctx, front.ast);
+}
+
+bool optimizeIR(IRProgram& ir, const std::vector<std::string>& passes, std::vector<PassStats>& stats,
+                std::string& error) {
+    return runPasses(ir, passes, stats, error) && checkOperandLimits(ir, error);
+}
+
+static std::string readSource(const std::string& path) {
+    std::ifstream fin(path, std::ios::binary);
+    std::ostringstream buffer;
+    buffer << fin.rdbuf();
+    return buffer.str();
+}
+
+static std::string joinPasses(const std::vector<std::string>& passes) {
+    std::string list;
+    for (const std::string& p : passes) list += p + ",";
+    return list;
+}
+
+// 从缓存恢复前端产物，未命中时编译并写入缓存；错误输出先收集到 front.diagnostics 再一并输出
+static void loadFrontEnd(CompileCache& cache, const std::string& key, const std::string& source,
+                         CompilationContext& ctx, FrontEnd& front) {
+    std::string data;
+    {
+        PhaseTimer timer(ctx.stats, "cache");
+        if (cache.load(key, data) && decodeFrontEnd(data, ctx, front)) return;
+    }
+    ctx.identifierTable.clear();
+    ctx.constantTable.clear();
+    ctx.firstExtraSlot = NO_SLOT;
+    ctx.extraSlots.clear();
+    front = FrontEnd();
+    std::ostream* diagnostics = ctx.diagnostics;
+    std::ostringstream captured;
+    ctx.diagnostics = &captured;
+    {
+        PhaseTimer timer(ctx.stats, "lex");
+        front.tokens = runLexerBuffer(ctx, source);
+    }
+    compileFrontEnd(ctx, front);
+    ctx.diagnostics = diagnostics;
+    front.diagnostics = captured.str();
+    cache.store(key, encodeFrontEnd(ctx, front));
+}
+
+// 优化并写出 ir.txt、cfg.txt（--emit=bin 时由调用者写入容器）、out.s、out.c、bytecode.txt，再按选项执行
+static int compileBackEnd(IRProgram& ir, CompileCache* cache, const std::string& frontKey, const std::string& outDir,
+                          const CompileOptions& options, CompileStats* stats, std::ostream& out,
+                          std::ostream& diagnostics) {
+    std::string optKey, data;
+    bool optimized = false;
+    if (cache && !options.passes.empty()) {
+        PhaseTimer timer(stats, "cache");
+        optKey = cacheKey({frontKey, "passes", joinPasses(options.passes)});
+        optimized = !options.optStats && cache->load(optKey, data) && decodeOptimizedIR(data, ir);
+    }
+    if (!optimized) {
+        PhaseTimer timer(stats, "optimize");
+        std::vector<PassStats> stats;
+        std::string optError;
+        if (!optimizeIR(ir, options.passes, stats, optError)) {
+            diagnostics << optError << "\n";
+            return 1;
+        }
+        if (options.optStats) writePassStats(stats, out);
+        if (!optKey.empty()) cache->store(optKey, encodeOptimizedIR(ir));
+    }
+    if (stats) stats->optimizedQuads = ir.size();
+    if (!options.emitBinary) {
+        PhaseTimer timer(stats, "output");
+        std::ofstream irout(outDir + "/ir.txt");
+        writeIR(ir, irout);
+        irout.close();
+        std::ofstream cfgout(outDir + "/cfg.txt");
+        writeCFG(ir, buildCFG(ir), cfgout);
+        cfgout.close();
+    }
+    if (options.emitAsm) {
+        PhaseTimer timer(stats, "codegen");
+        std::ofstream asmout(outDir + "/out.s");
+        emitAssembly(ir, asmout);
+        asmout.close();
+    }
+    if (options.emitC) {
+        PhaseTimer timer(stats, "codegen");
+        std::ofstream csrc(outDir + "/out.c");
+        emitC(ir, csrc);
+        csrc.close();
+    }
+    if (options.run) {
+        PhaseTimer timer(stats, "run");
+        Bytecode bc = compileBytecode(ir);
+        std::ofstream bcout(outDir + "/bytecode.txt");
+        writeBytecode(bc, bcout);
+        bcout.close();
+        writeFinalValues(ir, runBytecode(bc), out);
+    }
+    if (options.jit) {
+        PhaseTimer timer(stats, "jit");
+        JitStats jitStats;
+        writeFinalValues(ir, runTiered(ir, options.jitThreshold, jitStats), out);
+        writeJitStats(jitStats, out);
+    }
+    return 0;
+}
+
+/* 流式编译：词法分析按需读入源文件，语法分析每完成 main 中的一条语句就做语义检查并生成IR写入 ir.txt，随后释放这条语句，
+ * 内存只与单条语句和符号表的大小有关；token流、符号表、ir.txt 与错误输出和非流式 -O0 编译相同：
+ *   词法、语法错误在分析结束后按原顺序输出，语义错误先暂存，没有语法错误时才输出
+ *   IR 先写入临时文件，没有语法和语义错误时才替换 ir.txt
+ * 需要整棵树或整个IR的 ast.dot（及其他AST格式）、cfg.txt 不生成，删除旧文件以免与本次结果混淆
+ */
+static int compileStreaming(const std::string& inputPath, const std::string& outDir, CompileStats* stats,
+                            std::ostream& diagnostics) {
+    CompilationContext ctx;
+    ctx.stats = stats;
+    ctx.firstExtraSlot = STREAM_EXTRA_SLOTS; // 标识符表还在增长，额外槽位不能接在其后编号
+    std::ostringstream semanticDiagnostics;
+    ctx.diagnostics = &semanticDiagnostics;
+    std::ofstream tokenOut(outDir + "/tokens.txt");
+    std::string irPath = outDir + "/ir.txt", irTemp = irPath + ".tmp";
+    std::ofstream irOut(irTemp);
+    LexerCursor cursor(ctx, inputPath, &tokenOut);
+
+    IRProgram ir;
+    ir.context = &ctx;
+    SymbolTable symbols;
+    std::string limitError; // 临时变量、标号等的编号随文件增长，超出操作数下标范围后停止生成IR
+    PhaseTimer timer(stats, "stream"); // 各阶段交替进行，作为一个阶段计时
+    parseStream(ctx, cursor, [&](AST& ast, NodeId stmt) {
+        // 已有语法错误或编号越界时不再做语义分析和IR生成，已有语义错误时只继续检查
+        if (!ctx.parseErrors.empty() || !limitError.empty()) return;
+        checkStatement(ctx, ast, stmt, symbols);
+        if (stmt == STREAM_BLOCK_BEGIN || stmt == STREAM_BLOCK_END || ctx.semanticErrors > 0) return;
+        generateIR(ctx, ast, stmt, ir);
+        if (!checkOperandLimits(ir, limitError)) return;
+        writeIR(ir, irOut);
+        if (stats) stats->quads += ir.size();
+        ir.clearCode();
+    });
+    // 语法分析在 main 结束后停止，其后的部分也要出现在 token流与词法错误中
+    while (cursor.fill()) cursor.discard(cursor.window.size());
+    tokenOut.close();
+    irOut.close();
+    if (stats) {
+        stats->tokens = cursor.produced;
+        stats->identifiers = ctx.identifierTable.size();
+        stats->constants = ctx.constantTable.size();
+        stats->optimizedQuads = stats->quads;
+    }
+
+    ctx.diagnostics = &diagnostics;
+    printLexErrors(ctx);
+    printParseErrors(ctx);
+    writeInterner(ctx.identifierTable, outDir + "/identifier_table.txt");
+    writeInterner(ctx.constantTable, outDir + "/constant_table.txt");
+    for (AstFormat format : {AST_DOT, AST_JSON, AST_SEXPR}) std::remove((outDir + "/ast." + astFormatName(format)).c_str());
+    std::remove((outDir + "/cfg.txt").c_str());
+    if (!ctx.parseErrors.empty() || !limitError.empty()) {
+        if (ctx.parseErrors.empty()) diagnostics << limitError << "\n";
+        std::remove(irTemp.c_str());
+        return 1;
+    }
+    diagnostics << semanticDiagnostics.str();
+    if (ctx.semanticErrors > 0) {
+        std::remove(irTemp.c_str());
+        return 1;
+    }
+    std::rename(irTemp.c_str(), irPath.c_str());
+    return 0;
+}
+
+/* 启用缓存时：
+ * 前端键只含源码，命中时跳过词法分析到IR生成；优化键再加上优化遍列表，命中时跳过优化（--opt-stats 需要实际运行各遍，不读优化条目）
+ * 缓存只跳过阶段，outDir 下的文件每次都重写，不会留下其他程序或其他选项的输出
+ */
+static int compileWhole(const std::string& inputPath, const std::string& outDir, const CompileOptions& options,
+                        CompileStats* stats, std::ostream& out, std::ostream& diagnostics) {
+    CompilationContext ctx;
+    ctx.diagnostics = &diagnostics;
+    ctx.stats = stats;
+    FrontEnd front;
+    std::unique_ptr<CompileCache> cache;
+    std::string frontKey;
+    if (options.cacheDir.empty()) {
+        {
+            PhaseTimer timer(stats, "lex");
+            front.tokens = options.useMmap ? runLexerMapped(ctx, inputPath) : runLexer(ctx, inputPath);
+        }
+        compileFrontEnd(ctx, front);
+    } else {
+        cache.reset(new CompileCache(options.cacheDir, options.cacheLimit));
+        std::string source = readSource(inputPath);
+        frontKey = cacheKey({"front", source});
+        loadFrontEnd(*cache, frontKey, source, ctx, front);
+        diagnostics << front.diagnostics;
+    }
+
+    if (stats) {
+        stats->tokens = front.tokens.size();
+        stats->astNodes = front.ast.nodes.size();
+        stats->identifiers = ctx.identifierTable.size();
+        stats->constants = ctx.constantTable.size();
+        stats->quads = front.ir.size();
+    }
+
+    int status = 0;
+    if (!options.emitBinary) {
+        PhaseTimer timer(stats, "output");
+        writeTokenStream(front.tokens, outDir);
+        writeInterner(ctx.identifierTable, outDir + "/identifier_table.txt");
+        writeInterner(ctx.constantTable, outDir + "/constant_table.txt");
+        if (!front.parseFailed) {
+            const AstExportOptions& ast = options.astExport;
+            exportAST(ctx, front.ast, outDir + "/ast." + astFormatName(ast.format), ast);
+        }
+    }
+    if (front.parseFailed || front.semanticsFailed) status = 1;
+    else status = compileBackEnd(front.ir, cache.get(), frontKey, outDir, options, stats,
+                                                             out, diagnostics);
+    if (options.emitBinary) {
+        // 优化失败时与文本输出一样不写IR
+        bool hasIR = !front.parseFailed && !front.semanticsFailed && status == 0;
+        PhaseTimer timer(stats, "output");
+        std::string error;
+        if (!writeBinary(outDir + "/out.mjb", ctx, front.tokens, front.parseFailed ? nullptr : &front.ast,
+                         hasIR ? &front.ir : nullptr, error)) {
+            diagnostics << error << "\n";
+            status = 1;
+        }
+    }
+
+    if (cache) {
+        CacheStats current = cache->stats();
+        CacheStats total = cache->flushStats();
+        if (options.cacheStats) {
+            size_t entries;
+            uint64_t bytes;
+            cache->usage(entries, bytes);
+            writeCacheStats(current, total, entries, bytes, out);
+        }
+    }
+    return status;
+}
+
+int compileFile(const std::string& inputPath, const std::string& outDir, const CompileOptions& options,
+                std::ostream& out, std::ostream& diagnostics) {
+    CompileStats stats;
+    CompileStats* recorded = options.timeReport || options.statsJson ? &stats : nullptr;
+    int status = options.stream ? compileStreaming(inputPath, outDir, recorded, diagnostics)
+                                : compileWhole(inputPath, outDir, options, recorded, out, diagnostics);
+    if (recorded) {
+        recordPeakRss(stats);
+        if (options.timeReport) writeTimeReport(stats, out);
+        if (options.statsJson) writeStatsJson(stats, out);
+    }
+    return status;
+}
+
+BatchResult compileBatch(const std::vector<std::string>& inputs, const std::string& outRoot,
+                         const CompileOptions& options, int threads) {
+    BatchResult result;
+    result.files = inputs.size();
+    result.threads = std::max(1, threads);
+    std::vector<std::string> outDirs(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        outDirs[i] = outRoot + "/" + std::filesystem::path(inputs[i]).filename().string();
+        std::filesystem::create_directories(outDirs[i]);
+    }
+    std::atomic<size_t> failed(0);
+    auto start = std::chrono::steady_clock::now();
+    runWorkStealing(inputs.size(), result.threads, [&](size_t i) {
+        std::ofstream out(outDirs[i] + "/stdout.txt");
+        std::ofstream diagnostics(outDirs[i] + "/diagnostics.txt");
+        if (compileFile(inputs[i], outDirs[i], options, out, diagnostics) != 0) ++failed;
+    });
+    result.elapsedMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.failed = failed;
+    return result;
+}
+
+void writeBatchResult(const BatchResult& result, std::ostream& out) {
+    out << "批量编译 " << result.files << " 个文件（失败 " << result.failed << " 个），" << result.threads
+        << " 个线程，耗时 " << result.elapsedMs << " ms，吞吐量 " << result.files * 1000.0 / result.elapsedMs
+        << " 文件/秒\n";
+}
+
+std::vector<std::string> listSourceFiles(const std::string& dir) {
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (entry.is_regular_file()) files.push_back(entry.path().string());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
@@ -0,0 +1,70 @@
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include "lex.h"
+#include "ast_visualize.h"
+#include "cache.h"
+#include "optimizer.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 编译选项，对应 main 的命令行参数
+struct CompileOptions {
+    bool useMmap = false; // --mmap：使用内存映射词法分析
+    std::vector<std::string> passes; // -O0/-O1/-O2 或 --passes=遍1,遍2,...
+    bool optStats = false; // --opt-stats：输出各优化遍统计
+    bool emitAsm = false; // --emit=asm：另外生成 x86-64 汇编 out.s
+    bool emitC = false; // --emit=c：另外生成自包含的 C 源码 out.c
+    bool emitBinary = false; // --emit=bin：token流、符号表、AST、IR 写入二进制容器 out.mjb 而不是各文本文件（--emit=text）
+    bool run = false; // --run：在字节码虚拟机上执行并输出变量终值
+    bool jit = false; // --jit：分层执行（解释 + 热循环即时编译），输出变量终值与编译/执行耗时
+    int jitThreshold = 1000; // --jit-threshold=N：回边执行 N 次后编译该循环
+    std::string cacheDir; // --cache=目录：启用内容寻址的编译缓存
+    uint64_t cacheLimit = 256ull << 20; // --cache-size=MB：缓存总大小上限，超出时按 LRU 淘汰
+    bool cacheStats = false; // --cache-stats：输出缓存命中/未命中统计
+    bool stream = false; // --stream：流式编译，逐条语句生成IR后释放，不做优化也不输出 ast.dot/cfg.txt
+    bool timeReport = false; // --time-report：输出各阶段耗时、分配与计数的表格
+    bool statsJson = false; // --stats=json：以一行JSON输出同样的统计
+    AstExportOptions astExport; // --ast=dot/json/sexp 选择 ast.<格式> 的格式，--ast-depth=N、--ast-collapse=N、--ast-lines=A-B 限制导出范围
+};
+
+/** 编译单个源文件：使用独立的 CompilationContext，token流、符号表、AST、IR 等写入 outDir，
+ * 优化统计、执行结果与 --time-report/--stats=json 的统计输出到 out，词法/语法/语义错误输出到 diagnostics
+ * 返回进程退出码：有语法错误、语义错误或优化遍配置错误时为1
+ */
+int compileFile(const std::string& inputPath, const std::string& outDir, const CompileOptions& options,
+                std::ostream& out, std::ostream& diagnostics);
+
+/* 直接编译（compileFile）与编译服务器（handleRequest）共用的编译步骤，两条路径的错误判断因此一致：
+ * compileFrontEnd：对调用者给出的 front.tokens 做语法分析、语义分析与IR生成，设置 parseFailed/semanticsFailed，
+ *   错误输出到 ctx.diagnostics
+ * optimizeIR：依次运行优化遍并检查操作数编号是否越界，失败时返回false并设置 error
+ */
+void compileFrontEnd(CompilationContext& ctx, FrontEnd& front);
+bool optimizeIR(IRProgram& ir, const std::vector<std::string>& passes, std::vector<PassStats>& stats,
+                std::string& error);
+
+struct BatchResult {
+    size_t files = 0;
+    size_t failed = 0;
+    int threads = 0;
+    double elapsedMs = 0;
+};
+
+/** 批量编译：每个文件是一个任务，在工作窃取线程池上并行执行，
+ * 结果写入 outRoot/<文件名>/，其中 stdout.txt 与 diagnostics.txt 分别保存 out 与 diagnostics 的内容
+ */
+BatchResult compileBatch(const std::vector<std::string>& inputs, const std::string& outRoot,
+                         const CompileOptions& options, int threads);
+
+// token流的文本形式，每行 "类型 值"，与 tokens.txt 相同
+void writeTokens(const std::vector<Token>& tokens, std::ostream& out);
+
+void writeBatchResult(const BatchResult& result, std::ostream& out);
+
+// 目录下的所有普通文件，按路径排序
+std::vector<std::string> listSourceFiles(const std::string& dir);
+
+#endif
@@ -0,0 +1,251 @@
+#include "incremental.h"
+#include <algorithm>
+
+/** 编辑流程（applyEdit）：
+ * 1.拼接被编辑的首尾两行与替换文本，得到新的若干行并逐行重新词法分析
+ * 2.旧token流中位于被编辑行上的区间 [a, b) 换成新token，之后的token行号平移
+ * 3.沿AST自根向下找出严格包含 [a, b) 的语句链，从最内层语句块开始尝试局部重新分析（reparseInBlock）
+ * 4.成功后平移区间之后所有旧节点的 StatementSpan 与行号；都失败则整体重新分析
+ */
+
+static std::vector<std::string> splitLines(const std::string& text) {
+    std::vector<std::string> result;
+    size_t pos = 0;
+    while (true) {
+        size_t newline = text.find('\n', pos);
+        if (newline == std::string::npos) break;
+        result.push_back(text.substr(pos, newline - pos));
+        pos = newline + 1;
+    }
+    result.push_back(text.substr(pos));
+    return result;
+}
+
+IncrementalDocument::IncrementalDocument(CompilationContext& ctx, const std::string& source)
+    : ctx(ctx), lines(splitLines(source)) {
+    ctx.lexErrors.clear();
+    for (size_t i = 0; i < lines.size(); ++i) lexLine(ctx, lines[i], i + 1, tokenList);
+    EditStats stats;
+    fullReparse(stats);
+}
+
+std::string IncrementalDocument::text() const {
+    std::string result;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (i) result += '\n';
+        result += lines[i];
+    }
+    return result;
+}
+
+void IncrementalDocument::fullReparse(EditStats& stats) {
+    tree = parse(ctx, tokenList, spans);
+    garbageNodes = 0;
+    stats.fullReparse = true;
+    stats.reparsedTokens = tokenList.size();
+}
+
+size_t IncrementalDocument::subtreeSize(NodeId id) const {
+    size_t count = 0;
+    std::vector<NodeId> stack{id};
+    while (!stack.empty()) {
+        NodeId node = stack.back();
+        stack.pop_back();
+        if (node == NO_NODE) continue;
+        ++count;
+        stack.insert(stack.end(), tree.childBegin(tree[node]), tree.childEnd(tree[node]));
+    }
+    return count;
+}
+
+void IncrementalDocument::shiftLines(size_t nodeCount, int lastLine, int delta, size_t skipErrorsBegin,
+                                     size_t skipErrorsEnd) {
+    if (delta == 0) return;
+    for (size_t id = 0; id < nodeCount; ++id) {
+        if (tree.nodes[id].line > lastLine) tree.nodes[id].line += delta;
+    }
+    for (size_t i = 0; i < ctx.parseErrors.size(); ++i) {
+        if ((i < skipErrorsBegin || i >= skipErrorsEnd) && ctx.parseErrors[i].line > lastLine) {
+            ctx.parseErrors[i].line += delta;
+        }
+    }
+}
+
+EditStats IncrementalDocument::applyEdit(const TextEdit& edit) {
+    EditStats stats;
+
+    // 1.替换文本，被编辑的行为 [first, last]
+    int first = std::clamp(edit.startLine, 1, (int)lines.size());
+    int last = std::clamp(edit.endLine, first, (int)lines.size());
+    const std::string& head = lines[first - 1];
+    const std::string& tail = lines[last - 1];
+    size_t startColumn = std::min((size_t)std::max(edit.startColumn, 1) - 1, head.size());
+    size_t endColumn = std::min((size_t)std::max(edit.endColumn, 1) - 1, tail.size());
+    if (first == last) endColumn = std::max(endColumn, startColumn);
+    std::vector<std::string> replacement =
+        splitLines(head.substr(0, startColumn) + edit.text + tail.substr(endColumn));
+    int delta = (int)replacement.size() - (last - first + 1);
+    lines.erase(lines.begin() + first - 1, lines.begin() + last);
+    lines.insert(lines.begin() + first - 1, replacement.begin(), replacement.end());
+
+    // 2.重新词法分析新行，替换对应的词法错误与token
+    std::vector<Token> fresh;
+    std::vector<LexError> freshErrors;
+    freshErrors.swap(ctx.lexErrors);
+    for (size_t i = 0; i < replacement.size(); ++i) lexLine(ctx, replacement[i], first + i, fresh);
+    freshErrors.swap(ctx.lexErrors);
+    stats.relexedLines = replacement.size();
+
+    auto lexBegin = std::find_if(ctx.lexErrors.begin(), ctx.lexErrors.end(),
+                                 [&](const LexError& e) { return e.line >= first; });
+    auto lexEnd = std::find_if(lexBegin, ctx.lexErrors.end(), [&](const LexError& e) { return e.line > last; });
+    for (auto it = lexEnd; it != ctx.lexErrors.end(); ++it) it->line += delta;
+    lexBegin = ctx.lexErrors.insert(ctx.lexErrors.erase(lexBegin, lexEnd), freshErrors.begin(), freshErrors.end());
+
+    size_t a = std::lower_bound(tokenList.begin(), tokenList.end(), first,
+                                [](const Token& t, int line) { return t.line < line; }) - tokenList.begin();
+    size_t b = std::lower_bound(tokenList.begin() + a, tokenList.end(), last + 1,
+                                [](const Token& t, int line) { return t.line < line; }) - tokenList.begin();
+    for (size_t i = b; i < tokenList.size(); ++i) tokenList[i].line += delta;
+    long dn = (long)fresh.size() - (long)(b - a);
+    tokenList.erase(tokenList.begin() + a, tokenList.begin() + b);
+    tokenList.insert(tokenList.begin() + a, fresh.begin(), fresh.end());
+
+    // token流未变（如编辑注释或空白）时只需平移行号
+    if (a == b && fresh.empty()) {
+        shiftLines(tree.nodes.size(), last, delta, 0, 0);
+        return stats;
+    }
+
+    // 3.自根向下找出严格包含 [a, b) 的语句链
+    std::vector<NodeId> path;
+    auto contains = [&](NodeId id) {
+        return id != NO_NODE && spans[id].firstToken != NO_SPAN && spans[id].firstToken < a && b < spans[id].endToken;
+    };
+    for (NodeId cur = tree.root; cur != NO_NODE;) {
+        path.push_back(cur);
+        const ASTNode& node = tree[cur];
+        NodeId next = NO_NODE;
+        if (node.kind == NK_BLOCK) {
+            // 子语句按位置有序，二分找到第一个结束于 b 之后的子语句
+            const NodeId* it = std::upper_bound(tree.childBegin(node), tree.childEnd(node), b,
+                                                [&](size_t pos, NodeId c) { return pos < spans[c].endToken; });
+            if (it != tree.childEnd(node) && contains(*it)) next = *it;
+        } else if (node.kind == NK_PROGRAM || node.kind == NK_IF || node.kind == NK_WHILE) {
+            for (const NodeId* it = tree.childBegin(node); it != tree.childEnd(node); ++it) {
+                if (*it != NO_NODE && *it < spans.size() && contains(*it)) next = *it;
+            }
+        }
+        cur = next;
+    }
+
+    for (size_t depth = path.size(); depth-- > 0;) {
+        NodeId block = path[depth];
+        if (tree[block].kind != NK_BLOCK) continue;
+        size_t closePos = spans[block].endToken - 1 + dn; // 编辑后 } 的位置
+        const Token& close = tokenList[closePos];
+        if (close.type != DELIMITER || close.value != '}') continue;
+        if (reparseInBlock(path, depth, a, b, dn, last, delta, stats)) {
+            if (garbageNodes * 2 > tree.nodes.size()) fullReparse(stats);
+            return stats;
+        }
+    }
+    fullReparse(stats);
+    return stats;
+}
+
+bool IncrementalDocument::reparseInBlock(const std::vector<NodeId>& path, size_t depth, size_t a, size_t b, long dn,
+                                         int lastLine, int delta, EditStats& stats) {
+    NodeId block = path[depth];
+    const StatementSpan blockSpan = spans[block];
+    std::vector<NodeId> children(tree.childBegin(tree[block]), tree.childEnd(tree[block]));
+    size_t count = children.size();
+
+    // 边界 k（0..count）是第 k 个子语句的起点，count+1 是 } 的位置；均为旧token流中的下标
+    auto boundary = [&](size_t k) -> size_t {
+        if (k == 0) return blockSpan.firstToken + 1;
+        if (k > count) return blockSpan.endToken - 1;
+        return spans[children[k - 1]].endToken;
+    };
+    auto lookahead = [&](size_t k) -> size_t {
+        return k == 0 ? blockSpan.firstToken + 1 : spans[children[k - 1]].lookahead;
+    };
+    auto errorAt = [&](size_t k) -> uint32_t {
+        if (k == 0) return blockSpan.firstError;
+        if (k > count) return blockSpan.endError;
+        return spans[children[k - 1]].endError;
+    };
+
+    // 起点：不晚于 a 且分析时未看到 a 及其后token的最后一个边界；终点：不早于 b 的第一个边界
+    size_t k = 0, high = count;
+    while (k < high) {
+        size_t mid = (k + high + 1) / 2;
+        if (boundary(mid) <= a) k = mid;
+        else high = mid - 1;
+    }
+    while (k > 0 && lookahead(k) > a) --k;
+    size_t m = k;
+    for (high = count + 1; m < high;) {
+        size_t mid = (m + high) / 2;
+        if (boundary(mid) >= b) high = mid;
+        else m = mid + 1;
+    }
+    size_t begin = boundary(k), oldEnd = boundary(m);
+    size_t stop = oldEnd + dn;
+
+    size_t nodeMark = tree.nodes.size(), childMark = tree.childList.size();
+    uint32_t errorBegin = errorAt(k), errorEnd = errorAt(m);
+    std::vector<ParseError> errors;
+    std::vector<NodeId> statements;
+    // 错误数达到上限时分析会提前停止，其后的语句依赖错误总数，只能完整重新分析
+    if (ctx.parseErrors.size() >= MAX_PARSE_ERRORS ||
+        !reparseStatements(ctx, tokenList, begin, stop, lookahead(k), errorBegin, tree, spans, errors, statements) ||
+        ctx.parseErrors.size() - (errorEnd - errorBegin) + errors.size() >= MAX_PARSE_ERRORS) {
+        tree.nodes.resize(nodeMark);
+        tree.childList.resize(childMark);
+        spans.resize(nodeMark);
+        return false;
+    }
+    stats.reparsedTokens = stop - begin;
+
+    // 换入新语句：个数不变时原地覆盖，否则在 childList 末尾写入新的子节点区间
+    size_t replacedEnd = std::min(m, count);
+    for (size_t i = k; i < replacedEnd; ++i) garbageNodes += subtreeSize(children[i]);
+    ASTNode& node = tree.nodes[block];
+    if (statements.size() == replacedEnd - k) {
+        std::copy(statements.begin(), statements.end(), tree.childList.begin() + node.firstChild + k);
+    } else {
+        std::vector<NodeId> merged(children.begin(), children.begin() + k);
+        merged.insert(merged.end(), statements.begin(), statements.end());
+        merged.insert(merged.end(), children.begin() + replacedEnd, children.end());
+        node.firstChild = tree.childList.size();
+        node.childCount = merged.size();
+        tree.childList.insert(tree.childList.end(), merged.begin(), merged.end());
+    }
+
+    // 替换这一段的语法错误
+    long dErr = (long)errors.size() - (long)(errorEnd - errorBegin);
+    ctx.parseErrors.erase(ctx.parseErrors.begin() + errorBegin, ctx.parseErrors.begin() + errorEnd);
+    ctx.parseErrors.insert(ctx.parseErrors.begin() + errorBegin, errors.begin(), errors.end());
+
+    // 4.平移旧节点：区间之后的语句整体平移，包含区间的祖先只平移结束位置
+    if (dn != 0 || dErr != 0) {
+        for (size_t id = 0; id < nodeMark; ++id) {
+            StatementSpan& span = spans[id];
+            if (span.firstToken == NO_SPAN || span.firstToken < oldEnd) continue;
+            span.firstToken += dn;
+            span.endToken += dn;
+            span.lookahead += dn;
+            span.firstError += dErr;
+            span.endError += dErr;
+        }
+        for (size_t i = 0; i <= depth; ++i) {
+            StatementSpan& span = spans[path[i]];
+            span.endToken += dn;
+            span.lookahead += dn;
+            span.endError += dErr;
+        }
+    }
+    shiftLines(nodeMark, lastLine, delta, errorBegin, errorBegin + errors.size());
+    return true;
+}
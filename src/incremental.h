@@ -0,0 +1,61 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "context.h"
+#include <string>
+#include <vector>
+
+/** 增量词法/语法分析（编辑器集成）：
+ * 文档保存源码各行、token流、AST 与每个语句节点的 StatementSpan，每次编辑：
+ * 1.词法分析按行进行且各行互不影响，只重新分析被编辑的行，其后token的行号整体平移
+ * 2.自外向内找到严格包含被修改token的最内层语句块，在其中选出覆盖修改的一段连续子语句，
+ *   从这段之前的状态开始重新分析，恰好停在这段之后的位置时把新语句换入语句块，其余节点原样保留；
+ *   否则换外一层语句块重试，都不行时整体重新分析
+ * 3.被换下的节点留在节点池中成为垃圾，超过节点总数一半时整体重新分析以回收
+ * 词法错误与语法错误保存在 ctx.lexErrors / ctx.parseErrors 中，与对编辑后的全文完整分析的结果相同
+ */
+
+// 把 [起点, 终点) 替换为 text；行列号从1开始，列按字节计
+struct TextEdit {
+    int startLine;
+    int startColumn;
+    int endLine;
+    int endColumn;
+    std::string text; // 替换文本，可以含换行
+};
+
+struct EditStats {
+    size_t relexedLines = 0;
+    size_t reparsedTokens = 0; // 重新分析的token数（按编辑后的token流计）
+    bool fullReparse = false;
+};
+
+class IncrementalDocument {
+public:
+    // 完整分析 source，标识符与常量驻留到 ctx 中
+    IncrementalDocument(CompilationContext& ctx, const std::string& source);
+
+    EditStats applyEdit(const TextEdit& edit);
+
+    const std::vector<Token>& tokens() const { return tokenList; }
+    const AST& ast() const { return tree; }
+    std::string text() const;
+
+private:
+    void fullReparse(EditStats& stats);
+    // 在语句块 path[depth] 中重新分析覆盖旧token区间 [a, b) 的子语句，成功时完成替换与平移
+    bool reparseInBlock(const std::vector<NodeId>& path, size_t depth, size_t a, size_t b, long dn, int lastLine,
+                        int delta, EditStats& stats);
+    // 编辑只改变了行号时平移节点与语法错误的行号
+    void shiftLines(size_t nodeCount, int lastLine, int delta, size_t skipErrorsBegin, size_t skipErrorsEnd);
+    size_t subtreeSize(NodeId id) const;
+
+    CompilationContext& ctx;
+    std::vector<std::string> lines;
+    std::vector<Token> tokenList;
+    AST tree;
+    std::vector<StatementSpan> spans;
+    size_t garbageNodes = 0;
+};
+
+#endif
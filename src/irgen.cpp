@@ -1,46 +1,317 @@
 #include "irgen.h"
-#include <sstream>
-#include <functional>
+#include <cstdlib>
+#include <utility>
 
-static int tempVarCount = 0;
+Operand IRProgram::intConst(int64_t value) {
+    auto res = intIndex.emplace(value, (uint32_t)intPool.size());
+    if (res.second) intPool.push_back(value);
+    return Operand::make(OPD_INT, res.first->second);
+}
 
-std::string newTemp() {
-    std::ostringstream oss;
-    oss << "t" << tempVarCount++;
-    return oss.str();
+void IRProgram::compact(const std::vector<char>& removed) {
+    size_t kept = 0;
+    for (size_t i = 0; i < size(); ++i) {
+        if (removed[i]) continue;
+        ops[kept] = ops[i];
+        arg1[kept] = arg1[i];
+        arg2[kept] = arg2[i];
+        result[kept] = result[i];
+        ++kept;
+    }
+    ops.resize(kept);
+    arg1.resize(kept);
+    arg2.resize(kept);
+    result.resize(kept);
 }
 
-std::vector<Quadruple> generateIR(const ASTPtr& root) {
-    std::vector<Quadruple> ir;
+void IRProgram::splice(const std::vector<char>& removed, const std::vector<std::vector<Quadruple>>& before) {
+    IRProgram out;
+    for (size_t i = 0; i <= size(); ++i) {
+        for (const Quadruple& q : before[i]) out.push(q);
+        if (i < size() && !removed[i]) out.push(at(i));
+    }
+    ops.swap(out.ops);
+    arg1.swap(out.arg1);
+    arg2.swap(out.arg2);
+    result.swap(out.result);
+}
 
-    std::function<std::string(const ASTPtr&)> gen = [&](const ASTPtr& node) -> std::string {
-        if (!node) return "";
-        if (node->type == "Int" || node->type == "Var" || node->type == "Str") return node->value;
-        if (node->type == "Add" || node->type == "Sub" || node->type == "Mul" || node->type == "Lt" || node->type == "Eq") {
-            std::string t1 = gen(node->children[0]);
-            std::string t2 = gen(node->children[1]);
-            std::string res = newTemp();
-            ir.push_back({node->type, t1, t2, res});
-            return res;
-        }
-        if (node->type == "Assign") {
-            std::string rhs = gen(node->children[0]);
-            ir.push_back({"=", rhs, "", node->value});
-            return node->value;
+const char* opName(OpCode op) {
+    switch (op) {
+        case OP_ASSIGN: return "=";
+        case OP_ADD: return "Add";
+        case OP_SUB: return "Sub";
+        case OP_MUL: return "Mul";
+        case OP_LT: return "Lt";
+        case OP_EQ: return "Eq";
+        case OP_SHL: return "Shl";
+        case OP_LABEL: return "label";
+        case OP_JMP: return "jmp";
+        case OP_JLT: return "jlt";
+        case OP_JEQ: return "jeq";
+        case OP_JNE: return "jne";
+    }
+    return "";
+}
+
+std::string operandText(const IRProgram& ir, Operand o) {
+    switch (o.kind()) {
+        case OPD_VAR: return ir.context->slotName(o.index());
+        case OPD_TEMP: return "t" + std::to_string(o.index());
+        case OPD_INT: return std::to_string(ir.intPool[o.index()]);
+        case OPD_STR: return ir.context->constantTable[o.index()];
+        case OPD_LABEL: return "L" + std::to_string(o.index());
+        default: return "";
+    }
+}
+
+void writeIR(const IRProgram& ir, std::ostream& out) {
+    for (size_t i = 0; i < ir.size(); ++i) {
+        out << opName(ir.ops[i]) << " " << operandText(ir, ir.arg1[i]) << " "
+            << operandText(ir, ir.arg2[i]) << " " << operandText(ir, ir.result[i]) << "\n";
+    }
+}
+
+std::vector<int> sourceVariables(const IRProgram& ir) {
+    const CompilationContext& ctx = *ir.context;
+    std::vector<char> appears(ctx.slotCount(), 0);
+    for (size_t i = 0; i < ir.size(); ++i) {
+        for (Operand o : {ir.arg1[i], ir.arg2[i], ir.result[i]}) {
+            if (o.kind() == OPD_VAR) appears[o.index()] = 1;
         }
-        if (node->type == "VarDecl") {
-            // 可选：生成声明四元式
-            // ir.push_back({"decl", node->varType, "_", node->value});
-            if (!node->children.empty()) {
-                std::string rhs = gen(node->children[0]);
-                ir.push_back({"=", rhs, "", node->value});
+    }
+    std::vector<int> vars;
+    for (size_t id = 0; id < appears.size(); ++id) {
+        if (appears[id] && !ctx.isSynthetic(id)) vars.push_back(id);
+    }
+    return vars;
+}
+
+std::vector<char> stringVariables(const IRProgram& ir, std::vector<char>* stringTemps) {
+    std::vector<char> isString[2] = {std::vector<char>(ir.context->slotCount(), 0), std::vector<char>(ir.tempCount, 0)};
+    auto flag = [&](Operand o) -> char* {
+        if (o.kind() == OPD_VAR) return &isString[0][o.index()];
+        if (o.kind() == OPD_TEMP) return &isString[1][o.index()];
+        return nullptr;
+    };
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < ir.size(); ++i) {
+            if (ir.ops[i] != OP_ASSIGN) continue;
+            char* dst = flag(ir.result[i]);
+            char* src = flag(ir.arg1[i]);
+            if (dst && !*dst && (ir.arg1[i].kind() == OPD_STR || (src && *src))) {
+                *dst = 1;
+                changed = true;
             }
-            return "";
         }
-        for (const auto& child : node->children) gen(child);
-        return "";
+    }
+    if (stringTemps) *stringTemps = std::move(isString[1]);
+    return isString[0];
+}
+
+/* 中间代码生成器：按节点种类 switch 分派，用显式栈代替递归
+ * 每个未完成的节点占一个栈帧，stage 记录已处理到第几个子节点；表达式的结果压入 values，由父节点取出
+ * 生成的四元式与按子节点顺序递归生成的结果相同
+ */
+class IRGenerator {
+public:
+    IRGenerator(CompilationContext& ctx, const AST& ast) : ctx(ctx), ast(ast) { ir.context = &ctx; }
+
+    // 生成 root 为根的语句的四元式
+    void gen(NodeId root);
+
+    IRProgram ir;
+
+private:
+    struct Frame {
+        NodeId id;
+        uint32_t stage; // Block/Program：下一个子节点的下标
+        bool branch; // 条件跳转：条件成立时跳转到 label0
+        Operand label0; // If：then 标号；While：循环体标号
+        Operand label1; // If：结束标号；While：条件标号
     };
 
-    gen(root);
-    return ir;
-}
\ No newline at end of file
+    Operand leaf(const ASTNode& node);
+    // 表达式的结果压入 values：叶子直接求值，其余压入栈帧
+    void pushExpr(NodeId id);
+    void pushStmt(NodeId id) {
+        if (id != NO_NODE) frames.push_back({id, 0, false, Operand(), Operand()});
+    }
+    // 条件成立时跳转到target：比较运算直接生成 jlt/jeq，不再先算出临时变量
+    void pushBranch(NodeId cond, Operand target) { frames.push_back({cond, 0, true, target, Operand()}); }
+    Operand popValue() {
+        Operand o = values.back();
+        values.pop_back();
+        return o;
+    }
+    void step(Frame& frame);
+    void stepBranch(Frame& frame);
+    void placeLabel(Operand label) { ir.push({OP_LABEL, Operand(), Operand(), label}); }
+    Operand newTemp() { return Operand::make(OPD_TEMP, ir.tempCount++); }
+    Operand newLabel() { return Operand::make(OPD_LABEL, ir.labelCount++); }
+
+    CompilationContext& ctx;
+    const AST& ast;
+    std::vector<Operand> constOperand; // constantTable id -> 整数操作数缓存，OPD_NONE 表示尚未解析
+    std::vector<Frame> frames;
+    std::vector<Operand> values;
+};
+
+// 变量的槽位：语义分析已把名字解析到声明时使用其槽位，否则（未声明或未经语义分析）使用名字本身的id
+static Operand varOperand(const ASTNode& node) {
+    return Operand::make(OPD_VAR, node.slot != NO_SLOT ? node.slot : (uint32_t)node.value);
+}
+
+Operand IRGenerator::leaf(const ASTNode& node) {
+    switch (node.kind) {
+        case NK_INT: {
+            // 十进制文本只解析一次，之后复用常量池下标
+            if (constOperand.size() <= (size_t)node.value) constOperand.resize(ctx.constantTable.size());
+            Operand& o = constOperand[node.value];
+            if (o.kind() == OPD_NONE) o = ir.intConst(std::strtoll(ctx.constantTable[node.value].c_str(), nullptr, 10));
+            return o;
+        }
+        case NK_VAR:
+            return varOperand(node);
+        case NK_STR:
+            return Operand::make(OPD_STR, node.value);
+        default:
+            return Operand();
+    }
+}
+
+void IRGenerator::pushExpr(NodeId id) {
+    if (id == NO_NODE) values.push_back(Operand());
+    else if (ast[id].childCount == 0) values.push_back(leaf(ast[id]));
+    else frames.push_back({id, 0, false, Operand(), Operand()});
+}
+
+void IRGenerator::gen(NodeId root) {
+    pushStmt(root);
+    while (!frames.empty()) {
+        Frame& frame = frames.back();
+        if (frame.branch) stepBranch(frame);
+        else step(frame);
+    }
+}
+
+// 推进栈顶帧一步：压入下一个子节点，或者所有子节点都已生成时输出本节点的四元式并出栈
+void IRGenerator::step(Frame& frame) {
+    const ASTNode& node = ast[frame.id];
+    uint32_t stage = frame.stage++;
+    switch (node.kind) {
+        case NK_ADD:
+        case NK_SUB:
+        case NK_MUL:
+        case NK_LT:
+        case NK_EQ: {
+            if (stage < 2) return pushExpr(ast.child(node, stage));
+            Operand t2 = popValue();
+            Operand t1 = popValue();
+            Operand res = newTemp();
+            // NodeKind 中 Add..Eq 与 OpCode 中 Add..Eq 顺序一致
+            static_assert(OP_EQ - OP_ADD == NK_EQ - NK_ADD, "OpCode 与 NodeKind 的运算顺序不一致");
+            ir.push({OpCode(OP_ADD + (node.kind - NK_ADD)), t1, t2, res});
+            values.push_back(res);
+            break;
+        }
+        case NK_ASSIGN:
+        case NK_VAR_DECL:
+            if (node.childCount == 0) break; // 没有初值的声明
+            if (stage == 0) return pushExpr(ast.child(node, 0));
+            ir.push({OP_ASSIGN, popValue(), Operand(), varOperand(node)});
+            break;
+        case NK_IF:
+            // jcc cond Lthen; else; jmp Lend; Lthen: then; Lend:
+            if (stage == 0) {
+                frame.label0 = newLabel();
+                frame.label1 = newLabel();
+                return pushBranch(ast.child(node, 0), frame.label0);
+            }
+            if (stage == 1) return pushStmt(ast.child(node, 2));
+            if (stage == 2) {
+                ir.push({OP_JMP, Operand(), Operand(), frame.label1});
+                placeLabel(frame.label0);
+                return pushStmt(ast.child(node, 1));
+            }
+            placeLabel(frame.label1);
+            break;
+        case NK_WHILE:
+            // 条件判断放在循环体之后，每次迭代只执行一条跳转：jmp Lcond; Lbody: body; Lcond: jcc cond Lbody
+            if (stage == 0) {
+                frame.label0 = newLabel();
+                frame.label1 = newLabel();
+                ir.push({OP_JMP, Operand(), Operand(), frame.label1});
+                placeLabel(frame.label0);
+                return pushStmt(ast.child(node, 1));
+            }
+            if (stage == 1) {
+                placeLabel(frame.label1);
+                return pushBranch(ast.child(node, 0), frame.label0);
+            }
+            break;
+        case NK_PROGRAM:
+        case NK_BLOCK:
+            if (stage < node.childCount) return pushStmt(ast.child(node, stage));
+            break;
+        default:
+            break;
+    }
+    frames.pop_back();
+}
+
+void IRGenerator::stepBranch(Frame& frame) {
+    const ASTNode& node = ast[frame.id];
+    uint32_t stage = frame.stage++;
+    if (node.kind == NK_LT || node.kind == NK_EQ) {
+        if (stage < 2) return pushExpr(ast.child(node, stage));
+        Operand b = popValue();
+        Operand a = popValue();
+        ir.push({node.kind == NK_LT ? OP_JLT : OP_JEQ, a, b, frame.label0});
+    } else {
+        // 非比较表达式按非0为真
+        if (stage == 0) return pushExpr(frame.id);
+        ir.push({OP_JNE, popValue(), ir.intConst(0), frame.label0});
+    }
+    frames.pop_back();
+}
+
+IRProgram generateIR(CompilationContext& ctx, const AST& ast) {
+    IRGenerator generator(ctx, ast);
+    generator.gen(ast.root);
+    return std::move(generator.ir);
+}
+
+bool checkOperandLimits(const IRProgram& ir, std::string& error) {
+    const CompilationContext& ctx = *ir.context;
+    const uint64_t limit = (uint64_t)Operand::INDEX_MASK + 1;
+    struct Count {
+        const char* what;
+        uint64_t count, bound;
+    };
+    const Count counts[] = {
+        {"临时变量", (uint64_t)ir.tempCount, limit},
+        {"标号", (uint64_t)ir.labelCount, limit},
+        {"变量槽位", ctx.slotCount(), limit},
+        // 流式编译的额外槽位预先从 STREAM_EXTRA_SLOTS 起编号，标识符id不能与之重叠
+        {"标识符", ctx.identifierTable.size(), ctx.firstExtraSlot == NO_SLOT ? limit : ctx.firstExtraSlot},
+        {"常量", ctx.constantTable.size(), limit},
+        {"整数立即数", ir.intPool.size(), limit},
+    };
+    for (const Count& c : counts) {
+        if (c.count > c.bound) {
+            error = std::string("[编译错误] ") + c.what + "个数超出四元式操作数的编号上限 " + std::to_string(c.bound);
+            return false;
+        }
+    }
+    return true;
+}
+
+void generateIR(CompilationContext& ctx, const AST& ast, NodeId stmt, IRProgram& ir) {
+    IRGenerator generator(ctx, ast);
+    generator.ir = std::move(ir);
+    generator.gen(stmt);
+    ir = std::move(generator.ir);
+}
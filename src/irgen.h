@@ -1,17 +1,131 @@
 #ifndef IRGEN_H
 #define IRGEN_H
 
-#include "parser.h"
+#include "context.h"
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
 #include <vector>
 #include <string>
 
+// 四元式操作码
+enum OpCode : uint8_t {
+    OP_ASSIGN, // = arg1 _ result
+    OP_ADD,    // Add arg1 arg2 result
+    OP_SUB,    // Sub arg1 arg2 result
+    OP_MUL,    // Mul arg1 arg2 result
+    OP_LT,     // Lt arg1 arg2 result
+    OP_EQ,     // Eq arg1 arg2 result
+    OP_SHL,    // Shl arg1 arg2 result：arg1 左移 arg2 位，只由优化器产生
+    OP_LABEL,  // label _ _ Ln：标号定义
+    OP_JMP,    // jmp _ _ Ln：无条件跳转
+    OP_JLT,    // jlt arg1 arg2 Ln：arg1 < arg2 时跳转
+    OP_JEQ,    // jeq arg1 arg2 Ln：arg1 == arg2 时跳转
+    OP_JNE     // jne arg1 arg2 Ln：arg1 != arg2 时跳转（条件不是比较运算时使用）
+};
+
+// 是否为二元运算（结果写入 result）
+inline bool isBinary(OpCode op) { return op >= OP_ADD && op <= OP_SHL; }
+// 是否为跳转指令
+inline bool isJump(OpCode op) { return op >= OP_JMP && op <= OP_JNE; }
+// 是否为条件跳转指令
+inline bool isCondJump(OpCode op) { return op >= OP_JLT && op <= OP_JNE; }
+
+// 操作数种类
+enum OperandKind : uint8_t {
+    OPD_NONE, // 空操作数
+    OPD_VAR,  // 变量，下标为其槽位（ASTNode::slot）：标识符本身的槽位为其id，另有额外槽位（见 CompilationContext）
+    OPD_TEMP, // 临时变量，下标为临时变量编号
+    OPD_INT,  // 整数立即数，下标指向 IRProgram::intPool
+    OPD_STR,  // 字符串常量，下标为 constantTable 中的id
+    OPD_LABEL // 标号，下标为标号编号
+};
+
+// 带标签的32位操作数：高3位为种类，低29位为下标；make 只保留下标的低29位，编号是否越界由 checkOperandLimits 检查
+struct Operand {
+    uint32_t bits = 0;
+
+    static const int KIND_SHIFT = 29;
+    static const uint32_t INDEX_MASK = (1u << KIND_SHIFT) - 1;
+
+    static Operand make(OperandKind kind, uint32_t index) {
+        Operand o;
+        o.bits = ((uint32_t)kind << KIND_SHIFT) | (index & INDEX_MASK);
+        return o;
+    }
+    OperandKind kind() const { return (OperandKind)(bits >> KIND_SHIFT); }
+    uint32_t index() const { return bits & INDEX_MASK; }
+    bool operator==(Operand other) const { return bits == other.bits; }
+    bool operator!=(Operand other) const { return bits != other.bits; }
+};
+
+// 单条四元式的值视图，IRProgram 内部按列分开存储
 struct Quadruple {
-    std::string op;
-    std::string arg1;
-    std::string arg2;
-    std::string result;
+    OpCode op;
+    Operand arg1;
+    Operand arg2;
+    Operand result;
+};
+
+// 四元式序列（结构数组形式），整数常量解析为 int64 存入常量池
+struct IRProgram {
+    std::vector<OpCode> ops;
+    std::vector<Operand> arg1;
+    std::vector<Operand> arg2;
+    std::vector<Operand> result;
+    std::vector<int64_t> intPool; // OPD_INT 操作数的取值，去重
+    int tempCount = 0; // 临时变量编号上界（不含）
+    int labelCount = 0; // 标号编号上界（不含）
+    CompilationContext* context = nullptr; // 变量槽位与字符串常量所在的符号表，优化遍也在其中分配新变量的槽位
+
+    size_t size() const { return ops.size(); }
+    Quadruple at(size_t i) const { return {ops[i], arg1[i], arg2[i], result[i]}; }
+    void push(const Quadruple& q) {
+        ops.push_back(q.op);
+        arg1.push_back(q.arg1);
+        arg2.push_back(q.arg2);
+        result.push_back(q.result);
+    }
+    // 清空四元式，保留常量池与临时变量/标号编号，流式生成时每条语句的四元式写出后调用
+    void clearCode() {
+        ops.clear();
+        arg1.clear();
+        arg2.clear();
+        result.clear();
+    }
+    // 取得整数立即数操作数，相同取值共用一个池下标
+    Operand intConst(int64_t value);
+    // 删除 removed[i] 非0的四元式，其余保持原顺序
+    void compact(const std::vector<char>& removed);
+    // 删除 removed[i] 非0的四元式，并在原下标 i 之前插入 before[i]（before 长度为 size()+1，末项插在最后）
+    void splice(const std::vector<char>& removed, const std::vector<std::vector<Quadruple>>& before);
+
+private:
+    std::unordered_map<int64_t, uint32_t> intIndex;
 };
 
-std::vector<Quadruple> generateIR(const ASTPtr& root);
+// 操作码名（如 "=", "Add"）
+const char* opName(OpCode op);
+
+// 操作数文本（变量名、tN、Ln、整数或字符串内容），空操作数为空串
+std::string operandText(const IRProgram& ir, Operand o);
+
+// 按 "op arg1 arg2 result" 每行一条输出
+void writeIR(const IRProgram& ir, std::ostream& out);
+
+// 在四元式中出现过的源程序变量（按槽位升序，不含优化器引入的变量），即执行结束时要输出终值的变量
+std::vector<int> sourceVariables(const IRProgram& ir);
+
+// 保存字符串的变量（按槽位索引）：字符串只经复写传递，复写的源是字符串常量或字符串变量/临时变量时目标也保存字符串
+// stringTemps 非空时另外给出保存字符串的临时变量（按编号索引）
+std::vector<char> stringVariables(const IRProgram& ir, std::vector<char>* stringTemps = nullptr);
+
+IRProgram generateIR(CompilationContext& ctx, const AST& ast);
+
+// 临时变量、标号、变量槽位与常量的编号都能放进操作数的29位下标，且标识符没有进入额外槽位的编号范围时返回true，否则设置error
+bool checkOperandLimits(const IRProgram& ir, std::string& error);
+
+// 把语句 stmt 的四元式追加到 ir，临时变量与标号接着 ir 已有的编号分配
+void generateIR(CompilationContext& ctx, const AST& ast, NodeId stmt, IRProgram& ir);
 
-#endif
\ No newline at end of file
+#endif
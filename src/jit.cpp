@@ -0,0 +1,321 @@
+#include "jit.h"
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <sys/mman.h>
+
+/** 循环编译流程：
+ * 1.区间 [begin, end] 内逐条生成机器码：rdi 指向寄存器数组，rax/rcx 为临时寄存器，
+ *   变量与临时变量按 [rdi + 8*slot] 访问，常量作为立即数
+ * 2.跳到区间内的标号直接回填相对偏移；跳到区间外或执行到区间末尾时经出口返回下一条四元式的下标
+ * 3.mmap 可写内存写入机器码后改为只读可执行（W^X）
+ */
+
+using LoopFunction = uint32_t (*)(int64_t* registers);
+
+// 已编译循环的可执行内存
+class ExecutableCode {
+public:
+    explicit ExecutableCode(const std::vector<uint8_t>& bytes) : size(bytes.size()) {
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return;
+        std::memcpy(p, bytes.data(), size);
+        if (mprotect(p, size, PROT_READ | PROT_EXEC) != 0) {
+            munmap(p, size);
+            return;
+        }
+        memory = p;
+    }
+    ~ExecutableCode() {
+        if (memory) munmap(memory, size);
+    }
+    ExecutableCode(const ExecutableCode&) = delete;
+    ExecutableCode& operator=(const ExecutableCode&) = delete;
+
+    LoopFunction entry() const { return (LoopFunction)memory; }
+
+private:
+    void* memory = nullptr;
+    size_t size;
+};
+
+class LoopCompiler {
+public:
+    LoopCompiler(const IRProgram& ir, const std::vector<size_t>& labelAt) : ir(ir), labelAt(labelAt) {}
+
+    // 生成区间 [begin, end] 的机器码，寄存器下标超出 32 位位移范围时失败
+    bool compile(size_t begin, size_t end, std::vector<uint8_t>& out);
+
+private:
+    void byte(uint8_t b) { code.push_back(b); }
+    void bytes(std::initializer_list<uint8_t> bs) { code.insert(code.end(), bs); }
+    void imm32(int64_t value);
+    bool isMemory(Operand o) const { return o.kind() == OPD_VAR || o.kind() == OPD_TEMP; }
+    int64_t slotOf(Operand o) const;
+    int64_t constantOf(Operand o) const;
+    void displacement(Operand o);
+    void loadRax(Operand o);
+    void storeRax(Operand o);
+    void alu(uint8_t opcode, Operand b);
+    void jump(std::initializer_list<uint8_t> opcode, Operand label);
+
+    const IRProgram& ir;
+    const std::vector<size_t>& labelAt;
+    std::vector<uint8_t> code;
+    size_t begin = 0, end = 0;
+    bool slotOverflow = false;
+    std::map<uint32_t, size_t> labelOffset; // 区间内标号 -> 机器码偏移
+    std::vector<std::pair<size_t, uint32_t>> labelFixups; // (rel32 位置, 标号)
+    std::map<size_t, std::vector<size_t>> exitFixups; // 出口的四元式下标 -> rel32 位置
+};
+
+void LoopCompiler::imm32(int64_t value) {
+    uint32_t v = (uint32_t)value;
+    for (int i = 0; i < 4; ++i) byte(v >> (8 * i));
+}
+
+int64_t LoopCompiler::slotOf(Operand o) const {
+    return o.kind() == OPD_VAR ? o.index() : (int64_t)ir.context->slotCount() + o.index();
+}
+
+int64_t LoopCompiler::constantOf(Operand o) const {
+    if (o.kind() == OPD_INT) return ir.intPool[o.index()];
+    if (o.kind() == OPD_STR) return o.index() + 1;
+    return 0;
+}
+
+static bool fitsImm32(int64_t value) { return value >= INT32_MIN && value <= INT32_MAX; }
+
+// [rdi + disp32] 中的 disp32
+void LoopCompiler::displacement(Operand o) {
+    int64_t disp = 8 * slotOf(o);
+    slotOverflow = slotOverflow || !fitsImm32(disp);
+    imm32(disp);
+}
+
+void LoopCompiler::loadRax(Operand o) {
+    if (isMemory(o)) {
+        bytes({0x48, 0x8B, 0x87}); // mov rax, [rdi + disp32]
+        displacement(o);
+        return;
+    }
+    int64_t value = constantOf(o);
+    if (fitsImm32(value)) {
+        bytes({0x48, 0xC7, 0xC0}); // mov rax, imm32（符号扩展）
+        imm32(value);
+    } else {
+        bytes({0x48, 0xB8}); // movabs rax, imm64
+        imm32(value);
+        imm32(value >> 32);
+    }
+}
+
+void LoopCompiler::storeRax(Operand o) {
+    bytes({0x48, 0x89, 0x87}); // mov [rdi + disp32], rax
+    displacement(o);
+}
+
+// rax = rax op b，opcode 为 "op r64, r/m64" 形式（add 03、sub 2B、cmp 3B、imul 0F AF 取 AF）
+void LoopCompiler::alu(uint8_t opcode, Operand b) {
+    auto prefix = [&] {
+        byte(0x48);
+        if (opcode == 0xAF) byte(0x0F);
+        byte(opcode);
+    };
+    if (isMemory(b)) {
+        prefix();
+        byte(0x87); // r/m 为 [rdi + disp32]
+        displacement(b);
+        return;
+    }
+    int64_t value = constantOf(b);
+    if (fitsImm32(value)) {
+        // 立即数形式：add rax,imm32 / sub rax,imm32 / cmp rax,imm32 / imul rax,rax,imm32
+        if (opcode == 0x03) bytes({0x48, 0x05});
+        else if (opcode == 0x2B) bytes({0x48, 0x2D});
+        else if (opcode == 0x3B) bytes({0x48, 0x3D});
+        else bytes({0x48, 0x69, 0xC0});
+        imm32(value);
+        return;
+    }
+    bytes({0x48, 0xB9}); // movabs rcx, imm64
+    imm32(value);
+    imm32(value >> 32);
+    prefix();
+    byte(0xC1); // r/m 为 rcx
+}
+
+void LoopCompiler::jump(std::initializer_list<uint8_t> opcode, Operand label) {
+    bytes(opcode);
+    size_t at = code.size();
+    imm32(0);
+    size_t target = labelAt[label.index()];
+    if (target >= begin && target <= end) labelFixups.push_back({at, label.index()});
+    else exitFixups[target].push_back(at);
+}
+
+bool LoopCompiler::compile(size_t regionBegin, size_t regionEnd, std::vector<uint8_t>& out) {
+    begin = regionBegin;
+    end = regionEnd;
+    code.clear();
+    slotOverflow = false;
+    labelOffset.clear();
+    labelFixups.clear();
+    exitFixups.clear();
+    for (size_t q = begin; q <= end; ++q) {
+        OpCode op = ir.ops[q];
+        switch (op) {
+            case OP_ASSIGN:
+                loadRax(ir.arg1[q]);
+                storeRax(ir.result[q]);
+                break;
+            case OP_ADD:
+            case OP_SUB:
+            case OP_MUL:
+                loadRax(ir.arg1[q]);
+                alu(op == OP_ADD ? 0x03 : op == OP_SUB ? 0x2B : 0xAF, ir.arg2[q]);
+                storeRax(ir.result[q]);
+                break;
+            case OP_SHL:
+                loadRax(ir.arg1[q]);
+                if (isMemory(ir.arg2[q])) {
+                    bytes({0x48, 0x8B, 0x8F}); // mov rcx, [rdi + disp32]
+                    displacement(ir.arg2[q]);
+                    bytes({0x48, 0xD3, 0xE0}); // shl rax, cl
+                } else {
+                    bytes({0x48, 0xC1, 0xE0}); // shl rax, imm8
+                    byte(constantOf(ir.arg2[q]) & 63);
+                }
+                storeRax(ir.result[q]);
+                break;
+            case OP_LT:
+            case OP_EQ:
+                loadRax(ir.arg1[q]);
+                alu(0x3B, ir.arg2[q]);
+                bytes({0x0F, (uint8_t)(op == OP_LT ? 0x9C : 0x94), 0xC0}); // setl/sete al
+                bytes({0x0F, 0xB6, 0xC0}); // movzx eax, al
+                storeRax(ir.result[q]);
+                break;
+            case OP_LABEL:
+                labelOffset[ir.result[q].index()] = code.size();
+                break;
+            case OP_JMP:
+                jump({0xE9}, ir.result[q]);
+                break;
+            case OP_JLT:
+            case OP_JEQ:
+            case OP_JNE:
+                loadRax(ir.arg1[q]);
+                alu(0x3B, ir.arg2[q]);
+                jump({0x0F, (uint8_t)(op == OP_JLT ? 0x8C : op == OP_JEQ ? 0x84 : 0x85)}, ir.result[q]);
+                break;
+        }
+    }
+    if (slotOverflow) return false;
+    // 顺序执行到区间末尾，接着是各跳出区间的出口：mov eax, 下一条四元式; ret
+    auto emitExit = [&](size_t next) {
+        byte(0xB8);
+        imm32(next);
+        byte(0xC3);
+    };
+    emitExit(end + 1);
+    auto patch = [&](size_t at, size_t target) {
+        int32_t rel = (int32_t)(target - (at + 4));
+        std::memcpy(&code[at], &rel, 4);
+    };
+    for (const auto& kv : exitFixups) {
+        for (size_t at : kv.second) patch(at, code.size());
+        emitExit(kv.first);
+    }
+    for (const auto& fix : labelFixups) patch(fix.first, labelOffset[fix.second]);
+    out.swap(code);
+    return true;
+}
+
+std::vector<int64_t> runTiered(const IRProgram& ir, int threshold, JitStats& stats) {
+    auto start = std::chrono::steady_clock::now();
+    size_t n = ir.size();
+    size_t varSlots = ir.context->slotCount();
+    std::vector<int64_t> registers(varSlots + ir.tempCount, 0);
+    std::vector<size_t> labelAt(ir.labelCount, n);
+    for (size_t q = 0; q < n; ++q) {
+        if (ir.ops[q] == OP_LABEL) labelAt[ir.result[q].index()] = q;
+    }
+    auto value = [&](Operand o) -> int64_t {
+        switch (o.kind()) {
+            case OPD_VAR: return registers[o.index()];
+            case OPD_TEMP: return registers[varSlots + o.index()];
+            case OPD_INT: return ir.intPool[o.index()];
+            case OPD_STR: return o.index() + 1;
+            default: return 0;
+        }
+    };
+    auto slot = [&](Operand o) -> int64_t& {
+        return registers[o.kind() == OPD_VAR ? o.index() : varSlots + o.index()];
+    };
+
+    // 按回边目标标号统计执行次数；编译失败的循环记为已尝试，不再重试
+    std::vector<int> backEdges(ir.labelCount, 0);
+    std::vector<std::unique_ptr<ExecutableCode>> loops(ir.labelCount);
+    std::vector<char> attempted(ir.labelCount, 0);
+    LoopCompiler compiler(ir, labelAt);
+    double compileMs = 0;
+    for (size_t q = 0; q < n;) {
+        OpCode op = ir.ops[q];
+        bool taken = false;
+        switch (op) {
+            case OP_ASSIGN: slot(ir.result[q]) = value(ir.arg1[q]); break;
+            case OP_ADD: slot(ir.result[q]) = (uint64_t)value(ir.arg1[q]) + (uint64_t)value(ir.arg2[q]); break;
+            case OP_SUB: slot(ir.result[q]) = (uint64_t)value(ir.arg1[q]) - (uint64_t)value(ir.arg2[q]); break;
+            case OP_MUL: slot(ir.result[q]) = (uint64_t)value(ir.arg1[q]) * (uint64_t)value(ir.arg2[q]); break;
+            case OP_SHL: slot(ir.result[q]) = (uint64_t)value(ir.arg1[q]) << (value(ir.arg2[q]) & 63); break;
+            case OP_LT: slot(ir.result[q]) = value(ir.arg1[q]) < value(ir.arg2[q]); break;
+            case OP_EQ: slot(ir.result[q]) = value(ir.arg1[q]) == value(ir.arg2[q]); break;
+            case OP_LABEL: break;
+            case OP_JMP: taken = true; break;
+            case OP_JLT: taken = value(ir.arg1[q]) < value(ir.arg2[q]); break;
+            case OP_JEQ: taken = value(ir.arg1[q]) == value(ir.arg2[q]); break;
+            case OP_JNE: taken = value(ir.arg1[q]) != value(ir.arg2[q]); break;
+        }
+        if (!taken) {
+            ++q;
+            continue;
+        }
+        uint32_t label = ir.result[q].index();
+        size_t target = labelAt[label];
+        if (target <= q) {
+            if (!loops[label] && !attempted[label] && ++backEdges[label] >= threshold) {
+                attempted[label] = 1;
+                auto compileStart = std::chrono::steady_clock::now();
+                std::vector<uint8_t> code;
+                if (compiler.compile(target, q, code)) {
+                    loops[label].reset(new ExecutableCode(code));
+                    if (loops[label]->entry()) {
+                        ++stats.compiledLoops;
+                        stats.codeBytes += code.size();
+                    } else {
+                        loops[label].reset();
+                    }
+                }
+                compileMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart)
+                                 .count();
+            }
+            if (loops[label]) {
+                q = loops[label]->entry()(registers.data());
+                continue;
+            }
+        }
+        q = target;
+    }
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats.compileMs = compileMs;
+    stats.executeMs = totalMs - compileMs;
+    return registers;
+}
+
+void writeJitStats(const JitStats& stats, std::ostream& out) {
+    out << "JIT: 编译 " << stats.compiledLoops << " 个循环（" << stats.codeBytes << " 字节机器码），编译耗时 "
+        << stats.compileMs << " ms，执行耗时 " << stats.executeMs << " ms\n";
+}
@@ -0,0 +1,27 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "irgen.h"
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/** 分层执行与即时编译（x86-64，System V）：
+ * 第0层逐条解释四元式并统计每个循环回边的执行次数，达到阈值后把该 While 循环（从回边目标标号到回边）
+ * 直接生成机器码写入 mmap 的可执行内存，此后执行到该回边时调用机器码，循环退出后回到解释器
+ * 寄存器布局与字节码虚拟机相同：变量为其槽位，临时变量 tk 为 varSlots + k，字符串为 id+1
+ */
+
+struct JitStats {
+    int compiledLoops = 0;
+    size_t codeBytes = 0;
+    double compileMs = 0; // 生成机器码（含 mmap/mprotect）的总耗时
+    double executeMs = 0; // 解释与执行机器码的耗时，不含编译
+};
+
+// 回边执行次数达到 threshold 时编译该循环，返回执行结束时的寄存器
+std::vector<int64_t> runTiered(const IRProgram& ir, int threshold, JitStats& stats);
+
+void writeJitStats(const JitStats& stats, std::ostream& out);
+
+#endif
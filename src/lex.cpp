@@ -1,225 +1,512 @@
 #include "lex.h"
+#include "context.h"
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
-#include <cctype>
-#include <algorithm>
+#include <iterator>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 /** 核心流程：
- * 1.读取每一行源码
- * 2.按字符分类识别
- *  ·是字母开头 → 尝试识别关键字或标识符
- *  ·是数字开头 → 尝试识别整数
- *  ·是 +, -, *, <, = → 运算符
- *  ·是 {, }, ( 等 → 分隔符
- *  ·是 $ → 文件结束符
+ * 1.读取每一行源码（逐行 getline、内存映射或内存中的源码）
+ * 2.表驱动DFA识别单词：当前字符查字符类表，再查状态转移表得到下一状态，无法继续时停下
+ *  ·停在标识符状态 → 查关键字完美哈希表，未命中为标识符
+ *  ·停在数字状态 → 整数（前导零为非法数字）
+ *  ·停在运算符、分隔符、$ 状态 → 运算符、分隔符、文件结束符
+ *  ·停在数字后接字母、未闭合字符串、单个 / 等状态 → 词法错误
  * 3.记录并写入对应 token
- *  ·若是标识符，写入 identifierTable
- *  ·若是数字，写入 constantTable
+ *  ·若是标识符，写入 ctx.identifierTable
+ *  ·若是数字或字符串，写入 ctx.constantTable（两类常量按种类分池去重，共用一套编号）
  */
 
-// 错误类型
-enum class LexErrorType {
-    UNKNOWN_CHAR,       // 无法识别的字符
-    INVALID_IDENTIFIER, // 非法标识符
-    INVALID_NUMBER,     // 非法数字格式
-    UNTERMINATED_STRING // 未终止的字符串
+// 每次读入8字节做乘法混合，符号大多不超过16字节，只需一两轮；最高位为所属池，哈希值相同即同池
+uint32_t Interner::hash(std::string_view text, int kind) {
+    const uint64_t m = 0x9e3779b97f4a7c15ull;
+    uint64_t h = (text.size() * 2 + kind) * m;
+    const char* p = text.data();
+    size_t n = text.size();
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        h = (h ^ w) * m;
+        h ^= h >> 32;
+    }
+    if (n > 0) {
+        uint64_t w = 0;
+        std::memcpy(&w, p, n);
+        h = (h ^ w) * m;
+        h ^= h >> 32;
+    }
+    h *= m;
+    return (uint32_t)(h >> 33) | (uint32_t)kind << 31;
+}
+
+size_t Interner::probe(std::string_view text, uint32_t h) const {
+    size_t mask = slots.size() - 1;
+    for (size_t i = h & mask;; i = (i + 1) & mask) {
+        const Slot& slot = slots[i];
+        if (slot.id < 0) return i;
+        if (slot.hash == h && pool[slot.id] == text) return i;
+    }
+}
+
+void Interner::grow() {
+    std::vector<Slot> old = std::move(slots);
+    slots.assign(old.empty() ? 64 : old.size() * 2, Slot{0, -1});
+    size_t mask = slots.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.id < 0) continue;
+        size_t i = slot.hash & mask;
+        while (slots[i].id >= 0) i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+}
+
+int Interner::intern(std::string_view text, int kind) {
+    if ((pool.size() + 1) * 2 > slots.size()) grow();
+    uint32_t h = hash(text, kind);
+    Slot& slot = slots[probe(text, h)];
+    if (slot.id >= 0) return slot.id;
+    slot = {h, (int)pool.size()};
+    pool.emplace_back(text);
+    kinds.push_back(kind);
+    return slot.id;
+}
+
+int Interner::find(std::string_view text, int kind) const {
+    if (slots.empty()) return -1;
+    return slots[probe(text, hash(text, kind))].id;
+}
+
+void Interner::clear() {
+    pool.clear();
+    kinds.clear();
+    slots.clear();
+}
+
+// 添加错误到错误列表
+static void addError(CompilationContext& ctx, LexErrorType type, int line, int column, char c) {
+    static const char* const messages[] = {"无法识别的字符", "非法标识符格式", "非法数字格式", "字符串未正确终止"};
+    ctx.lexErrors.push_back({type, line, column, messages[(int)type], c});
+}
+
+// 打印所有错误
+void printLexErrors(const CompilationContext& ctx) {
+    for (const auto& error : ctx.lexErrors) {
+        *ctx.diagnostics << "[词法错误] 第" << error.line << "行, 第" << error.column << "列: "
+                  << error.message << " '" << error.problematicChar << "'\n";
+    }
+}
+
+/** 表驱动词法分析：
+ * 1.字符类表：256项，编译期生成，只认ASCII（与 C locale 下的 isspace/isalpha/isdigit 结果一致），不调用 <cctype>
+ * 2.状态转移表：NEXT[状态][字符类]，编译期生成；转移到 LS_ACCEPT 表示当前单词结束，停下时的状态决定产生什么
+ * 3.自环状态（空白、标识符、数字、字符串、注释）的连续段用 SIMD/memchr 批量跳过，结果与逐字符查表相同
+ * 4.关键字用编译期构造的完美哈希表识别：按首尾字符与长度取槽位，再比较一次文本，不对单词做字符串哈希
+ */
+
+enum CharClass : uint8_t {
+    CC_OTHER,     // 无法识别的字符（含非ASCII字节）
+    CC_SPACE,     // 空白
+    CC_LETTER,    // 字母与下划线
+    CC_DIGIT,     // 数字
+    CC_QUOTE,     // "
+    CC_OPERATOR,  // + - * < =
+    CC_DELIMITER, // { } ( ) [ ] ; ,
+    CC_END,       // $
+    CC_SLASH,     // /
+    CC_COUNT
 };
 
- // 错误信息结构体
-struct LexError {
-    LexErrorType type;
-    int line;
-    int column;
-    std::string message;
-    char problematicChar;
+struct CharClassTable {
+    uint8_t classes[256];
 };
 
-//  存储所有识别出的标识符
-std::vector<std::string> identifierTable;
+static constexpr CharClassTable makeCharClassTable() {
+    CharClassTable table{};
+    for (int c = 0; c < 256; ++c) {
+        if (c == ' ' || (c >= '\t' && c <= '\r')) table.classes[c] = CC_SPACE;
+        else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') table.classes[c] = CC_LETTER;
+        else if (c >= '0' && c <= '9') table.classes[c] = CC_DIGIT;
+    }
+    for (const char* p = "+-*<="; *p; ++p) table.classes[(unsigned char)*p] = CC_OPERATOR;
+    for (const char* p = "{}()[];,"; *p; ++p) table.classes[(unsigned char)*p] = CC_DELIMITER;
+    table.classes['"'] = CC_QUOTE;
+    table.classes['$'] = CC_END;
+    table.classes['/'] = CC_SLASH;
+    return table;
+}
+
+static constexpr CharClassTable CHAR_CLASSES = makeCharClassTable();
 
-// 存储所有识别出的数字常量和字符串常量
-std::vector<std::string> constantTable;
+static inline CharClass classOf(char c) { return (CharClass)CHAR_CLASSES.classes[(unsigned char)c]; }
 
-// 存储词法分析过程中的错误
-std::vector<LexError> errorList;
+enum LexState : uint8_t {
+    LS_START,
+    LS_SPACE,       // 空白，不产生token
+    LS_IDENT,       // 关键字或标识符
+    LS_NUMBER,      // 整数
+    LS_BAD_NUMBER,  // 数字后紧跟字母或下划线：非法标识符
+    LS_STRING,      // 字符串尚未闭合
+    LS_STRING_DONE, // 字符串已闭合
+    LS_SLASH,       // 单个 /：无法识别的字符
+    LS_COMMENT,     // 行注释，吃掉行尾
+    LS_OPERATOR,
+    LS_DELIMITER,
+    LS_EOF,         // $
+    LS_UNKNOWN,     // 无法识别的字符
+    LS_ACCEPT,      // 单词结束，不消耗当前字符
+    LS_COUNT
+};
 
-std::unordered_map<std::string, int> keywordMap = {
-    {"class", KW_CLASS}, {"public", KW_PUBLIC}, {"static", KW_STATIC}, {"void", KW_VOID},
-    {"main", KW_MAIN}, {"if", KW_IF}, {"else", KW_ELSE}, {"while", KW_WHILE},
-    {"return", KW_RETURN}, {"true", KW_TRUE}, {"false", KW_FALSE}, {"String", KW_STRING},{"int", KW_INT}
+struct TransitionTable {
+    uint8_t next[LS_COUNT][CC_COUNT];
 };
 
-// 判断字符是否是分隔符
-bool isDelimiter(char c) {
-    return c == '{' || c == '}' || c == '(' || c == ')' ||
-           c == '[' || c == ']' || c == ';' || c == ',';
+static constexpr TransitionTable makeTransitionTable() {
+    TransitionTable table{};
+    for (int s = 0; s < LS_COUNT; ++s) {
+        for (int c = 0; c < CC_COUNT; ++c) table.next[s][c] = LS_ACCEPT;
+    }
+    const LexState starts[CC_COUNT] = {LS_UNKNOWN,  LS_SPACE,  LS_IDENT, LS_NUMBER, LS_STRING,
+                                       LS_OPERATOR, LS_DELIMITER, LS_EOF, LS_SLASH};
+    for (int c = 0; c < CC_COUNT; ++c) table.next[LS_START][c] = starts[c];
+    table.next[LS_SPACE][CC_SPACE] = LS_SPACE;
+    table.next[LS_IDENT][CC_LETTER] = LS_IDENT;
+    table.next[LS_IDENT][CC_DIGIT] = LS_IDENT;
+    table.next[LS_NUMBER][CC_DIGIT] = LS_NUMBER;
+    table.next[LS_NUMBER][CC_LETTER] = LS_BAD_NUMBER;
+    table.next[LS_BAD_NUMBER][CC_LETTER] = LS_BAD_NUMBER;
+    table.next[LS_BAD_NUMBER][CC_DIGIT] = LS_BAD_NUMBER;
+    for (int c = 0; c < CC_COUNT; ++c) {
+        table.next[LS_STRING][c] = c == CC_QUOTE ? LS_STRING_DONE : LS_STRING;
+        table.next[LS_COMMENT][c] = LS_COMMENT;
+    }
+    table.next[LS_SLASH][CC_SLASH] = LS_COMMENT;
+    return table;
 }
 
-// 判断字符是否是运算符
-bool isOperator(char c) {
-    return c == '+' || c == '-' || c == '*' || c == '<' || c == '=';
+static constexpr TransitionTable TRANSITIONS = makeTransitionTable();
+
+// 批量跳过的前提：这些状态在对应字符类上自环
+static_assert(TRANSITIONS.next[LS_SPACE][CC_SPACE] == LS_SPACE && TRANSITIONS.next[LS_NUMBER][CC_DIGIT] == LS_NUMBER &&
+                  TRANSITIONS.next[LS_IDENT][CC_LETTER] == LS_IDENT && TRANSITIONS.next[LS_IDENT][CC_DIGIT] == LS_IDENT &&
+                  TRANSITIONS.next[LS_BAD_NUMBER][CC_LETTER] == LS_BAD_NUMBER &&
+                  TRANSITIONS.next[LS_BAD_NUMBER][CC_DIGIT] == LS_BAD_NUMBER,
+              "状态转移表与批量跳过不一致");
+
+// 关键字完美哈希：槽位 = (首字符 + 尾字符*5 + 长度) mod 32，13个关键字互不冲突（编译期检查）
+static const unsigned KEYWORD_SLOTS = 32;
+
+static constexpr unsigned keywordHash(const char* w, size_t n) {
+    return ((unsigned char)w[0] + (unsigned char)w[n - 1] * 5u + (unsigned)n) & (KEYWORD_SLOTS - 1);
 }
 
-// 添加错误到错误列表
-void addError(LexErrorType type, int line, int column, char c) {
-    std::string message;
-    switch(type) {
-        case LexErrorType::UNKNOWN_CHAR:
-            message = "无法识别的字符";
-            break;
-        case LexErrorType::INVALID_IDENTIFIER:
-            message = "非法标识符格式";
-            break;
-        case LexErrorType::INVALID_NUMBER:
-            message = "非法数字格式";
-            break;
-        case LexErrorType::UNTERMINATED_STRING:
-            message = "字符串未正确终止";
-            break;
-    }
-    errorList.push_back({type, line, column, message, c});
-}
-
-// 检查标识符是否合法
-bool isValidIdentifier(const std::string& id) {
-    if (!isalpha(id[0]) && id[0] != '_') return false;
-    for (char c : id) {
-        if (!isalnum(c) && c != '_') return false;
+// 按 KeywordValue 的顺序排列
+static constexpr const char* KEYWORD_TEXTS[] = {"class", "public", "static", "void",  "main",   "if",  "else",
+                                                "while", "return", "true",   "false", "String", "int"};
+static_assert(std::size(KEYWORD_TEXTS) == KW_INT + 1, "关键字表与 KeywordValue 不一致");
+
+struct KeywordTable {
+    struct Slot {
+        const char* text;
+        uint8_t length; // 0 表示空槽
+        int8_t value;
+    } slots[KEYWORD_SLOTS];
+    bool perfect; // 没有两个关键字落在同一槽位
+};
+
+static constexpr KeywordTable makeKeywordTable() {
+    KeywordTable table{};
+    table.perfect = true;
+    for (int kw = 0; kw <= KW_INT; ++kw) {
+        const char* text = KEYWORD_TEXTS[kw];
+        size_t n = 0;
+        while (text[n]) ++n;
+        KeywordTable::Slot& slot = table.slots[keywordHash(text, n)];
+        if (slot.length != 0) table.perfect = false;
+        slot = {text, (uint8_t)n, (int8_t)kw};
     }
-    return true;
+    return table;
 }
 
-// 打印所有错误
-void printErrors() {
-    for (const auto& error : errorList) {
-        std::cerr << "[词法错误] 第" << error.line << "行, 第" << error.column << "列: "
-                  << error.message << " '" << error.problematicChar << "'\n";
+static constexpr KeywordTable KEYWORDS = makeKeywordTable();
+static_assert(KEYWORDS.perfect, "关键字哈希存在冲突，需调整 keywordHash");
+
+// 关键字长度为2~6，先按长度排除，命中槽位后比较一次文本，未命中返回-1
+static inline int lookupKeyword(const char* w, size_t n) {
+    if (n < 2 || n > 6) return -1;
+    const KeywordTable::Slot& slot = KEYWORDS.slots[keywordHash(w, n)];
+    return slot.length == n && memcmp(slot.text, w, n) == 0 ? slot.value : -1;
+}
+
+static inline bool isSpaceChar(char c) { return classOf(c) == CC_SPACE; }
+static inline bool isDigitChar(char c) { return classOf(c) == CC_DIGIT; }
+static inline bool isIdentChar(char c) { return classOf(c) == CC_LETTER || classOf(c) == CC_DIGIT; }
+
+#if defined(__AVX2__)
+using SimdVec = __m256i;
+static const int SIMD_WIDTH = 32;
+static inline SimdVec simdLoad(const char* p) { return _mm256_loadu_si256((const __m256i*)p); }
+static inline SimdVec simdSet(char c) { return _mm256_set1_epi8(c); }
+static inline SimdVec simdEq(SimdVec a, SimdVec b) { return _mm256_cmpeq_epi8(a, b); }
+static inline SimdVec simdGt(SimdVec a, SimdVec b) { return _mm256_cmpgt_epi8(a, b); }
+static inline SimdVec simdAnd(SimdVec a, SimdVec b) { return _mm256_and_si256(a, b); }
+static inline SimdVec simdOr(SimdVec a, SimdVec b) { return _mm256_or_si256(a, b); }
+static inline unsigned simdMask(SimdVec v) { return (unsigned)_mm256_movemask_epi8(v); }
+static const unsigned SIMD_FULL = 0xFFFFFFFFu;
+#elif defined(__SSE2__)
+using SimdVec = __m128i;
+static const int SIMD_WIDTH = 16;
+static inline SimdVec simdLoad(const char* p) { return _mm_loadu_si128((const __m128i*)p); }
+static inline SimdVec simdSet(char c) { return _mm_set1_epi8(c); }
+static inline SimdVec simdEq(SimdVec a, SimdVec b) { return _mm_cmpeq_epi8(a, b); }
+static inline SimdVec simdGt(SimdVec a, SimdVec b) { return _mm_cmpgt_epi8(a, b); }
+static inline SimdVec simdAnd(SimdVec a, SimdVec b) { return _mm_and_si128(a, b); }
+static inline SimdVec simdOr(SimdVec a, SimdVec b) { return _mm_or_si128(a, b); }
+static inline unsigned simdMask(SimdVec v) { return (unsigned)_mm_movemask_epi8(v); }
+static const unsigned SIMD_FULL = 0xFFFFu;
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#define LEX_HAS_SIMD 1
+// lo <= c <= hi（有符号比较，非ASCII字节为负数，不会落入任何区间）
+static inline SimdVec simdInRange(SimdVec v, char lo, char hi) {
+    return simdAnd(simdGt(v, simdSet(lo - 1)), simdGt(simdSet(hi + 1), v));
+}
+static inline unsigned spaceMask(SimdVec v) {
+    return simdMask(simdOr(simdEq(v, simdSet(' ')), simdInRange(v, '\t', '\r')));
+}
+static inline unsigned digitMask(SimdVec v) {
+    return simdMask(simdInRange(v, '0', '9'));
+}
+static inline unsigned identMask(SimdVec v) {
+    SimdVec alpha = simdOr(simdInRange(v, 'a', 'z'), simdInRange(v, 'A', 'Z'));
+    SimdVec digitOrUnderscore = simdOr(simdInRange(v, '0', '9'), simdEq(v, simdSet('_')));
+    return simdMask(simdOr(alpha, digitOrUnderscore));
+}
+#endif
+
+// 跳过 [p, end) 中连续满足分类的字节，返回第一个不满足的位置
+#if defined(LEX_HAS_SIMD)
+#define DEFINE_SCAN(name, maskFn, scalarFn)                                   \
+    static const char* name(const char* p, const char* end) {                 \
+        while (end - p >= SIMD_WIDTH) {                                       \
+            unsigned m = maskFn(simdLoad(p));                                 \
+            if (m != SIMD_FULL) return p + __builtin_ctz(~m);                 \
+            p += SIMD_WIDTH;                                                  \
+        }                                                                     \
+        while (p < end && scalarFn(*p)) ++p;                                  \
+        return p;                                                             \
+    }
+#else
+#define DEFINE_SCAN(name, maskFn, scalarFn)                                   \
+    static const char* name(const char* p, const char* end) {                 \
+        while (p < end && scalarFn(*p)) ++p;                                  \
+        return p;                                                             \
+    }
+#endif
+
+DEFINE_SCAN(scanSpaces, spaceMask, isSpaceChar)
+DEFINE_SCAN(scanDigits, digitMask, isDigitChar)
+DEFINE_SCAN(scanIdent, identMask, isIdentChar)
+
+#undef DEFINE_SCAN
+
+
+// 自环状态一次跳过连续段：返回第一个会离开当前状态的位置
+static inline const char* skipLoop(LexState state, const char* p, const char* end) {
+    switch (state) {
+        case LS_SPACE:
+            return scanSpaces(p, end);
+        case LS_IDENT:
+        case LS_BAD_NUMBER:
+            return scanIdent(p, end);
+        case LS_NUMBER:
+            return scanDigits(p, end);
+        case LS_STRING: {
+            const char* quote = static_cast<const char*>(memchr(p, '"', end - p));
+            return quote ? quote : end;
+        }
+        case LS_COMMENT:
+            return end;
+        default:
+            return p;
+    }
+}
+
+// 分析 [begin, end) 一行：每个单词从 LS_START 出发走到 LS_ACCEPT，按停下时的状态产生token或错误
+static void lexRange(CompilationContext& ctx, const char* begin, const char* end, int lineNumber, std::vector<Token>& tokens) {
+    const char* p = begin;
+    while (p < end) {
+        const char* start = p;
+        LexState state = (LexState)TRANSITIONS.next[LS_START][classOf(*p++)];
+        for (;;) {
+            p = skipLoop(state, p, end);
+            if (p == end) break;
+            LexState next = (LexState)TRANSITIONS.next[state][classOf(*p)];
+            if (next == LS_ACCEPT) break;
+            state = next;
+            ++p;
+        }
+
+        int column = start - begin + 1;
+        switch (state) {
+            case LS_IDENT: {
+                int kw = lookupKeyword(start, p - start);
+                if (kw >= 0) tokens.push_back({KEYWORD, kw, lineNumber, column});
+                else tokens.push_back({IDENTIFIER, ctx.identifierTable.intern(std::string_view(start, p - start)), lineNumber, column});
+                break;
+            }
+            case LS_NUMBER:
+            case LS_BAD_NUMBER: {
+                // 前导零：0 后面还有数字
+                bool leadingZero = start[0] == '0' && start + 1 < p && isDigitChar(start[1]);
+                if (leadingZero) addError(ctx, LexErrorType::INVALID_NUMBER, lineNumber, column, '0');
+                if (state == LS_BAD_NUMBER) {
+                    addError(ctx, LexErrorType::INVALID_IDENTIFIER, lineNumber, column, *scanDigits(start, p));
+                } else if (!leadingZero) {
+                    tokens.push_back({INTEGER_LITERAL, ctx.constantTable.intern(std::string_view(start, p - start), CONST_INT), lineNumber, column});
+                }
+                break;
+            }
+            case LS_STRING:
+                addError(ctx, LexErrorType::UNTERMINATED_STRING, lineNumber, column, '"');
+                break;
+            case LS_STRING_DONE:
+                tokens.push_back({STRING_LITERAL, ctx.constantTable.intern(std::string_view(start + 1, p - start - 2), CONST_STRING), lineNumber, column});
+                break;
+            case LS_OPERATOR:
+                tokens.push_back({OPERATOR, (int)*start, lineNumber, column});
+                break;
+            case LS_DELIMITER:
+                tokens.push_back({DELIMITER, (int)*start, lineNumber, column});
+                break;
+            case LS_EOF:
+                tokens.push_back({END_OF_FILE, -1, lineNumber, column});
+                break;
+            case LS_SLASH:
+            case LS_UNKNOWN:
+                addError(ctx, LexErrorType::UNKNOWN_CHAR, lineNumber, column, *start);
+                break;
+            default:
+                // 空白与注释
+                break;
+        }
     }
 }
 
 // 函数接收文件名作为参数，返回token列表
-std::vector<Token> runLexer(const std::string& filename) {
+std::vector<Token> runLexer(CompilationContext& ctx, const std::string& filename) {
     std::ifstream fin(filename);
     std::vector<Token> tokens;
     std::string line;
     int lineNumber = 1;
-    errorList.clear(); // 清空错误列表
+    ctx.lexErrors.clear(); // 清空错误列表
 
     // 逐行读取文件内容
     while (std::getline(fin, line)) {
-        size_t i = 0;
-        // 逐字符处理当前行
-        while (i < line.size()) {
-            int column = i + 1; // 列号从1开始
-            if (isspace(line[i])) { ++i; continue; } // 跳过空白字符
-
-            // 标识符或关键字识别,isalpha 检查是否为字母
-            if (isalpha(line[i]) || line[i] == '_') {
-                std::string word;
-                // 读取连续的字母数字和下划线组成单词,isalnum 检查是否为字母或数字
-                while (i<line.size() && (isalnum(line[i]) || line[i] == '_')) word += line[i++];
-                if (!isValidIdentifier(word)) {
-                    // 如果标识符不合法，记录错误
-                    addError(LexErrorType::INVALID_IDENTIFIER, lineNumber, column, line[i-1]);
-                    continue;
-                }
-                if (keywordMap.count(word)) {
-                    // 在关键字表中，添加KEYWORD类型的token
-                    tokens.push_back({KEYWORD, keywordMap[word],lineNumber, column});
-                } else {
-                    // 在标识符表中查找
-                    auto it = std::find(identifierTable.begin(), identifierTable.end(), word);
-                    int index = it == identifierTable.end() ? identifierTable.size() : std::distance(identifierTable.begin(), it);
-                    // 如果未找到，则添加到标识符表
-                    if (it == identifierTable.end()) identifierTable.push_back(word);
-                    // 添加IDENTIFIER类型的token
-                    tokens.push_back({IDENTIFIER, index, lineNumber, column});
-                }
-            } 
-            // 数字常量识别
-            else if (isdigit(line[i])) {
-                std::string num;
-                bool hasError = false;
-                // 检查前导零
-                if (line[i] == '0' && i+1 < line.size() && isdigit(line[i+1])) {
-                    // 如果数字以0开头且后面还有数字，则记录错误
-                    addError(LexErrorType::INVALID_NUMBER, lineNumber, column, line[i]);
-                    hasError = true;
-                }
-                // 读取连续的数字
-                while (isdigit(line[i])) num += line[i++]; 
-                // 检查数字后是否紧跟字母或下划线
-                if (i < line.size() && (isalpha(line[i]) || line[i] == '_')) {
-                    addError(LexErrorType::INVALID_IDENTIFIER, lineNumber, column, line[i]);
-                    // 跳过后续的非法标识符部分
-                    while (i < line.size() && (isalnum(line[i]) || line[i] == '_')) ++i;
-                    continue;
-                }
-                if(!hasError)
-                {
-                    // 在常量表中查找
-                    auto it = std::find(constantTable.begin(), constantTable.end(), num);
-                    int index = it == constantTable.end() ? constantTable.size() : std::distance(constantTable.begin(), it);
-                    // 如果未找到，则添加到常量表
-                    if (it == constantTable.end()) constantTable.push_back(num);
-                    // 添加INTEGER_LITERAL类型的token
-                    tokens.push_back({INTEGER_LITERAL, index,lineNumber, column});
-                }  
-            } 
-            // 字符串字面量识别
-            else if (line[i] == '"') {
-                std::string str;
-                int startColumn = column;
-                bool terminated = false;
-                i++; // 跳过开始的引号
-                
-                while (i < line.size()) {
-                    if (line[i] == '"') {
-                        terminated = true;
-                        i++;
-                        break;
-                    }
-                    str += line[i++];
-                }
-                
-                if (!terminated) {
-                    addError(LexErrorType::UNTERMINATED_STRING, lineNumber, startColumn, '"');
-                } else {
-                    // 处理字符串常量，添加到常量表
-                    auto it = std::find(constantTable.begin(), constantTable.end(), str);
-                    int index = it == constantTable.end() ? constantTable.size() : std::distance(constantTable.begin(), it);
-                    if (it == constantTable.end()) constantTable.push_back(str);
-                    tokens.push_back({STRING_LITERAL, index,lineNumber, startColumn});
-                }
-            }
-            else if (isOperator(line[i])) {
-                // 运算符识别，直接记录字符的ASCII码作为token值
-                tokens.push_back({OPERATOR, (int)line[i++], lineNumber, column});
-            } else if (isDelimiter(line[i])) {
-                // 分隔符识别，直接记录字符的ASCII码作为token值
-                tokens.push_back({DELIMITER, (int)line[i++],lineNumber, column});
-            } else if (line[i] == '$') {
-                // 文件结束符识别
-                tokens.push_back({END_OF_FILE, -1, lineNumber, column});
-                ++i;
-            } else if (line[i] == '/') {
-                // 注释处理
-                if (i + 1 < line.size() && line[i + 1] == '/') {
-                    break; // 跳过行注释
-                }
-            } else {
-                // 无法识别的字符，记录为错误
-                addError(LexErrorType::UNKNOWN_CHAR, lineNumber, column, line[i]);
-                ++i;
+        lexRange(ctx, line.data(), line.data() + line.size(), lineNumber, tokens);
+        ++lineNumber;
+    }
+
+    // 分析结束后打印所有错误
+    if (!ctx.lexErrors.empty()) {
+        printLexErrors(ctx);
+    }
+
+    return tokens;
+}
+
+/** 内存映射词法分析：
+ * 1.mmap 整个源文件，词素以 string_view 指向映射区，仅在驻留时拷贝
+ * 2.memchr 切分行，保持与 runLexer 相同的行列号，每行交给同一个DFA
+ */
+
+// 只读映射整个文件，析构时解除映射
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                base = static_cast<const char*>(addr);
+                length = st.st_size;
+                madvise(addr, length, MADV_SEQUENTIAL);
             }
         }
+        close(fd);
+    }
+    ~MappedFile() {
+        if (base) munmap(const_cast<char*>(base), length);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+};
+
+void lexLine(CompilationContext& ctx, std::string_view line, int lineNumber, std::vector<Token>& tokens) {
+    lexRange(ctx, line.data(), line.data() + line.size(), lineNumber, tokens);
+}
+
+LexerCursor::LexerCursor(CompilationContext& ctx, const std::string& filename, std::ostream* tokenOut)
+    : ctx(ctx), fin(filename), tokenOut(tokenOut) {
+    ctx.lexErrors.clear();
+}
+
+bool LexerCursor::fill() {
+    size_t before = window.size();
+    while (window.size() == before) {
+        if (!std::getline(fin, line)) return false;
+        lexRange(ctx, line.data(), line.data() + line.size(), ++lineNumber, window);
+    }
+    produced += window.size() - before;
+    if (tokenOut) {
+        for (size_t i = before; i < window.size(); ++i) *tokenOut << window[i].type << " " << window[i].value << "\n";
+    }
+    return true;
+}
+
+std::vector<Token> runLexerMapped(CompilationContext& ctx, const std::string& filename) {
+    MappedFile file(filename);
+    return runLexerBuffer(ctx, std::string_view(file.data(), file.size()));
+}
+
+std::vector<Token> runLexerBuffer(CompilationContext& ctx, std::string_view source) {
+    std::vector<Token> tokens;
+    ctx.lexErrors.clear();
+
+    const char* p = source.data();
+    const char* end = p + source.size();
+    int lineNumber = 1;
+    while (p < end) {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!lineEnd) lineEnd = end;
+        lexRange(ctx, p, lineEnd, lineNumber, tokens);
+        p = lineEnd < end ? lineEnd + 1 : end;
         ++lineNumber;
     }
 
-    // 分析结束后打印所有错误
-    if (!errorList.empty()) {
-        printErrors();
+    if (!ctx.lexErrors.empty()) {
+        printLexErrors(ctx);
     }
 
     return tokens;
-}
\ No newline at end of file
+}
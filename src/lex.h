@@ -1,9 +1,13 @@
 #ifndef LEX_H
 #define LEX_H
 
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <ostream>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
 
 // Token结构定义
 enum TokenType {
@@ -41,9 +45,107 @@ struct Token {
     int column; // 列号
 };
 
-extern std::vector<std::string> identifierTable;
-extern std::vector<std::string> constantTable;
+// 常量种类，整数与字符串字面量各自去重，互不合并
+enum ConstantKind {
+    CONST_INT,
+    CONST_STRING
+};
+
+/* 符号驻留表：哈希查找平均O(1)，每个符号分配稳定的整数id（按首次出现顺序递增）
+ * 索引为线性探测的开放寻址表，槽位只存 (哈希值, id)，哈希值含所属池，相同时才比较文本；
+ * 装载率不超过1/2，扩容时按保存的哈希值重新放置，不再读符号文本
+ */
+class Interner {
+public:
+    // 每次编译只有一份符号表，禁止意外的整表拷贝；移动只转移 pool 与索引，id 不变
+    Interner() = default;
+    Interner(const Interner&) = delete;
+    Interner& operator=(const Interner&) = delete;
+    Interner(Interner&&) = default;
+    Interner& operator=(Interner&&) = default;
+
+    // 驻留符号并返回其id，kind（0或1）用于区分不同池（如整数/字符串常量）
+    int intern(std::string_view text, int kind = 0);
+    // 查找符号id，不存在时返回-1
+    int find(std::string_view text, int kind = 0) const;
+    const std::string& operator[](size_t id) const { return pool[id]; }
+    int kindOf(size_t id) const { return kinds[id]; }
+    size_t size() const { return pool.size(); }
+    void clear();
+
+private:
+    struct Slot {
+        uint32_t hash;
+        int id; // 空槽位为-1
+    };
+
+    static uint32_t hash(std::string_view text, int kind);
+    // 查找哈希值为 h 的 text 所在的槽位，不存在时为应插入的空槽位；slots 不能为空
+    size_t probe(std::string_view text, uint32_t h) const;
+    void grow();
+
+    std::deque<std::string> pool; // id -> 符号文本，deque保证扩容时已有字符串地址不变
+    std::vector<int> kinds; // id -> 所属池
+    std::vector<Slot> slots; // 各池共用的 (文本, 池) -> id 索引，大小为0或2的幂
+};
+
+// 错误类型
+enum class LexErrorType {
+    UNKNOWN_CHAR,       // 无法识别的字符
+    INVALID_IDENTIFIER, // 非法标识符
+    INVALID_NUMBER,     // 非法数字格式
+    UNTERMINATED_STRING // 未终止的字符串
+};
+
+// 错误信息结构体
+struct LexError {
+    LexErrorType type;
+    int line;
+    int column;
+    std::string message;
+    char problematicChar;
+};
 
-std::vector<Token> runLexer(const std::string& filename);
+struct CompilationContext;
+
+// 标识符与常量驻留到 ctx 的符号表中，错误记录在 ctx.lexErrors 并在结束时输出到 ctx.diagnostics
+std::vector<Token> runLexer(CompilationContext& ctx, const std::string& filename);
+
+// 内存映射模式：一次性映射整个源文件并用SIMD批量分类字符，输出与runLexer完全相同的token流
+std::vector<Token> runLexerMapped(CompilationContext& ctx, const std::string& filename);
+
+// 对内存中的源码做与 runLexerMapped 相同的词法分析（编译服务器的内联源码使用）
+std::vector<Token> runLexerBuffer(CompilationContext& ctx, std::string_view source);
+
+// 分析一行（不含换行符），token追加到 tokens，错误追加到 ctx.lexErrors 且不输出；各行互不影响，增量分析逐行重新分析
+void lexLine(CompilationContext& ctx, std::string_view line, int lineNumber, std::vector<Token>& tokens);
+
+// 输出 ctx.lexErrors 到 ctx.diagnostics
+void printLexErrors(const CompilationContext& ctx);
+
+/* 流式词法分析：按需逐行读取源文件，token追加到 window 末尾，使用者分析完一段后丢弃其前缀，
+ * 内存只与 window 中未丢弃的token有关；token流与 runLexer 相同，错误追加到 ctx.lexErrors 且不输出
+ */
+class LexerCursor {
+public:
+    // tokenOut 非空时每个新token按 tokens.txt 的格式写出
+    LexerCursor(CompilationContext& ctx, const std::string& filename, std::ostream* tokenOut = nullptr);
+
+    // 继续读入源文件直到 window 中新增了token，文件已读完时返回false
+    bool fill();
+    // 丢弃 window 的前 count 个token
+    void discard(size_t count) { window.erase(window.begin(), window.begin() + count); }
+    bool isOpen() const { return fin.is_open(); }
+
+    std::vector<Token> window;
+    size_t produced = 0; // 已产生的token总数
+
+private:
+    CompilationContext& ctx;
+    std::ifstream fin;
+    std::string line;
+    int lineNumber = 0;
+    std::ostream* tokenOut;
+};
 
 #endif
\ No newline at end of file
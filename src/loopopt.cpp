@@ -0,0 +1,201 @@
+#include "loopopt.h"
+#include "cfg.h"
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <set>
+
+/** 循环优化流程：
+ * 每个遍重新构建控制流图，确定各循环的前置块和插入位置，
+ * 把要移动/新增的四元式记入 before 表，最后由 IRProgram::splice 一次性重排
+ * 每个循环都要扫描其中全部四元式，嵌套深度超过 MAX_LOOP_DEPTH 的循环不再处理，
+ * 总工作量不超过 MAX_LOOP_DEPTH 倍的程序长度，不随嵌套深度平方增长
+ */
+
+static const int MAX_LOOP_DEPTH = 8;
+
+// 循环包含的块，按 less 排序
+template <typename Less>
+static std::vector<int> loopBody(const CFG& cfg, const Loop& loop, Less less) {
+    std::vector<int> blocks(cfg.loopBlocks.begin() + loop.begin, cfg.loopBlocks.begin() + loop.end);
+    std::sort(blocks.begin(), blocks.end(), less);
+    return blocks;
+}
+
+// 循环的前置块，不存在时返回-1
+static int preheaderOf(const CFG& cfg, const Loop& loop) {
+    int pre = -1;
+    for (int p : cfg.blocks[loop.header].preds) {
+        if (cfg.blocks[p].idom < 0) continue; // 不可达前驱
+        if (cfg.inLoop(p, loop)) continue;
+        if (pre >= 0) return -1;
+        pre = p;
+    }
+    if (pre < 0 || cfg.blocks[pre].succs.size() != 1) return -1;
+    return pre;
+}
+
+// 前置块中的插入位置：块尾 jmp 之前，没有 jmp 则为块尾
+static size_t insertPoint(const IRProgram& ir, const BasicBlock& block) {
+    if (block.end > block.begin && isJump(ir.ops[block.end - 1])) return block.end - 1;
+    return block.end;
+}
+
+// 四元式下标 -> 所在块，不可达块为-1
+static std::vector<int> blockIndex(const IRProgram& ir, const CFG& cfg) {
+    std::vector<int> blockOf(ir.size(), -1);
+    for (int b : cfg.order) {
+        for (size_t q = cfg.blocks[b].begin; q < cfg.blocks[b].end; ++q) blockOf[q] = b;
+    }
+    return blockOf;
+}
+
+// ---------------- 循环不变量外提 ----------------
+
+/* 只外提结果为临时变量的运算和复写：临时变量只定义一次，移到前置块后仍支配所有使用；
+ * 运算没有副作用也不会出错，即使循环一次都不执行，提前计算也不影响结果。
+ * 操作数不变的条件：常量；循环内没有被赋值的变量；定义在循环外或已被外提的临时变量。
+ * 外层循环先处理，能提到外层前置块的就不会留在内层前置块
+ */
+void runLICM(IRProgram& ir) {
+    CFG cfg = buildCFG(ir);
+    std::vector<int> blockOf = blockIndex(ir, cfg);
+    std::vector<int> tempDef(ir.tempCount, -1);
+    for (size_t q = 0; q < ir.size(); ++q) {
+        if (blockOf[q] >= 0 && !isJump(ir.ops[q]) && ir.result[q].kind() == OPD_TEMP) tempDef[ir.result[q].index()] = q;
+    }
+
+    std::vector<char> hoisted(ir.size(), 0);
+    std::vector<std::vector<Quadruple>> before(ir.size() + 1);
+    std::vector<int> loopOfBlock(cfg.blocks.size(), -1); // 块 -> 当前循环编号（仅对当前循环有效）
+    std::vector<int> varDefinedIn(ir.context->slotCount(), -1); // 变量 -> 在其中被赋值的当前循环编号
+    bool changed = false;
+    for (size_t l = 0; l < cfg.loops.size(); ++l) {
+        const Loop& loop = cfg.loops[l];
+        int pre = loop.depth > MAX_LOOP_DEPTH ? -1 : preheaderOf(cfg, loop);
+        if (pre < 0) continue;
+        std::vector<Quadruple>& target = before[insertPoint(ir, cfg.blocks[pre])];
+
+        std::vector<int> blocks =
+            loopBody(cfg, loop, [&](int a, int b) { return cfg.blocks[a].rpo < cfg.blocks[b].rpo; });
+        for (int b : blocks) {
+            loopOfBlock[b] = l;
+            for (size_t q = cfg.blocks[b].begin; q < cfg.blocks[b].end; ++q) {
+                if (!isJump(ir.ops[q]) && ir.result[q].kind() == OPD_VAR) varDefinedIn[ir.result[q].index()] = l;
+            }
+        }
+        auto invariant = [&](Operand o) {
+            if (o.kind() == OPD_VAR) return varDefinedIn[o.index()] != (int)l;
+            if (o.kind() == OPD_TEMP) {
+                int d = tempDef[o.index()];
+                return d >= 0 && (hoisted[d] || loopOfBlock[blockOf[d]] != (int)l);
+            }
+            return true;
+        };
+
+        // 按逆后序反复扫描直到不再有新的不变量，外提顺序即满足依赖的顺序
+        bool found = true;
+        while (found) {
+            found = false;
+            for (int b : blocks) {
+                for (size_t q = cfg.blocks[b].begin; q < cfg.blocks[b].end; ++q) {
+                    OpCode op = ir.ops[q];
+                    if (hoisted[q] || (!isBinary(op) && op != OP_ASSIGN) || ir.result[q].kind() != OPD_TEMP) continue;
+                    if (!invariant(ir.arg1[q]) || !invariant(ir.arg2[q])) continue;
+                    hoisted[q] = 1;
+                    target.push_back(ir.at(q));
+                    found = changed = true;
+                }
+            }
+        }
+    }
+    if (changed) ir.splice(hoisted, before);
+}
+
+// ---------------- 归纳变量强度削弱 ----------------
+
+// 基本归纳变量的一次更新 "Add i c t; = t i"（或 "Add c i t"、"Sub i c t"），返回步长
+static bool matchIncrement(const IRProgram& ir, size_t q, int64_t& step) {
+    if (ir.ops[q] != OP_ASSIGN || ir.arg1[q].kind() != OPD_TEMP || q == 0) return false;
+    size_t p = q - 1;
+    if (ir.result[p] != ir.arg1[q]) return false;
+    Operand var = ir.result[q];
+    if (ir.ops[p] == OP_ADD && ir.arg1[p] == var && ir.arg2[p].kind() == OPD_INT) {
+        step = ir.intPool[ir.arg2[p].index()];
+    } else if (ir.ops[p] == OP_ADD && ir.arg2[p] == var && ir.arg1[p].kind() == OPD_INT) {
+        step = ir.intPool[ir.arg1[p].index()];
+    } else if (ir.ops[p] == OP_SUB && ir.arg1[p] == var && ir.arg2[p].kind() == OPD_INT) {
+        step = (int64_t)(0 - (uint64_t)ir.intPool[ir.arg2[p].index()]);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/* 对循环内的 "Mul i k t"（i 为基本归纳变量，k 为常量且不是 2 的幂，2 的幂留给代数化简改为移位）：
+ * 前置块中初始化 s = i * k，i 的每次更新之后追加 s = s + c * k，
+ * 于是循环内任意位置都有 s == i * k，乘法改为复写 "= s t"，再由复写传播和死存储消除清理。
+ * s 是以 "i*k" 命名的 SLOT_SYNTHETIC 额外槽位，不占用标识符表，也不输出终值。
+ * 内层循环先处理，已改写的乘法不会再被外层循环处理；
+ * 内外层循环对同一 (i, k) 共用一个 s，各自在前置块初始化，每处更新只追加一次
+ */
+void runStrengthReduction(IRProgram& ir) {
+    CFG cfg = buildCFG(ir);
+    std::vector<char> removed(ir.size(), 0);
+    std::vector<std::vector<Quadruple>> before(ir.size() + 1);
+    std::map<std::pair<uint32_t, int64_t>, Operand> reduced; // (归纳变量, 乘数) -> s
+    std::set<std::pair<size_t, uint32_t>> updated; // 已追加更新的 (位置, s)
+    bool changed = false;
+    for (size_t l = cfg.loops.size(); l-- > 0;) {
+        const Loop& loop = cfg.loops[l];
+        int pre = loop.depth > MAX_LOOP_DEPTH ? -1 : preheaderOf(cfg, loop);
+        if (pre < 0) continue;
+        size_t at = insertPoint(ir, cfg.blocks[pre]);
+        std::vector<int> blocks = loopBody(cfg, loop, std::less<int>());
+
+        // 收集循环内各变量的全部赋值，全部为 i = i ± c 形式的才是基本归纳变量
+        std::map<uint32_t, std::vector<std::pair<size_t, int64_t>>> updates; // 变量 -> (更新位置, 步长)
+        std::vector<uint32_t> notInduction;
+        for (int b : blocks) {
+            for (size_t q = cfg.blocks[b].begin; q < cfg.blocks[b].end; ++q) {
+                if (isJump(ir.ops[q]) || ir.result[q].kind() != OPD_VAR) continue;
+                int64_t step;
+                if (matchIncrement(ir, q, step)) updates[ir.result[q].index()].push_back({q, step});
+                else notInduction.push_back(ir.result[q].index());
+            }
+        }
+        for (uint32_t v : notInduction) updates.erase(v);
+
+        std::set<uint32_t> initialized; // 本循环前置块中已初始化的 s
+        for (int b : blocks) {
+            for (size_t q = cfg.blocks[b].begin; q < cfg.blocks[b].end; ++q) {
+                if (ir.ops[q] != OP_MUL || ir.result[q].kind() != OPD_TEMP) continue;
+                Operand iv = ir.arg1[q], k = ir.arg2[q];
+                if (iv.kind() == OPD_INT) std::swap(iv, k);
+                if (iv.kind() != OPD_VAR || k.kind() != OPD_INT || !updates.count(iv.index())) continue;
+                int64_t factor = ir.intPool[k.index()];
+                if (factor >= 0 && (factor & (factor - 1)) == 0) continue; // 0、1 和 2 的幂留给代数化简
+                Operand& s = reduced[{iv.index(), factor}];
+                if (s.kind() == OPD_NONE) {
+                    CompilationContext& ctx = *ir.context;
+                    std::string base = ctx.slotName(iv.index()) + "*" + std::to_string(factor), name = base;
+                    for (int n = 1; ctx.findSlot(SLOT_SYNTHETIC, name) != NO_SLOT; ++n) name = base + "." + std::to_string(n);
+                    s = Operand::make(OPD_VAR, ctx.addSlot(SLOT_SYNTHETIC, name));
+                }
+                if (initialized.insert(s.index()).second) {
+                    before[at].push_back({OP_MUL, iv, k, s});
+                    for (const std::pair<size_t, int64_t>& u : updates[iv.index()]) {
+                        if (!updated.insert({u.first, s.index()}).second) continue;
+                        Operand delta = ir.intConst((int64_t)((uint64_t)u.second * (uint64_t)factor));
+                        before[u.first + 1].push_back({OP_ADD, s, delta, s});
+                    }
+                }
+                ir.ops[q] = OP_ASSIGN;
+                ir.arg1[q] = s;
+                ir.arg2[q] = Operand();
+                changed = true;
+            }
+        }
+    }
+    if (changed) ir.splice(removed, before);
+}
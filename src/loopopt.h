@@ -0,0 +1,18 @@
+#ifndef LOOPOPT_H
+#define LOOPOPT_H
+
+#include "irgen.h"
+
+/** 循环优化遍（基于 cfg.h 找出的自然循环）：
+ *  licm     循环不变量外提：操作数在循环内不变的运算移到循环前置块
+ *  strength 归纳变量强度削弱：识别每次迭代只做 i = i ± c 的基本归纳变量，
+ *           把循环内的 i * k 改为每次 i 更新时累加 c * k 的新变量
+ * 只处理有唯一前置块（循环外唯一前驱且该前驱只有这一个后继）、嵌套不超过8层的循环，
+ * While 的轮转式翻译 "jmp Lcond; Lbody: ...; Lcond: jcc Lbody" 总满足这一条件
+ */
+
+void runLICM(IRProgram& ir);
+
+void runStrengthReduction(IRProgram& ir);
+
+#endif
@@ -1,67 +1,150 @@
-#include "lex.h"
-#include "parser.h"
-#include "semantic.h"
-#include "irgen.h"
-#include <iostream>
+#include "driver.h"
+#include "optimizer.h"
+#include "server.h"
+#include <filesystem>
 #include <fstream>
-#include "ast_visualize.h"
-
-void writeTokenStream(const std::vector<Token>& tokens) {
-    std::ofstream fout("../res/tokens.txt");
-    for (const auto& tok : tokens) {
-        fout << tok.type << " " << tok.value << "\n";
-    }
-    fout.close();
-}
+#include <iostream>
+#include <thread>
 
-void writeIdentifierTable() {
-    std::ofstream fout("../res/identifier_table.txt");
-    for (size_t i = 0; i < identifierTable.size(); ++i) {
-        fout << i << ": " << identifierTable[i] << "\n";
+int main(int argc, char* argv[]) {
+    std::string inputFile;
+    CompileOptions options;
+    std::string batchDir; // --batch=目录：并行编译目录下所有源文件，结果写入 ../res/batch/<文件名>/
+    int threads = std::thread::hardware_concurrency(); // --threads=N：批量编译的线程数
+    std::string serveSocket; // --serve=套接字：作为常驻编译服务器运行
+    std::string connectSocket; // --connect=套接字：作为客户端把编译请求发给服务器
+    bool stopServer = false; // --shutdown：与 --connect 一起使用，停止服务器
+    int phases = PHASE_TOKENS | PHASE_DIAGNOSTICS | PHASE_IR; // --phases=tokens,diagnostics,ir：客户端请求的部分
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--mmap") options.useMmap = true;
+        else if (arg.size() == 3 && arg.compare(0, 2, "-O") == 0 && isdigit(arg[2])) options.passes = passesForLevel(arg[2] - '0');
+        else if (arg.compare(0, 9, "--passes=") == 0) {
+            options.passes.clear();
+            std::string list = arg.substr(9);
+            for (size_t pos = 0; pos <= list.size();) {
+                size_t comma = list.find(',', pos);
+                if (comma == std::string::npos) comma = list.size();
+                if (comma > pos) options.passes.push_back(list.substr(pos, comma - pos));
+                pos = comma + 1;
+            }
+        }
+        else if (arg == "--opt-stats") options.optStats = true;
+        else if (arg.compare(0, 7, "--emit=") == 0) {
+            // 逗号分隔：text（默认）/bin 选择 token流、符号表、AST、IR 的输出格式，asm、c 另外生成汇编、C 源码；
+            // 每个 --emit= 完整给出输出集合，出现多次时以最后一个为准
+            std::string list = arg.substr(7);
+            options.emitAsm = options.emitC = options.emitBinary = false;
+            for (size_t pos = 0; pos <= list.size();) {
+                size_t comma = list.find(',', pos);
+                if (comma == std::string::npos) comma = list.size();
+                std::string format = list.substr(pos, comma - pos);
+                pos = comma + 1;
+                if (format == "asm") options.emitAsm = true;
+                else if (format == "c") options.emitC = true;
+                else if (format == "bin") options.emitBinary = true;
+                else if (format == "text") options.emitBinary = false;
+                else if (!format.empty()) {
+                    std::cerr << "未知的输出格式: " << format << "\n";
+                    return 1;
+                }
+            }
+        }
+        else if (arg.compare(0, 6, "--ast=") == 0) {
+            if (!parseAstFormat(arg.substr(6), options.astExport.format)) {
+                std::cerr << "未知的AST格式: " << arg.substr(6) << "\n";
+                return 1;
+            }
+        }
+        else if (arg.compare(0, 12, "--ast-depth=") == 0) options.astExport.maxDepth = std::atoi(arg.c_str() + 12);
+        else if (arg.compare(0, 15, "--ast-collapse=") == 0) options.astExport.collapseAbove = std::strtoul(arg.c_str() + 15, nullptr, 10);
+        else if (arg.compare(0, 12, "--ast-lines=") == 0) {
+            // A-B、A-（到文件末尾）或单独一行 A
+            const char* range = arg.c_str() + 12;
+            char* dash;
+            options.astExport.firstLine = std::strtol(range, &dash, 10);
+            options.astExport.lastLine = *dash == '-' ? std::atoi(dash + 1) : options.astExport.firstLine;
+        }
+        else if (arg == "--run") options.run = true;
+        else if (arg == "--jit") options.jit = true;
+        else if (arg.compare(0, 16, "--jit-threshold=") == 0) options.jitThreshold = std::atoi(arg.c_str() + 16);
+        else if (arg.compare(0, 8, "--cache=") == 0) options.cacheDir = arg.substr(8);
+        else if (arg.compare(0, 13, "--cache-size=") == 0) options.cacheLimit = std::strtoull(arg.c_str() + 13, nullptr, 10) << 20;
+        else if (arg == "--cache-stats") options.cacheStats = true;
+        else if (arg == "--stream") options.stream = true;
+        else if (arg == "--time-report") options.timeReport = true;
+        else if (arg == "--stats=json") options.statsJson = true;
+        else if (arg.compare(0, 8, "--batch=") == 0) batchDir = arg.substr(8);
+        else if (arg.compare(0, 10, "--threads=") == 0) threads = std::atoi(arg.c_str() + 10);
+        else if (arg.compare(0, 8, "--serve=") == 0) serveSocket = arg.substr(8);
+        else if (arg.compare(0, 10, "--connect=") == 0) connectSocket = arg.substr(10);
+        else if (arg == "--shutdown") stopServer = true;
+        else if (arg.compare(0, 9, "--phases=") == 0) {
+            if (!parsePhases(arg.substr(9), phases)) {
+                std::cerr << "未知的阶段: " << arg.substr(9) << "\n";
+                return 1;
+            }
+        }
+        else inputFile = arg;
     }
-    fout.close();
-}
-
-void writeConstantTable() {
-    std::ofstream fout("../res/constant_table.txt");
-    for (size_t i = 0; i < constantTable.size(); ++i) {
-        fout << i << ": " << constantTable[i] << "\n";
+    if (!serveSocket.empty()) return runServer(serveSocket, std::cerr);
+    if (!connectSocket.empty() && stopServer) {
+        CompileRequest request;
+        request.phases = 0;
+        request.shutdown = true;
+        CompileResponse response;
+        std::string error;
+        if (sendRequest(connectSocket, request, response, error)) return 0;
+        std::cerr << error << "\n";
+        return 1;
     }
-    fout.close();
-}
-
-int main(int argc, char* argv[]) {
-    if (argc != 2) {
+    if (inputFile.empty() && batchDir.empty()) {
         std::cerr << "请输入测试文件名\n";
         return 1;
     }
-    std::string inputFile = argv[1];
-    std::vector<Token> tokens = runLexer("../test/" + inputFile);
-    writeTokenStream(tokens);
-    writeIdentifierTable();
-    writeConstantTable();
-
-    // 检查token流
-    // for (const auto& tok : tokens) {
-    // std::cout << tok.type << " " << tok.value << " " << tok.line << " " << tok.column << std::endl;
-    // }
-    
-    ASTPtr astRoot = parse(tokens);
-    printParseErrors();
-    if (astRoot && parseErrors.empty()) {
-    exportASTtoDot(astRoot, "../res/ast.dot");
+    if (options.stream && (!options.passes.empty() || options.optStats || options.emitAsm || options.emitC ||
+                           options.emitBinary || options.run || options.jit || !options.cacheDir.empty())) {
+        std::cerr << "--stream 只生成未优化的IR，不能与优化遍、--emit、--run、--jit、--cache 同时使用\n";
+        return 1;
     }
-    // 有语法错误则不继续语义分析和IR生成
-    if (!astRoot || !parseErrors.empty()) return 1;
-    if (astRoot) {
-        if (checkSemantics(astRoot)) {
-            std::vector<Quadruple> ir = generateIR(astRoot);
-            std::ofstream irout("../res/ir.txt");
-            for (const auto& quad : ir) {
-                irout << quad.op << " " << quad.arg1 << " " << quad.arg2 << " " << quad.result << "\n";
-            }
-            irout.close();
+    if (!batchDir.empty()) {
+        std::vector<std::string> inputs = listSourceFiles(batchDir);
+        if (inputs.empty()) {
+            std::cerr << "目录中没有源文件: " << batchDir << "\n";
+            return 1;
         }
+        BatchResult result = compileBatch(inputs, "../res/batch", options, threads);
+        writeBatchResult(result, std::cout);
+        return result.failed == 0 ? 0 : 1;
     }
-    return 0;
-}
\ No newline at end of file
+    if (!connectSocket.empty()) {
+        // 服务器只返回 token流、错误与IR，需要其他输出的选项不能交给服务器
+        const AstExportOptions& ast = options.astExport;
+        if (options.emitAsm || options.emitC || options.emitBinary || options.run || options.jit ||
+            !options.cacheDir.empty() || options.cacheStats || options.stream || options.optStats ||
+            options.timeReport || options.statsJson || ast.format != AST_DOT || ast.maxDepth >= 0 ||
+            ast.collapseAbove > 0 || ast.firstLine > 0 || ast.lastLine > 0) {
+            std::cerr << "--connect 只支持优化遍与 --phases，"
+                      << "不能与 --emit、--run、--jit、--cache、--ast、--stream 及统计输出同时使用\n";
+            return 1;
+        }
+        // 服务器在另一个工作目录中打开源文件，因此传绝对路径；token流与IR写入 ../res，错误输出到标准错误
+        CompileRequest request;
+        request.path = std::filesystem::absolute("../test/" + inputFile).string();
+        request.phases = phases;
+        request.passes = options.passes;
+        CompileResponse response;
+        std::string error;
+        if (sendRequest(connectSocket, request, response, error)) {
+            if (phases & PHASE_TOKENS) std::ofstream("../res/tokens.txt") << response.tokens;
+            // 编译失败时删除上次的 ir.txt，不留下与本次源文件不符的IR
+            std::error_code ignored;
+            if ((phases & PHASE_IR) && response.status == 0) std::ofstream("../res/ir.txt") << response.ir;
+            else if (phases & PHASE_IR) std::filesystem::remove("../res/ir.txt", ignored);
+            std::cerr << response.diagnostics;
+            return response.status;
+        }
+        std::cerr << error << "，改为直接编译\n";
+    }
+    return compileFile("../test/" + inputFile, "../res", options, std::cout, std::cerr);
+}
@@ -0,0 +1,544 @@
+#include "optimizer.h"
+#include "cfg.h"
+#include "ssa.h"
+#include "loopopt.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <iomanip>
+#include <unordered_map>
+
+/** 优化流程：
+ * 每个遍开始时重新构建控制流图和SSA信息，分析完成后直接改写四元式，
+ * 被删除的四元式先做标记，遍结束时统一压缩
+ */
+
+// 整数运算按64位补码回绕
+static int64_t foldBinary(OpCode op, int64_t a, int64_t b) {
+    switch (op) {
+        case OP_ADD: return (int64_t)((uint64_t)a + (uint64_t)b);
+        case OP_SUB: return (int64_t)((uint64_t)a - (uint64_t)b);
+        case OP_MUL: return (int64_t)((uint64_t)a * (uint64_t)b);
+        case OP_SHL: return (int64_t)((uint64_t)a << (b & 63));
+        case OP_LT: return a < b;
+        case OP_EQ: return a == b;
+        default: return 0;
+    }
+}
+
+// 条件跳转是否成立
+static bool branchTaken(OpCode op, int64_t a, int64_t b) {
+    switch (op) {
+        case OP_JLT: return a < b;
+        case OP_JEQ: return a == b;
+        case OP_JNE: return a != b;
+        default: return true;
+    }
+}
+
+// 删除紧跟在目标标号前的 jmp，再删除不再被任何跳转引用的标号
+static void cleanupLabels(IRProgram& ir) {
+    std::vector<char> removed(ir.size(), 0);
+    for (size_t i = 0; i < ir.size(); ++i) {
+        if (ir.ops[i] != OP_JMP) continue;
+        for (size_t j = i + 1; j < ir.size() && ir.ops[j] == OP_LABEL; ++j) {
+            if (ir.result[j] == ir.result[i]) {
+                removed[i] = 1;
+                break;
+            }
+        }
+    }
+    std::vector<char> referenced(ir.labelCount, 0);
+    for (size_t i = 0; i < ir.size(); ++i) {
+        if (!removed[i] && isJump(ir.ops[i])) referenced[ir.result[i].index()] = 1;
+    }
+    for (size_t i = 0; i < ir.size(); ++i) {
+        if (ir.ops[i] == OP_LABEL && !referenced[ir.result[i].index()]) removed[i] = 1;
+    }
+    ir.compact(removed);
+}
+
+// ---------------- 稀疏条件常量传播 ----------------
+
+enum LatticeState : uint8_t { LAT_TOP, LAT_CONST, LAT_BOTTOM };
+
+struct Lattice {
+    LatticeState state = LAT_TOP;
+    int64_t value = 0;
+};
+
+class ConstantPropagation {
+public:
+    ConstantPropagation(IRProgram& ir, const CFG& cfg, const SSAForm& ssa)
+        : ir(ir), cfg(cfg), ssa(ssa), lattice(ssa.values.size()),
+          blockExecutable(cfg.blocks.size(), 0), edgeExecutable(cfg.blocks.size()) {}
+
+    void run();
+
+private:
+    Lattice operandLattice(size_t q, int k) const;
+    void update(int value, Lattice l);
+    void visitPhi(int p);
+    void visitQuad(size_t q);
+    void visitBlock(int b);
+    void addEdge(int from, int to) { cfgWork.push_back({from, to}); }
+    void rewrite();
+
+    IRProgram& ir;
+    const CFG& cfg;
+    const SSAForm& ssa;
+    std::vector<Lattice> lattice; // SSA值 -> 格值
+    std::vector<char> blockExecutable;
+    std::vector<std::vector<char>> edgeExecutable; // 块 -> 各前驱边是否可执行
+    std::vector<std::vector<int>> users; // SSA值 -> 使用者（>=0 为四元式下标，<0 为 ~phi下标）
+    std::vector<std::pair<int, int>> cfgWork;
+    std::vector<int> ssaWork;
+};
+
+Lattice ConstantPropagation::operandLattice(size_t q, int k) const {
+    Operand o = k == 0 ? ir.arg1[q] : ir.arg2[q];
+    Lattice l;
+    if (o.kind() == OPD_INT) {
+        l.state = LAT_CONST;
+        l.value = ir.intPool[o.index()];
+    } else if (o.kind() == OPD_STR) {
+        l.state = LAT_BOTTOM; // 字符串不参与折叠
+    } else if (o.kind() == OPD_VAR || o.kind() == OPD_TEMP) {
+        l = lattice[ssa.useValue[k][q]];
+    }
+    return l;
+}
+
+// 格值只会沿 TOP -> CONST -> BOTTOM 单调下降
+void ConstantPropagation::update(int value, Lattice l) {
+    Lattice& old = lattice[value];
+    if (old.state == LAT_BOTTOM || l.state == LAT_TOP) return;
+    if (old.state == LAT_CONST && (l.state == LAT_BOTTOM || l.value != old.value)) {
+        old.state = LAT_BOTTOM;
+    } else if (old.state == LAT_TOP) {
+        old = l;
+    } else {
+        return;
+    }
+    ssaWork.push_back(value);
+}
+
+void ConstantPropagation::visitPhi(int p) {
+    const Phi& phi = ssa.phis[p];
+    const std::vector<char>& edges = edgeExecutable[phi.block];
+    for (size_t i = 0; i < phi.operands.size(); ++i) {
+        if (edges.empty() || !edges[i] || phi.operands[i] < 0) continue;
+        update(phi.value, lattice[phi.operands[i]]);
+    }
+}
+
+void ConstantPropagation::visitQuad(size_t q) {
+    OpCode op = ir.ops[q];
+    if (op == OP_LABEL) return;
+    int b = ssa.blockOf[q];
+    if (isJump(op)) {
+        int target = cfg.labelBlock[ir.result[q].index()];
+        int next = b + 1 < (int)cfg.blocks.size() ? b + 1 : -1;
+        if (op == OP_JMP) {
+            addEdge(b, target);
+            return;
+        }
+        Lattice a = operandLattice(q, 0), c = operandLattice(q, 1);
+        if (a.state == LAT_BOTTOM || c.state == LAT_BOTTOM) {
+            addEdge(b, target);
+            if (next >= 0) addEdge(b, next);
+        } else if (a.state == LAT_CONST && c.state == LAT_CONST) {
+            if (branchTaken(op, a.value, c.value)) addEdge(b, target);
+            else if (next >= 0) addEdge(b, next);
+        }
+        return;
+    }
+    int value = ssa.defValue[q];
+    if (value < 0) return;
+    if (op == OP_ASSIGN) {
+        update(value, operandLattice(q, 0));
+        return;
+    }
+    Lattice a = operandLattice(q, 0), c = operandLattice(q, 1);
+    Lattice l;
+    if (a.state == LAT_BOTTOM || c.state == LAT_BOTTOM) {
+        l.state = LAT_BOTTOM;
+    } else if (a.state == LAT_CONST && c.state == LAT_CONST) {
+        l.state = LAT_CONST;
+        l.value = foldBinary(op, a.value, c.value);
+    }
+    update(value, l);
+}
+
+void ConstantPropagation::visitBlock(int b) {
+    for (int p : ssa.blockPhis[b]) visitPhi(p);
+    const BasicBlock& block = cfg.blocks[b];
+    for (size_t q = block.begin; q < block.end; ++q) visitQuad(q);
+    bool endsWithJump = block.end > block.begin && isJump(ir.ops[block.end - 1]);
+    if (!endsWithJump && b + 1 < (int)cfg.blocks.size()) addEdge(b, b + 1);
+}
+
+void ConstantPropagation::run() {
+    users.resize(ssa.values.size());
+    for (size_t q = 0; q < ir.size(); ++q) {
+        if (ssa.blockOf[q] < 0) continue;
+        for (int k = 0; k < 2; ++k) {
+            if (ssa.useValue[k][q] >= 0) users[ssa.useValue[k][q]].push_back(q);
+        }
+    }
+    for (size_t p = 0; p < ssa.phis.size(); ++p) {
+        for (int v : ssa.phis[p].operands) {
+            if (v >= 0) users[v].push_back(~(int)p);
+        }
+    }
+    // 入口处未初始化的值视为未知
+    for (size_t v = 0; v < ssa.values.size(); ++v) {
+        if (ssa.values[v].source == VAL_ENTRY) lattice[v].state = LAT_BOTTOM;
+    }
+
+    blockExecutable[0] = 1;
+    visitBlock(0);
+    while (!cfgWork.empty() || !ssaWork.empty()) {
+        while (!cfgWork.empty()) {
+            std::pair<int, int> edge = cfgWork.back();
+            cfgWork.pop_back();
+            int to = edge.second;
+            const std::vector<int>& preds = cfg.blocks[to].preds;
+            std::vector<char>& edges = edgeExecutable[to];
+            if (edges.empty()) edges.assign(preds.size(), 0);
+            size_t i = std::find(preds.begin(), preds.end(), edge.first) - preds.begin();
+            if (edges[i]) continue;
+            edges[i] = 1;
+            if (!blockExecutable[to]) {
+                blockExecutable[to] = 1;
+                visitBlock(to);
+            } else {
+                for (int p : ssa.blockPhis[to]) visitPhi(p);
+            }
+        }
+        while (!ssaWork.empty()) {
+            int value = ssaWork.back();
+            ssaWork.pop_back();
+            for (int user : users[value]) {
+                if (user < 0) {
+                    if (blockExecutable[ssa.phis[~user].block]) visitPhi(~user);
+                } else if (blockExecutable[ssa.blockOf[user]]) {
+                    visitQuad(user);
+                }
+            }
+        }
+    }
+    rewrite();
+}
+
+void ConstantPropagation::rewrite() {
+    std::vector<char> removed(ir.size(), 0);
+    for (size_t q = 0; q < ir.size(); ++q) {
+        int b = ssa.blockOf[q];
+        if (b < 0 || !blockExecutable[b]) {
+            removed[q] = 1;
+            continue;
+        }
+        OpCode op = ir.ops[q];
+        if (op == OP_LABEL || op == OP_JMP) continue;
+        Lattice a = operandLattice(q, 0), c = operandLattice(q, 1);
+        if (isCondJump(op) && a.state == LAT_CONST && c.state == LAT_CONST) {
+            // 分支方向已确定：成立改为 jmp，不成立直接删除
+            if (branchTaken(op, a.value, c.value)) {
+                ir.ops[q] = OP_JMP;
+                ir.arg1[q] = ir.arg2[q] = Operand();
+            } else {
+                removed[q] = 1;
+            }
+            continue;
+        }
+        int value = ssa.defValue[q];
+        if (value >= 0 && lattice[value].state == LAT_CONST) {
+            ir.ops[q] = OP_ASSIGN;
+            ir.arg1[q] = ir.intConst(lattice[value].value);
+            ir.arg2[q] = Operand();
+            continue;
+        }
+        if (a.state == LAT_CONST) ir.arg1[q] = ir.intConst(a.value);
+        if (c.state == LAT_CONST) ir.arg2[q] = ir.intConst(c.value);
+    }
+    ir.compact(removed);
+    cleanupLabels(ir);
+}
+
+static void runSCCP(IRProgram& ir) {
+    CFG cfg = buildCFG(ir);
+    SSAForm ssa = buildSSA(ir, cfg);
+    ConstantPropagation(ir, cfg, ssa).run();
+}
+
+// ---------------- 复写传播 ----------------
+
+static void runCopyPropagation(IRProgram& ir) {
+    CFG cfg = buildCFG(ir);
+    buildSSA(ir, cfg, true);
+}
+
+// ---------------- 全局值编号 ----------------
+
+// 值编号：>=0 为SSA值，<0 为立即数（-(操作数位模式)-1）
+using ValueNumber = int64_t;
+
+struct ExprKey {
+    OpCode op;
+    ValueNumber a;
+    ValueNumber b;
+    bool operator==(const ExprKey& o) const { return op == o.op && a == o.a && b == o.b; }
+};
+
+struct ExprKeyHash {
+    size_t operator()(const ExprKey& k) const {
+        uint64_t h = k.op;
+        h = h * 0x9E3779B97F4A7C15ull ^ (uint64_t)k.a;
+        h = h * 0x9E3779B97F4A7C15ull ^ (uint64_t)k.b;
+        return h ^ (h >> 29);
+    }
+};
+
+class ValueNumbering {
+public:
+    ValueNumbering(IRProgram& ir, const CFG& cfg, const SSAForm& ssa)
+        : ir(ir), cfg(cfg), ssa(ssa), numbers(ssa.values.size(), UNSET),
+          tempReplace(ir.tempCount - ssa.firstTemp), removed(ir.size(), 0) {}
+
+    void run();
+
+private:
+    static constexpr ValueNumber UNSET = INT64_MIN;
+    ValueNumber operandNumber(size_t q, int k);
+    ValueNumber valueNumber(int value);
+    void visitBlock(int b);
+
+    IRProgram& ir;
+    const CFG& cfg;
+    const SSAForm& ssa;
+    std::vector<ValueNumber> numbers; // SSA值 -> 值编号
+    std::vector<Operand> tempReplace; // 临时变量 -> 替换它的等值临时变量
+    std::vector<char> removed;
+    std::unordered_map<ExprKey, std::pair<Operand, ValueNumber>, ExprKeyHash> available; // 当前支配路径上可用的表达式
+    std::vector<ExprKey> undoLog;
+};
+
+ValueNumber ValueNumbering::operandNumber(size_t q, int k) {
+    Operand o = k == 0 ? ir.arg1[q] : ir.arg2[q];
+    if (o.kind() == OPD_VAR || o.kind() == OPD_TEMP) return valueNumber(ssa.useValue[k][q]);
+    return -(ValueNumber)o.bits - 1;
+}
+
+// 复写得到的值与源操作数同号
+ValueNumber ValueNumbering::valueNumber(int value) {
+    if (numbers[value] != UNSET) return numbers[value];
+    const SSAValue& v = ssa.values[value];
+    ValueNumber n = value;
+    if (v.source == VAL_DEF && ir.ops[v.index] == OP_ASSIGN) n = operandNumber(v.index, 0);
+    numbers[value] = n;
+    return n;
+}
+
+void ValueNumbering::visitBlock(int b) {
+    for (size_t q = cfg.blocks[b].begin; q < cfg.blocks[b].end; ++q) {
+        // 已被消除的临时变量改用等值的临时变量
+        for (Operand* o : {&ir.arg1[q], &ir.arg2[q]}) {
+            if (o->kind() == OPD_TEMP && tempReplace[o->index() - ssa.firstTemp].kind() != OPD_NONE) {
+                *o = tempReplace[o->index() - ssa.firstTemp];
+            }
+        }
+        OpCode op = ir.ops[q];
+        int value = ssa.defValue[q];
+        if (!isBinary(op) || value < 0) continue;
+        ExprKey key{op, operandNumber(q, 0), operandNumber(q, 1)};
+        if ((op == OP_ADD || op == OP_MUL || op == OP_EQ) && key.a > key.b) std::swap(key.a, key.b);
+        auto it = available.find(key);
+        if (it != available.end()) {
+            numbers[value] = it->second.second;
+            if (ir.result[q].kind() == OPD_TEMP) {
+                tempReplace[ir.result[q].index() - ssa.firstTemp] = it->second.first;
+                removed[q] = 1;
+            } else {
+                ir.ops[q] = OP_ASSIGN;
+                ir.arg1[q] = it->second.first;
+                ir.arg2[q] = Operand();
+            }
+        } else if (ir.result[q].kind() == OPD_TEMP) {
+            // 只有临时变量保证不被重新赋值，才能登记为可用
+            available.emplace(key, std::make_pair(ir.result[q], valueNumber(value)));
+            undoLog.push_back(key);
+        }
+    }
+}
+
+void ValueNumbering::run() {
+    std::vector<std::pair<int, size_t>> stack; // (块, 进入时撤销日志长度)，块为 ~b 表示离开
+    stack.push_back({0, 0});
+    while (!stack.empty()) {
+        std::pair<int, size_t> top = stack.back();
+        stack.pop_back();
+        if (top.first < 0) {
+            while (undoLog.size() > top.second) {
+                available.erase(undoLog.back());
+                undoLog.pop_back();
+            }
+            continue;
+        }
+        stack.push_back({~top.first, undoLog.size()});
+        visitBlock(top.first);
+        const std::vector<int>& children = ssa.domChildren[top.first];
+        for (auto it = children.rbegin(); it != children.rend(); ++it) stack.push_back({*it, 0});
+    }
+    ir.compact(removed);
+}
+
+static void runGVN(IRProgram& ir) {
+    CFG cfg = buildCFG(ir);
+    SSAForm ssa = buildSSA(ir, cfg);
+    ValueNumbering(ir, cfg, ssa).run();
+}
+
+// ---------------- 死存储消除 ----------------
+
+// 从条件跳转的操作数和变量终值出发标记活跃的SSA值，删除定义了不活跃值的四元式
+static void runDSE(IRProgram& ir) {
+    CFG cfg = buildCFG(ir);
+    SSAForm ssa = buildSSA(ir, cfg);
+    std::vector<char> live(ssa.values.size(), 0);
+    std::vector<int> work;
+    auto markLive = [&](int v) {
+        if (v >= 0 && !live[v]) {
+            live[v] = 1;
+            work.push_back(v);
+        }
+    };
+    for (size_t q = 0; q < ir.size(); ++q) {
+        if (ssa.blockOf[q] >= 0 && isCondJump(ir.ops[q])) {
+            markLive(ssa.useValue[0][q]);
+            markLive(ssa.useValue[1][q]);
+        }
+    }
+    for (int v : ssa.exitValues) markLive(v);
+    while (!work.empty()) {
+        const SSAValue& v = ssa.values[work.back()];
+        work.pop_back();
+        if (v.source == VAL_DEF) {
+            markLive(ssa.useValue[0][v.index]);
+            markLive(ssa.useValue[1][v.index]);
+        } else if (v.source == VAL_PHI) {
+            for (int operand : ssa.phis[v.index].operands) markLive(operand);
+        }
+    }
+    std::vector<char> removed(ir.size(), 0);
+    for (size_t q = 0; q < ir.size(); ++q) {
+        if (ssa.defValue[q] >= 0 && !live[ssa.defValue[q]]) removed[q] = 1;
+    }
+    ir.compact(removed);
+}
+
+// ---------------- 代数化简 ----------------
+
+// value 为 2^k 时返回 k，否则返回-1
+static int log2Exact(int64_t value) {
+    if (value <= 0 || (value & (value - 1)) != 0) return -1;
+    int k = 0;
+    while (((int64_t)1 << k) != value) ++k;
+    return k;
+}
+
+// 逐条化简：x+0、x-0、x*1 化为复写，x*0、x-x 化为常量，
+// 乘以 2^k 化为左移，乘以 2^k±1 化为左移再加/减
+static void runSimplify(IRProgram& ir) {
+    std::vector<char> removed(ir.size(), 0);
+    std::vector<std::vector<Quadruple>> before(ir.size() + 1);
+    bool inserted = false;
+    for (size_t q = 0; q < ir.size(); ++q) {
+        OpCode op = ir.ops[q];
+        if (!isBinary(op)) continue;
+        Operand a = ir.arg1[q], b = ir.arg2[q];
+        if (op == OP_ADD || op == OP_MUL) {
+            if (a.kind() == OPD_INT) std::swap(a, b); // 常量放到右边
+        }
+        bool constB = b.kind() == OPD_INT;
+        int64_t c = constB ? ir.intPool[b.index()] : 0;
+        bool sameVar = a == b && (a.kind() == OPD_VAR || a.kind() == OPD_TEMP);
+        auto toCopy = [&](Operand src) {
+            ir.ops[q] = OP_ASSIGN;
+            ir.arg1[q] = src;
+            ir.arg2[q] = Operand();
+        };
+        if (a.kind() == OPD_INT && constB) {
+            toCopy(ir.intConst(foldBinary(op, ir.intPool[a.index()], c)));
+        } else if (constB && c == 0 && (op == OP_ADD || op == OP_SUB || op == OP_SHL)) {
+            toCopy(a);
+        } else if (sameVar && (op == OP_SUB || op == OP_LT)) {
+            toCopy(ir.intConst(0));
+        } else if (sameVar && op == OP_EQ) {
+            toCopy(ir.intConst(1));
+        } else if (op == OP_MUL && constB && a.kind() != OPD_STR) {
+            // c±1 按64位回绕计算，c 为 INT64_MIN/INT64_MAX 时不溢出
+            int64_t below = (int64_t)((uint64_t)c - 1), above = (int64_t)((uint64_t)c + 1);
+            if (c == 0) {
+                toCopy(ir.intConst(0));
+            } else if (c == 1) {
+                toCopy(a);
+            } else if (log2Exact(c) > 0) {
+                ir.ops[q] = OP_SHL;
+                ir.arg1[q] = a;
+                ir.arg2[q] = ir.intConst(log2Exact(c));
+            } else if (log2Exact(below) > 0 || log2Exact(above) > 1) {
+                // x*(2^k+1) = (x<<k)+x，x*(2^k-1) = (x<<k)-x
+                bool plus = log2Exact(below) > 0;
+                Operand shifted = Operand::make(OPD_TEMP, ir.tempCount++);
+                before[q].push_back({OP_SHL, a, ir.intConst(log2Exact(plus ? below : above)), shifted});
+                ir.ops[q] = plus ? OP_ADD : OP_SUB;
+                ir.arg1[q] = shifted;
+                ir.arg2[q] = a;
+                inserted = true;
+            }
+        }
+    }
+    if (inserted) ir.splice(removed, before);
+}
+
+// ---------------- 调度 ----------------
+
+std::vector<std::string> passesForLevel(int level) {
+    if (level <= 0) return {};
+    if (level == 1) return {"sccp", "simplify", "copyprop", "dse"};
+    // 强度削弱在代数化简之前，以免乘以 2^k±1 先被拆成移位
+    return {"sccp", "copyprop", "gvn", "licm", "strength", "simplify", "copyprop", "dse"};
+}
+
+bool runPasses(IRProgram& ir, const std::vector<std::string>& passes, std::vector<PassStats>& stats, std::string& error) {
+    for (const std::string& name : passes) {
+        void (*pass)(IRProgram&) = nullptr;
+        if (name == "sccp") pass = runSCCP;
+        else if (name == "copyprop") pass = runCopyPropagation;
+        else if (name == "gvn") pass = runGVN;
+        else if (name == "dse") pass = runDSE;
+        else if (name == "simplify") pass = runSimplify;
+        else if (name == "licm") pass = runLICM;
+        else if (name == "strength") pass = runStrengthReduction;
+        else {
+            error = "未知的优化遍: " + name;
+            return false;
+        }
+        size_t before = ir.size();
+        auto start = std::chrono::steady_clock::now();
+        pass(ir);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        stats.push_back({name, before, ir.size(), ms});
+    }
+    return true;
+}
+
+void writePassStats(const std::vector<PassStats>& stats, std::ostream& out) {
+    out << std::left << std::setw(10) << "遍" << std::right << std::setw(10) << "删除" << std::setw(10) << "剩余"
+        << std::setw(12) << "耗时(ms)" << "\n";
+    for (const PassStats& s : stats) {
+        out << std::left << std::setw(10) << s.name << std::right << std::setw(10) << (long)(s.before - s.after)
+            << std::setw(10) << s.after << std::setw(12) << std::fixed << std::setprecision(3) << s.ms << "\n";
+    }
+}
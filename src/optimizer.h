@@ -0,0 +1,37 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "irgen.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 单个优化遍的统计
+struct PassStats {
+    std::string name;
+    size_t before; // 运行前四元式条数
+    size_t after; // 运行后四元式条数
+    double ms; // 耗时（毫秒）
+};
+
+/** 可用的优化遍：
+ *  sccp     稀疏条件常量传播：常量折叠、确定分支折叠为 jmp、删除不可达块
+ *  copyprop 复写传播：把对 "= a x" 中 x 的使用替换为 a
+ *  gvn      全局值编号：沿支配树消除重复计算的公共子表达式
+ *  dse      死存储消除：删除结果不被使用、也不影响变量终值的四元式
+ *  simplify 代数化简：x+0、x*1 等化为复写，乘以 2^k、2^k±1 化为移位与加减
+ *  licm     循环不变量外提（见 loopopt.h）
+ *  strength 归纳变量强度削弱（见 loopopt.h）
+ */
+
+// 优化级别对应的遍序列：-O0 不优化，-O1 常量/复写传播、代数化简与死存储消除，
+// -O2 在此基础上加入值编号和循环优化
+std::vector<std::string> passesForLevel(int level);
+
+// 按顺序运行指定的优化遍，遇到未知遍名时写入 error 并返回 false
+bool runPasses(IRProgram& ir, const std::vector<std::string>& passes, std::vector<PassStats>& stats, std::string& error);
+
+// 输出各遍删除的四元式条数与耗时
+void writePassStats(const std::vector<PassStats>& stats, std::ostream& out);
+
+#endif
@@ -1,16 +1,167 @@
 #include "parser.h"
+#include "context.h"
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
-#include <memory>
+#include <initializer_list>
 #include <vector>
 #include <string>
 
-static size_t current = 0; // 当前token的索引
-static std::vector<Token> tokens;
-std::vector<ParseError> parseErrors;
+
+const char* nodeKindName(NodeKind kind) {
+    switch (kind) {
+        case NK_PROGRAM: return "Program";
+        case NK_BLOCK: return "Block";
+        case NK_VAR_DECL: return "VarDecl";
+        case NK_IF: return "If";
+        case NK_WHILE: return "While";
+        case NK_ASSIGN: return "Assign";
+        case NK_ADD: return "Add";
+        case NK_SUB: return "Sub";
+        case NK_MUL: return "Mul";
+        case NK_LT: return "Lt";
+        case NK_EQ: return "Eq";
+        case NK_INT: return "Int";
+        case NK_VAR: return "Var";
+        case NK_STR: return "Str";
+    }
+    return "";
+}
+
+const char* typeName(ValueType type) {
+    switch (type) {
+        case TYPE_INT: return "int";
+        case TYPE_STRING: return "String";
+        default: return "";
+    }
+}
+
+const std::string& nodeText(const CompilationContext& ctx, const ASTNode& node) {
+    static const std::string empty;
+    if (node.value < 0) return empty;
+    if (node.kind == NK_INT || node.kind == NK_STR) return ctx.constantTable[node.value];
+    return ctx.identifierTable[node.value];
+}
+
+/* LL(1) 语法分析器，一次 parse 调用对应一个实例；不使用递归，嵌套深度只受内存限制：
+ *   表达式用运算符优先分析，操作数与未归约的运算符、左括号放在显式栈上
+ *   {} 块、if、while 在 frames 中各占一个栈帧，子语句分析完后交回栈顶帧继续
+ * 两者查看token、产生节点与错误的顺序都与等价的递归下降分析相同
+ * 错误恢复（恐慌模式）：语句出错后跳到 ; 之后或 }、语句开头之前，且至少前进一个token，任何输入都在线性时间内结束；
+ * 语法错误超过 MAX_PARSE_ERRORS 个时记一条"语法错误过多"并停止分析，之后的输入视为已结束
+ */
+class Parser {
+public:
+    Parser(CompilationContext& ctx, const std::vector<Token>& tokens, std::vector<ParseError>& errors,
+           std::vector<StatementSpan>* spans = nullptr)
+        : ctx(ctx), tokens(tokens), errors(errors), spans(spans) {}
+    // 流式分析：token从 cursor 按需读入
+    Parser(CompilationContext& ctx, LexerCursor& cursor, std::vector<ParseError>& errors,
+           const StatementHandler& onStatement)
+        : ctx(ctx), tokens(cursor.window), errors(errors), spans(nullptr), cursor(&cursor), onStatement(&onStatement) {}
+
+    NodeId parseMainClass(); // 解析主类（类结构class main)
+    // 增量分析：从 begin 开始分析语句块中的语句序列到 stop 为止，状态恢复为完整分析到达 begin 时的状态
+    bool reparseStatements(size_t begin, size_t stop, uint32_t lookahead, uint32_t firstError,
+                           std::vector<NodeId>& statements);
+
+    AST ast; // 正在构建的语法树
+
+private:
+    bool available() const;
+    void getTokenPos(int& line, int& column) const;
+    void error(const std::string& msg);
+    Token peek() const;
+    bool match(TokenType type, int val = -2);
+    NodeId makeNode(NodeKind kind, int value = -1, int line = 0, std::initializer_list<NodeId> children = {});
+    NodeId makeNodeFromPending(NodeKind kind, size_t mark);
+    uint32_t errorIndex() const { return errors.size() + errorBase; }
+    bool startsStatement(const Token& tk) const;
+    void synchronize(size_t start);
+
+    // 正在分析的 {} 块、if 或 while 语句
+    struct StatementFrame {
+        NodeKind kind; // NK_BLOCK / NK_IF / NK_WHILE
+        uint8_t stage = 0; // If：0 分析 then，1 等待 then，2 分析 else，3 等待 else，4 结束；While：0 分析循环体，1 等待，2 结束
+        bool streamed = false; // Block：子语句逐条交给 onStatement
+        bool sequence = false; // 只是语句序列，没有 {}（增量分析的顶层）
+        size_t stop = SIZE_MAX; // Block：分析到此token为止
+        size_t mark = 0; // Block：子节点在 pendingChildren 中的起始位置
+        NodeId cond = NO_NODE;
+        NodeId thenStmt = NO_NODE; // If 的 then 分支，While 的循环体
+        NodeId elseStmt = NO_NODE;
+        StatementSpan span;
+    };
+
+    NodeId parsePrimary(); // 解析基本因子(整数，标识符，字符串)，括号由 parseExpression 处理
+    NodeId parseExpression(); // 运算符优先分析：* 高于 +、-，高于 <、=，均为左结合
+    void reduce(size_t base, int minPrecedence); // 归约栈顶优先级不低于 minPrecedence 的运算符，遇到左括号为止
+    NodeId parseStatement(); // 解析一条语句（含其中嵌套的全部语句）并记录其 StatementSpan
+    // 解析语句块中的语句序列到 stop 为止，子节点暂存到 pendingChildren
+    void parseStatements(size_t stop);
+    // 开始一条语句：简单语句直接分析完，{}、if、while 压入栈帧后返回 PENDING
+    NodeId beginStatement();
+    // 栈顶帧开始下一条子语句，或已分析完时弹出并返回其节点
+    NodeId advanceFrame();
+    // 分析完的子语句交给栈顶帧
+    void acceptStatement(NodeId stmt);
+    // 反复推进栈帧直到回到 base 层，返回最后分析完的语句
+    NodeId runFrames(size_t base, NodeId stmt);
+    NodeId finishStatement(NodeId id, StatementSpan span);
+
+    CompilationContext& ctx;
+    const std::vector<Token>& tokens;
+    std::vector<ParseError>& errors; // 语法错误的输出位置
+    std::vector<StatementSpan>* spans; // 为空时不记录
+    size_t current = 0; // 当前token的索引
+    mutable uint32_t examined = 0; // 已查看过的token下标上界（不含），分析的每个决定只依赖其前的token
+    uint32_t errorBase = 0; // errors 中第0项在完整分析的错误列表中的下标
+    bool stopped = false; // 错误过多，已停止分析
+    std::vector<NodeId> pendingChildren; // 子节点个数不定的节点（Block）暂存子节点
+    LexerCursor* cursor = nullptr; // 流式分析时 tokens 是 cursor 的窗口
+    const StatementHandler* onStatement = nullptr;
+    bool streamNext = false; // 下一条语句是否直接位于逐条交出的语句块中
+    std::vector<NodeId> operands; // 表达式分析的操作数栈
+    std::vector<int> operators; // 表达式分析的运算符栈，'(' 表示左括号
+    std::vector<StatementFrame> frames;
+};
+
+static const NodeId PENDING = NO_NODE - 3; // 语句尚未分析完，已压入栈帧（与 STREAM_BLOCK_BEGIN/END 区分）
+
+// 二元运算符的优先级，不是二元运算符时为0
+static int precedence(int op) {
+    switch (op) {
+        case '*': return 3;
+        case '+':
+        case '-': return 2;
+        case '<':
+        case '=': return 1;
+    }
+    return 0;
+}
+
+static NodeKind binaryKind(int op) {
+    switch (op) {
+        case '*': return NK_MUL;
+        case '+': return NK_ADD;
+        case '-': return NK_SUB;
+        case '<': return NK_LT;
+    }
+    return NK_EQ;
+}
+
+// 当前位置是否有token，流式分析时按需从 cursor 读入
+bool Parser::available() const {
+    if (stopped) return false;
+    while (current >= tokens.size()) {
+        if (!cursor || !cursor->fill()) return false;
+    }
+    return true;
+}
 
 // 获取当前token的行列号
-static void getTokenPos(int& line, int& column) {
-    if (current < tokens.size() && tokens[current].line > 0) {
+void Parser::getTokenPos(int& line, int& column) const {
+    if (available() && tokens[current].line > 0) {
         line = tokens[current].line;
         column = tokens[current].column;
     } else {
@@ -20,20 +171,28 @@ static void getTokenPos(int& line, int& column) {
 }
 
 // 记录语法错误
-static void error(const std::string& msg) {
+void Parser::error(const std::string& msg) {
+    if (stopped) return;
     int line, column;
     getTokenPos(line, column);
-    parseErrors.push_back({msg, line, column});
+    if (errorIndex() >= MAX_PARSE_ERRORS) {
+        errors.push_back({"语法错误过多，停止分析", line, column});
+        stopped = true;
+        return;
+    }
+    errors.push_back({msg, line, column});
 }
 
 // 查看当前token
-static Token peek() {
-    return current < tokens.size() ? tokens[current] : Token{END_OF_FILE, -1, -1, -1};
+Token Parser::peek() const {
+    examined = std::max(examined, (uint32_t)current + 1);
+    return available() ? tokens[current] : Token{END_OF_FILE, -1, -1, -1};
 }
 
 // 检查当前token是否匹配指定类型和值，传如第二个参数则检查类型和值，不传入则只检查类型
-static bool match(TokenType type, int val = -2) {
-    if (current >= tokens.size()) return false;
+bool Parser::match(TokenType type, int val) {
+    examined = std::max(examined, (uint32_t)current + 1);
+    if (!available()) return false;
     Token tk = tokens[current];
     if (tk.type == type && (val == -2 || val == tk.value)) {
         current++;
@@ -42,173 +201,279 @@ static bool match(TokenType type, int val = -2) {
     return false;
 }
 
-// 创建AST节点
-static ASTPtr makeNode(const std::string& type, const std::string& value = "", int line = 0) {
-    auto node = std::make_shared<ASTNode>();
-    node->type = type;
-    node->value = value;
-    node->line = line;
-    return node;
+// 能否作为一条语句的开头（错误恢复的同步点）：{ 或 if/while/int/String
+bool Parser::startsStatement(const Token& tk) const {
+    if (tk.type == DELIMITER) return tk.value == '{';
+    return tk.type == KEYWORD &&
+           (tk.value == KW_IF || tk.value == KW_WHILE || tk.value == KW_INT || tk.value == KW_STRING);
+}
+
+// 从 start 开始的语句出错后跳过token：停在 ; 之后，或 }、输入结束、start 之后的语句开头之前
+// 除 } 与输入结束外至少前进一个token，外层语句块因此不会在同一位置反复出错
+void Parser::synchronize(size_t start) {
+    while (true) {
+        Token tk = peek();
+        if (tk.type == END_OF_FILE || (tk.type == DELIMITER && tk.value == '}')) return;
+        if (current > start && startsStatement(tk)) return;
+        ++current;
+        if (tk.type == DELIMITER && tk.value == ';') return;
+    }
+}
+
+// 创建AST节点，子节点必须已经解析完毕，直接追加到子节点列表末尾
+NodeId Parser::makeNode(NodeKind kind, int value, int line, std::initializer_list<NodeId> children) {
+    NodeId id = ast.nodes.size();
+    ast.nodes.push_back(
+        {kind, TYPE_UNKNOWN, value, line, (uint32_t)ast.childList.size(), (uint32_t)children.size(), NO_SLOT});
+    ast.childList.insert(ast.childList.end(), children.begin(), children.end());
+    return id;
 }
 
-// 语法分析函数
-ASTPtr parsePrimary(); // 解析基本因子(整数，标识符，字符串，括号表达式)
-ASTPtr parseMul(); // 解析乘法（左结合）
-ASTPtr parseAdd(); // 解析加法（左结合）
-ASTPtr parseRelational(); // 解析关系运算
-ASTPtr parseExpression(); // 解析表达式入口
-ASTPtr parseStatement(); // 解析语句（{} 块语句、int/String声明、if/while、赋值）
-ASTPtr parseMainClass(); // 解析主类（类结构class main)
+// 创建子节点暂存在 pendingChildren[mark..] 中的节点
+NodeId Parser::makeNodeFromPending(NodeKind kind, size_t mark) {
+    NodeId id = makeNode(kind);
+    ast.nodes[id].childCount = pendingChildren.size() - mark;
+    ast.childList.insert(ast.childList.end(), pendingChildren.begin() + mark, pendingChildren.end());
+    pendingChildren.resize(mark);
+    return id;
+}
 
-ASTPtr parsePrimary() {
+NodeId Parser::parsePrimary() {
     Token tk = peek();
     if (tk.type == INTEGER_LITERAL) {
         // 整数
         current++;
-        return makeNode("Int", constantTable[tk.value], tk.line);
+        return makeNode(NK_INT, tk.value, tk.line);
     } else if (tk.type == IDENTIFIER) {
         // 标识符
         current++;
-        return makeNode("Var", identifierTable[tk.value], tk.line);
+        return makeNode(NK_VAR, tk.value, tk.line);
     } else if (tk.type == STRING_LITERAL) {
         // 字符串
         current++;
-        return makeNode("Str", constantTable[tk.value], tk.line);
-    } else if (tk.type == DELIMITER && tk.value == '(') {
-        // 括号表达式
-        match(DELIMITER, '(');
-        auto expr = parseExpression();
-        if (!match(DELIMITER, ')')) error("表达式缺少 )");
-        return expr;
+        return makeNode(NK_STR, tk.value, tk.line);
     } else {
         error("无法识别的表达式");
-        return nullptr;
+        return NO_NODE;
     }
 }
 
-ASTPtr parseMul() {
-    auto left = parsePrimary();
-    while (peek().type == OPERATOR && peek().value == '*') {
-        match(OPERATOR, '*');
-        auto right = parsePrimary();
-        auto node = makeNode("Mul");
-        node->children.push_back(left);
-        node->children.push_back(right);
-        left = node;
+void Parser::reduce(size_t base, int minPrecedence) {
+    while (operators.size() > base && operators.back() != '(' && precedence(operators.back()) >= minPrecedence) {
+        NodeKind kind = binaryKind(operators.back());
+        operators.pop_back();
+        NodeId right = operands.back();
+        operands.pop_back();
+        NodeId left = operands.back();
+        operands.pop_back();
+        operands.push_back(makeNode(kind, -1, 0, {left, right}));
     }
-    return left;
 }
 
-ASTPtr parseAdd() {
-    auto left = parseMul();
-    while (peek().type == OPERATOR && (peek().value == '+' || peek().value == '-')) {
-        int op = peek().value;
-        match(OPERATOR, op);
-        auto right = parseMul();
-        auto node = makeNode(op == '+' ? "Add" : "Sub");
-        node->children.push_back(left);
-        node->children.push_back(right);
-        left = node;
+NodeId Parser::parseExpression() {
+    size_t base = operators.size();
+    while (true) {
+        // 期待操作数：左括号入栈，否则读入一个基本因子
+        if (peek().type == DELIMITER && peek().value == '(') {
+            match(DELIMITER, '(');
+            operators.push_back('(');
+            continue;
+        }
+        operands.push_back(parsePrimary());
+        // 期待运算符：遇到二元运算符先归约优先级不低于它的运算符再入栈，否则结束一层括号或整个表达式
+        while (true) {
+            Token tk = peek();
+            int prec = tk.type == OPERATOR ? precedence(tk.value) : 0;
+            if (prec > 0) {
+                reduce(base, prec);
+                match(OPERATOR, tk.value);
+                operators.push_back(tk.value);
+                break;
+            }
+            reduce(base, 1);
+            if (operators.size() == base) {
+                NodeId expr = operands.back();
+                operands.pop_back();
+                return expr;
+            }
+            operators.pop_back(); // 括号表达式结束
+            if (!match(DELIMITER, ')')) error("表达式缺少 )");
+        }
     }
-    return left;
 }
 
-ASTPtr parseRelational() {
-    auto left = parseAdd();
-    while (peek().type == OPERATOR && (peek().value == '<' || peek().value == '=')) {
-        int op = peek().value;
-        match(OPERATOR, op);
-        auto right = parseAdd();
-        auto node = makeNode(op == '<' ? "Lt" : "Eq");
-        node->children.push_back(left);
-        node->children.push_back(right);
-        left = node;
+NodeId Parser::finishStatement(NodeId id, StatementSpan span) {
+    if (spans && id != NO_NODE) {
+        span.endToken = current;
+        span.lookahead = examined;
+        span.endError = errorIndex();
+        spans->resize(ast.nodes.size());
+        (*spans)[id] = span;
     }
-    return left;
+    return id;
 }
 
-ASTPtr parseExpression() {
-    return parseRelational();
+NodeId Parser::parseStatement() {
+    size_t base = frames.size();
+    return runFrames(base, beginStatement());
 }
 
-ASTPtr parseStatement() {
-    if (match(DELIMITER, '{')) {
-        auto block = makeNode("Block");
-        while (!match(DELIMITER, '}')) {
-            auto stmt = parseStatement();
-            if (stmt) block->children.push_back(stmt);
-        }
-        return block;
+void Parser::parseStatements(size_t stop) {
+    size_t base = frames.size();
+    StatementFrame frame;
+    frame.kind = NK_BLOCK;
+    frame.sequence = true;
+    frame.stop = stop;
+    frame.mark = pendingChildren.size();
+    frames.push_back(frame);
+    runFrames(base, PENDING);
+}
+
+NodeId Parser::runFrames(size_t base, NodeId stmt) {
+    while (frames.size() > base) {
+        if (stmt != PENDING) acceptStatement(stmt);
+        stmt = advanceFrame();
     }
-    // int 类型变量声明
-    else if (match(KEYWORD, KW_INT)) {
-        if (!match(IDENTIFIER)) {
-            error("变量声明缺少标识符");
-            return nullptr;
-        }
-        int declLine = tokens[current - 1].line;
-        std::string varName = identifierTable[tokens[current - 1].value];
-        auto decl = makeNode("VarDecl", varName, declLine); // value=变量名
-        decl->varType = "int";
-        if (match(OPERATOR, '=')) {
-            decl->children.push_back(parseExpression());
-        }
-        if (!match(DELIMITER, ';')) error("变量声明缺少分号");
-        return decl;
+    return stmt;
+}
+
+NodeId Parser::beginStatement() {
+    StatementSpan span;
+    span.firstToken = current;
+    span.firstError = errorIndex();
+    bool streamed = streamNext;
+    streamNext = false;
+    StatementFrame frame;
+    frame.span = span;
+    if (match(DELIMITER, '{')) {
+        frame.kind = NK_BLOCK;
+        frame.streamed = streamed;
+        frame.mark = pendingChildren.size();
+        frames.push_back(frame);
+        if (streamed) (*onStatement)(ast, STREAM_BLOCK_BEGIN);
+        return PENDING;
     }
-    // String 类型变量声明
-    else if (match(KEYWORD, KW_STRING)) {
+    // int / String 类型变量声明
+    else if (match(KEYWORD, KW_INT) || match(KEYWORD, KW_STRING)) {
+        ValueType declType = tokens[current - 1].value == KW_INT ? TYPE_INT : TYPE_STRING;
         if (!match(IDENTIFIER)) {
             error("变量声明缺少标识符");
-            return nullptr;
+            synchronize(span.firstToken);
+            return NO_NODE;
         }
         int declLine = tokens[current - 1].line;
-        std::string varName = identifierTable[tokens[current - 1].value];
-        auto decl = makeNode("VarDecl", varName, declLine);
-        decl->varType = "String";
+        int varId = tokens[current - 1].value;
+        NodeId decl;
         if (match(OPERATOR, '=')) {
-            decl->children.push_back(parseExpression());
+            NodeId init = parseExpression();
+            decl = makeNode(NK_VAR_DECL, varId, declLine, {init}); // value=变量名
+        } else {
+            decl = makeNode(NK_VAR_DECL, varId, declLine);
         }
+        ast.nodes[decl].varType = declType;
         if (!match(DELIMITER, ';')) error("变量声明缺少分号");
-        return decl;
+        return finishStatement(decl, span);
     }
     else if (match(KEYWORD)) {
         Token tk = tokens[current - 1];
-        if (tk.value == KW_IF) {
-            // 解析 if 语句
-            auto ifNode = makeNode("If");
-            match(DELIMITER, '(');
-            ifNode->children.push_back(parseExpression());
-            match(DELIMITER, ')');
-            ifNode->children.push_back(parseStatement());
-            if (!match(KEYWORD) || tokens[current - 1].value != KW_ELSE) error("缺少 else");
-            ifNode->children.push_back(parseStatement());
-            return ifNode;
-        } else if (tk.value == KW_WHILE) {
-            // 解析 while 语句
-            auto whNode = makeNode("While");
-            match(DELIMITER, '(');
-            whNode->children.push_back(parseExpression());
-            match(DELIMITER, ')');
-            whNode->children.push_back(parseStatement());
-            return whNode;
+        if (tk.value == KW_IF || tk.value == KW_WHILE) {
+            // if/while 的条件，then 分支或循环体由栈帧继续分析
+            if (!match(DELIMITER, '(')) error("条件缺少 (");
+            frame.kind = tk.value == KW_IF ? NK_IF : NK_WHILE;
+            frame.cond = parseExpression();
+            if (!match(DELIMITER, ')')) error("条件缺少 )");
+            frames.push_back(frame);
+            return PENDING;
         }
     } else if (match(IDENTIFIER)) {
         // 解析赋值语句
         int assignLine = tokens[current - 1].line;
-        std::string varName = identifierTable[tokens[current - 1].value];
+        int varId = tokens[current - 1].value;
         if (match(OPERATOR, '=')) {
-            auto assign = makeNode("Assign", varName, assignLine);
-            assign->children.push_back(parseExpression());
-            match(DELIMITER, ';');
-            return assign;
+            NodeId rhs = parseExpression();
+            if (!match(DELIMITER, ';')) error("赋值语句缺少分号");
+            return finishStatement(makeNode(NK_ASSIGN, varId, assignLine, {rhs}), span);
         }
     }
     error("无法解析的语句");
-    return nullptr;
+    synchronize(span.firstToken);
+    return NO_NODE;
+}
+
+NodeId Parser::advanceFrame() {
+    StatementFrame& frame = frames.back();
+    NodeId id = NO_NODE;
+    switch (frame.kind) {
+        case NK_BLOCK:
+            if (current < frame.stop) {
+                Token tk = peek();
+                if (tk.type == END_OF_FILE) {
+                    // 输入在语句块中结束：再分析下去不会前进
+                    error("语句块缺少 }");
+                } else if (tk.type != DELIMITER || tk.value != '}') {
+                    streamNext = frame.streamed;
+                    return beginStatement();
+                }
+            }
+            if (frame.sequence) {
+                frames.pop_back();
+                return PENDING;
+            }
+            match(DELIMITER, '}');
+            if (frame.streamed) (*onStatement)(ast, STREAM_BLOCK_END);
+            id = makeNodeFromPending(NK_BLOCK, frame.mark);
+            break;
+        case NK_IF:
+            if (frame.stage == 2) {
+                // 缺少 else 时没有 else 分支，当前token留给下一条语句
+                Token tk = peek();
+                if (tk.type == KEYWORD && tk.value == KW_ELSE) {
+                    ++current;
+                } else {
+                    error("缺少 else");
+                    frame.stage = 4;
+                }
+            }
+            if (frame.stage == 0 || frame.stage == 2) {
+                ++frame.stage;
+                return beginStatement();
+            }
+            id = makeNode(NK_IF, -1, 0, {frame.cond, frame.thenStmt, frame.elseStmt});
+            break;
+        case NK_WHILE:
+            if (frame.stage == 0) {
+                ++frame.stage;
+                return beginStatement();
+            }
+            id = makeNode(NK_WHILE, -1, 0, {frame.cond, frame.thenStmt});
+            break;
+        default:
+            break;
+    }
+    StatementSpan span = frame.span;
+    frames.pop_back();
+    return finishStatement(id, span);
+}
+
+void Parser::acceptStatement(NodeId stmt) {
+    StatementFrame& frame = frames.back();
+    if (frame.kind != NK_BLOCK) {
+        if (frame.kind == NK_IF && frame.stage == 3) frame.elseStmt = stmt;
+        else frame.thenStmt = stmt;
+        ++frame.stage;
+    } else if (frame.streamed) {
+        // 直接嵌套的语句块已逐条交出了子语句；交出后释放这条语句的节点与用过的token
+        if (stmt != NO_NODE && ast[stmt].kind != NK_BLOCK) (*onStatement)(ast, stmt);
+        ast.reset();
+        cursor->discard(current);
+        current = 0;
+        examined = 0;
+    } else if (stmt != NO_NODE) {
+        pendingChildren.push_back(stmt);
+    }
 }
 
-ASTPtr parseMainClass() {
+NodeId Parser::parseMainClass() {
     if (!match(KEYWORD)) error("缺少 class");
     if (!match(IDENTIFIER)) error("缺少类名");
     if (!match(DELIMITER, '{')) error("缺少类 { 开始");
@@ -221,28 +486,66 @@ ASTPtr parseMainClass() {
     match(IDENTIFIER); // args
     match(DELIMITER, ')');
 
-    auto mainBody = parseStatement();
+    streamNext = cursor != nullptr;
+    NodeId mainBody = parseStatement();
 
     if (!match(DELIMITER, '}')) error("缺少类 } 结束");
 
-    auto root = makeNode("Program");
-    root->children.push_back(mainBody);
-    return root;
+    return makeNode(NK_PROGRAM, -1, 0, {mainBody});
+}
+
+bool Parser::reparseStatements(size_t begin, size_t stop, uint32_t lookahead, uint32_t firstError,
+                               std::vector<NodeId>& statements) {
+    current = begin;
+    examined = lookahead;
+    errorBase = firstError;
+    parseStatements(stop);
+    statements.swap(pendingChildren);
+    pendingChildren.clear();
+    return current == stop;
+}
+
+AST parse(CompilationContext& ctx, const std::vector<Token>& tokens) {
+    ctx.parseErrors.clear();
+    Parser parser(ctx, tokens, ctx.parseErrors);
+    parser.ast.root = parser.parseMainClass();
+    return std::move(parser.ast);
+}
+
+AST parse(CompilationContext& ctx, const std::vector<Token>& tokens, std::vector<StatementSpan>& spans) {
+    ctx.parseErrors.clear();
+    spans.clear();
+    Parser parser(ctx, tokens, ctx.parseErrors, &spans);
+    NodeId root = parser.parseMainClass();
+    spans.resize(parser.ast.nodes.size());
+    spans[root] = {0, (uint32_t)tokens.size(), (uint32_t)tokens.size(), 0, (uint32_t)ctx.parseErrors.size()};
+    parser.ast.root = root;
+    return std::move(parser.ast);
+}
+
+void parseStream(CompilationContext& ctx, LexerCursor& cursor, const StatementHandler& onStatement) {
+    ctx.parseErrors.clear();
+    Parser parser(ctx, cursor, ctx.parseErrors, onStatement);
+    parser.parseMainClass();
 }
 
-ASTPtr parse(const std::vector<Token>& tks) {
-    tokens = tks;
-    current = 0;
-    parseErrors.clear();
-    return parseMainClass();
+bool reparseStatements(CompilationContext& ctx, const std::vector<Token>& tokens, size_t begin, size_t stop,
+                       uint32_t lookahead, uint32_t firstError, AST& ast, std::vector<StatementSpan>& spans,
+                       std::vector<ParseError>& errors, std::vector<NodeId>& statements) {
+    Parser parser(ctx, tokens, errors, &spans);
+    parser.ast = std::move(ast);
+    bool exact = parser.reparseStatements(begin, stop, lookahead, firstError, statements);
+    ast = std::move(parser.ast);
+    spans.resize(ast.nodes.size());
+    return exact;
 }
 
 // 打印错误
-void printParseErrors() {
-    for (const auto& err : parseErrors) {
-        std::cerr << "[语法错误] " << err.message;
+void printParseErrors(const CompilationContext& ctx) {
+    for (const auto& err : ctx.parseErrors) {
+        *ctx.diagnostics << "[语法错误] " << err.message;
         if (err.line > 0)
-            std::cerr << " (行: " << err.line << ", 列: " << err.column << ")";
-        std::cerr << std::endl;
+            *ctx.diagnostics << " (行: " << err.line << ", 列: " << err.column << ")";
+        *ctx.diagnostics << std::endl;
     }
 }
\ No newline at end of file
@@ -2,16 +2,66 @@
 #define PARSER_H
 
 #include "lex.h"
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <string>
-#include <memory>
+
+// 节点种类
+enum NodeKind : uint8_t {
+    NK_PROGRAM,  // 程序根节点
+    NK_BLOCK,    // {} 语句块
+    NK_VAR_DECL, // 变量声明
+    NK_IF,       // if 语句
+    NK_WHILE,    // while 语句
+    NK_ASSIGN,   // 赋值语句
+    NK_ADD,      // +
+    NK_SUB,      // -
+    NK_MUL,      // *
+    NK_LT,       // <
+    NK_EQ,       // =
+    NK_INT,      // 整数常量
+    NK_VAR,      // 变量引用
+    NK_STR       // 字符串常量
+};
+
+// 值类型
+enum ValueType : uint8_t {
+    TYPE_UNKNOWN, // 未知（如未定义变量）
+    TYPE_INT,
+    TYPE_STRING
+};
+
+using NodeId = uint32_t;
+const NodeId NO_NODE = UINT32_MAX; // 空节点（语法错误时可能出现）
+const uint32_t NO_SLOT = UINT32_MAX; // 尚未经过语义分析的名字解析
 
 struct ASTNode {
-    std::string type; // 节点类型（如 Program, VarDecl, If, While, Assign 等）
-    std::string value; // 节点值（如变量名、常量值等）
-    std::string varType; // 变量类型（如 int, String）
-    int line = 0; // 行号
-    std::vector<std::shared_ptr<ASTNode>> children;  // 子节点列表
+    NodeKind kind; // 节点种类
+    ValueType varType; // 变量类型（仅 VarDecl 使用）
+    int value; // 驻留符号id：Var/Assign/VarDecl 指向 identifierTable，Int/Str 指向 constantTable，其余为-1
+    int line; // 行号
+    uint32_t firstChild; // 子节点在 AST::childList 中的起始下标
+    uint32_t childCount; // 子节点个数
+    uint32_t slot; // 变量槽位（IR 中 OPD_VAR 的下标）：Var/Assign/VarDecl 由语义分析解析到所指的声明后填入，未声明的名字与其余节点为 NO_SLOT
+};
+
+// 抽象语法树：节点与子节点列表各自连续存放，整棵树通过 reset() 一次性释放
+struct AST {
+    std::vector<ASTNode> nodes; // 节点池，NodeId 即下标
+    std::vector<NodeId> childList; // 所有节点的子节点id，每个节点占一段连续区间
+    NodeId root = NO_NODE;
+
+    const ASTNode& operator[](NodeId id) const { return nodes[id]; }
+    NodeId child(const ASTNode& node, uint32_t i) const { return childList[node.firstChild + i]; }
+    const NodeId* childBegin(const ASTNode& node) const { return childList.data() + node.firstChild; }
+    const NodeId* childEnd(const ASTNode& node) const { return childList.data() + node.firstChild + node.childCount; }
+    // 清空整棵树，保留已分配的容量供下次复用
+    void reset() {
+        nodes.clear();
+        childList.clear();
+        root = NO_NODE;
+    }
 };
 
 // 错误信息结构体
@@ -21,10 +71,54 @@ struct ParseError {
     int column;
 };
 
-using ASTPtr = std::shared_ptr<ASTNode>;
+// 节点种类名（如 "Program", "VarDecl", "Add"）
+const char* nodeKindName(NodeKind kind);
+
+// 类型名（"int" / "String"）
+const char* typeName(ValueType type);
+
+// 节点携带的符号文本（变量名或常量值），无符号时为空
+const std::string& nodeText(const CompilationContext& ctx, const ASTNode& node);
+
+// 语句节点在完整分析中的位置与状态，增量分析据此判断一段token能否单独重新分析
+const uint32_t NO_SPAN = UINT32_MAX;
+struct StatementSpan {
+    uint32_t firstToken = NO_SPAN; // 语句的第一个token，非语句节点为 NO_SPAN
+    uint32_t endToken = 0; // 语句之后的第一个token
+    uint32_t lookahead = 0; // 分析完本语句时已查看过的token下标上界（不含）
+    uint32_t firstError = 0; // 分析本语句期间产生的语法错误在 ctx.parseErrors 中的区间
+    uint32_t endError = 0;
+};
+
+// 最多记录的语法错误数，再出错时记一条"语法错误过多"并停止分析
+const size_t MAX_PARSE_ERRORS = 100;
+
+// 语法错误记录在 ctx.parseErrors 中，出错的语句跳过后继续分析，任何输入都在线性时间内结束
+AST parse(CompilationContext& ctx, const std::vector<Token>& tokens);
+
+// 流式分析中每分析完一条语句调用一次，回调返回后这条语句的节点即被释放；
+// 逐条交出的语句块开始与结束时 stmt 分别为 STREAM_BLOCK_BEGIN 与 STREAM_BLOCK_END，供语义分析进出作用域
+const NodeId STREAM_BLOCK_BEGIN = NO_NODE - 1;
+const NodeId STREAM_BLOCK_END = NO_NODE - 2;
+using StatementHandler = std::function<void(AST& ast, NodeId stmt)>;
+
+/* 流式语法分析：从 cursor 按需读取token，main 语句块中每分析完一条语句就交给 onStatement，
+ * 随后释放其节点并丢弃用过的token，内存只与单条语句的大小有关；直接嵌套的语句块展开为其中的语句逐条交出，
+ * 交出的语句依次与完整分析的结果相同，语法错误记录在 ctx.parseErrors 中
+ */
+void parseStream(CompilationContext& ctx, LexerCursor& cursor, const StatementHandler& onStatement);
+
+// 同上，另外按 NodeId 记录每个语句节点（Block/VarDecl/If/While/Assign 与 Program）的 StatementSpan
+AST parse(CompilationContext& ctx, const std::vector<Token>& tokens, std::vector<StatementSpan>& spans);
 
-ASTPtr parse(const std::vector<Token>& tokens);
+/* 增量分析：在语句块中从 tokens[begin] 重新分析语句序列，到 stop 或语句块结束为止
+ * lookahead、firstError 为完整分析到达 begin 时已查看的token上界和已产生的错误数
+ * 新节点追加到 ast 末尾，新语法错误追加到 errors，得到的语句（不含分析失败的）存入 statements
+ * 恰好停在 stop 时返回true，此时结果与完整分析中这一段的结果相同
+ */
+bool reparseStatements(CompilationContext& ctx, const std::vector<Token>& tokens, size_t begin, size_t stop,
+                       uint32_t lookahead, uint32_t firstError, AST& ast, std::vector<StatementSpan>& spans,
+                       std::vector<ParseError>& errors, std::vector<NodeId>& statements);
 
-void printParseErrors();
-extern std::vector<ParseError> parseErrors;
-#endif
\ No newline at end of file
+void printParseErrors(const CompilationContext& ctx);
+#endif
@@ -0,0 +1,182 @@
+#include "regalloc.h"
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <queue>
+
+/** 活跃区间计算：
+ * 1.逐块扫描，记录每个虚拟寄存器的定义块和"向上暴露"的使用（块内先于定义的使用）
+ * 2.按虚拟寄存器逐个从向上暴露的使用所在块沿前驱反向传播，直到遇到定义块，得到活跃块集合
+ * 3.区间取所有出现位置、活跃块入口和前驱块出口的外包，区间内的空洞不再细分
+ * 活到程序结束的变量在长程序中会覆盖大量块，逐块传播为平方复杂度：
+ * 单个虚拟寄存器访问的块数超过上限时，改用"反向可达的所有块"的外包作为保守区间
+ * 线性扫描（Poletto & Sarkar）：按起点排序，寄存器不够时溢出终点最远的区间
+ */
+
+// 单个虚拟寄存器逐块传播活跃性时最多访问的块数
+static const int PROPAGATION_LIMIT = 256;
+
+RegisterAllocation allocateRegisters(const IRProgram& ir, const CFG& cfg, int registerCount,
+                                     const std::vector<int>& exitVars) {
+    RegisterAllocation alloc;
+    size_t n = ir.size();
+    alloc.varSlots = ir.context->slotCount();
+    alloc.firstTemp = ir.tempCount;
+    for (size_t q = 0; q < n; ++q) {
+        for (Operand o : {ir.arg1[q], ir.arg2[q], ir.result[q]}) {
+            if (o.kind() == OPD_TEMP) alloc.firstTemp = std::min<int>(alloc.firstTemp, o.index());
+        }
+    }
+    int vregCount = alloc.varSlots + ir.tempCount - alloc.firstTemp;
+    std::vector<int> start(vregCount, INT_MAX), end(vregCount, -1);
+    auto extend = [&](int v, int pos) {
+        start[v] = std::min(start[v], pos);
+        end[v] = std::max(end[v], pos);
+    };
+
+    // 逐块收集定义与向上暴露的使用
+    std::vector<std::pair<int, int>> defs, exposed; // (虚拟寄存器, 块)
+    std::vector<int> definedIn(vregCount, -1), exposedIn(vregCount, -1);
+    auto use = [&](int v, int b, int pos) {
+        if (v < 0) return;
+        extend(v, pos);
+        if (definedIn[v] != b && exposedIn[v] != b) {
+            exposedIn[v] = b;
+            exposed.push_back({v, b});
+        }
+    };
+    for (size_t b = 0; b < cfg.blocks.size(); ++b) {
+        for (size_t q = cfg.blocks[b].begin; q < cfg.blocks[b].end; ++q) {
+            if (ir.ops[q] == OP_LABEL) continue;
+            use(alloc.vregOf(ir.arg1[q]), b, 2 * q);
+            use(alloc.vregOf(ir.arg2[q]), b, 2 * q);
+            if (isJump(ir.ops[q])) continue;
+            int v = alloc.vregOf(ir.result[q]);
+            if (v < 0) continue;
+            extend(v, 2 * q + 1);
+            if (definedIn[v] != (int)b) {
+                definedIn[v] = b;
+                defs.push_back({v, (int)b});
+            }
+        }
+    }
+    // 程序从最后一个块末尾（末尾不是 jmp）结束，结束时读取 exitVars
+    int exitBlock = cfg.blocks.size() - 1;
+    const BasicBlock& last = cfg.blocks[exitBlock];
+    if (last.end == last.begin || ir.ops[last.end - 1] != OP_JMP) {
+        for (int v : exitVars) use(v, exitBlock, 2 * n);
+    }
+
+    // 每个块反向可达（沿前驱）的所有块的最小起点与最大终点
+    size_t blockCount = cfg.blocks.size();
+    std::vector<int> reachStart(blockCount), reachEnd(blockCount);
+    for (size_t b = 0; b < blockCount; ++b) {
+        reachStart[b] = 2 * cfg.blocks[b].begin;
+        reachEnd[b] = 2 * cfg.blocks[b].end - 1;
+    }
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t b = 0; b < blockCount; ++b) {
+            for (int p : cfg.blocks[b].preds) {
+                if (reachStart[p] < reachStart[b] || reachEnd[p] > reachEnd[b]) {
+                    reachStart[b] = std::min(reachStart[b], reachStart[p]);
+                    reachEnd[b] = std::max(reachEnd[b], reachEnd[p]);
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // 沿前驱反向传播活跃性
+    std::sort(defs.begin(), defs.end());
+    std::sort(exposed.begin(), exposed.end());
+    std::vector<int> defStamp(cfg.blocks.size(), -1), liveInStamp(cfg.blocks.size(), -1);
+    std::vector<int> work;
+    size_t d = 0;
+    for (size_t e = 0; e < exposed.size();) {
+        int v = exposed[e].first;
+        while (d < defs.size() && defs[d].first < v) ++d;
+        for (; d < defs.size() && defs[d].first == v; ++d) defStamp[defs[d].second] = v;
+        work.clear();
+        size_t seedBegin = e;
+        for (; e < exposed.size() && exposed[e].first == v; ++e) work.push_back(exposed[e].second);
+        int visited = 0;
+        while (!work.empty()) {
+            int b = work.back();
+            work.pop_back();
+            if (liveInStamp[b] == v) continue;
+            if (++visited > PROPAGATION_LIMIT) {
+                for (size_t s = seedBegin; s < e; ++s) {
+                    extend(v, reachStart[exposed[s].second]);
+                    extend(v, reachEnd[exposed[s].second]);
+                }
+                break;
+            }
+            liveInStamp[b] = v;
+            extend(v, 2 * cfg.blocks[b].begin);
+            for (int p : cfg.blocks[b].preds) {
+                extend(v, 2 * cfg.blocks[p].end - 1);
+                if (defStamp[p] != v && liveInStamp[p] != v) work.push_back(p);
+            }
+        }
+    }
+
+    // 线性扫描；区间从位置0开始的可能在入口处活跃，一律清零
+    std::vector<int> order;
+    for (int v = 0; v < vregCount; ++v) {
+        if (start[v] != INT_MAX) order.push_back(v);
+        if (start[v] <= 0) alloc.liveAtEntry.push_back(v);
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return start[a] < start[b]; });
+    alloc.location.assign(vregCount, RegisterAllocation::NO_LOCATION);
+    std::vector<int> active; // 占用寄存器的虚拟寄存器
+    std::vector<int> freeRegs;
+    for (int r = registerCount - 1; r >= 0; --r) freeRegs.push_back(r);
+    // 溢出槽按 (最后一个占用区间的终点, 槽) 管理：spilled 为占用中的槽，freeSlots 为已空出的槽
+    using SlotUse = std::pair<int, int>;
+    std::priority_queue<SlotUse, std::vector<SlotUse>, std::greater<SlotUse>> spilled, freeSlots;
+    // 槽必须在 v 的整个区间内空闲：空出的槽中终点最早的也不早于 v 的起点时另开新槽
+    auto spillTo = [&](int v) {
+        int slot;
+        if (!freeSlots.empty() && freeSlots.top().first < start[v]) {
+            slot = freeSlots.top().second;
+            freeSlots.pop();
+        } else {
+            slot = alloc.spillSlots++;
+        }
+        alloc.location[v] = ~slot;
+        spilled.push({end[v], slot});
+    };
+    for (int v : order) {
+        for (size_t i = 0; i < active.size();) {
+            if (end[active[i]] < start[v]) {
+                freeRegs.push_back(alloc.location[active[i]]);
+                active[i] = active.back();
+                active.pop_back();
+            } else {
+                ++i;
+            }
+        }
+        while (!spilled.empty() && spilled.top().first < start[v]) {
+            freeSlots.push(spilled.top());
+            spilled.pop();
+        }
+        if (!freeRegs.empty()) {
+            alloc.location[v] = freeRegs.back();
+            freeRegs.pop_back();
+            active.push_back(v);
+            continue;
+        }
+        auto farthest = std::max_element(active.begin(), active.end(), [&](int a, int b) { return end[a] < end[b]; });
+        if (farthest != active.end() && end[*farthest] > end[v]) {
+            // 抢占终点更远的区间的寄存器，被抢者整个区间改用溢出槽
+            int victim = *farthest;
+            alloc.location[v] = alloc.location[victim];
+            *farthest = v;
+            spillTo(victim);
+        } else {
+            spillTo(v);
+        }
+    }
+    return alloc;
+}
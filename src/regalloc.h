@@ -0,0 +1,34 @@
+#ifndef REGALLOC_H
+#define REGALLOC_H
+
+#include "cfg.h"
+#include <vector>
+
+/** 寄存器分配：
+ * 变量和临时变量统一编号为虚拟寄存器（变量为其槽位，临时变量 t(firstTemp + k) 为 varSlots + k），
+ * 逐块做活跃分析得到每个虚拟寄存器的活跃区间，再用线性扫描分配物理寄存器，分不到的溢出到栈槽
+ */
+
+// 位置编号：四元式 q 读操作数在 2q，写结果在 2q+1，程序结束在 2*size()
+struct RegisterAllocation {
+    int varSlots = 0;
+    int firstTemp = 0;
+    std::vector<int> location; // 虚拟寄存器 -> >=0 为物理寄存器编号，<0 为溢出槽 ~slot，NO_LOCATION 表示未出现
+    std::vector<int> liveAtEntry; // 可能在入口处活跃（先读后写）的虚拟寄存器，需要清零
+    int spillSlots = 0; // 溢出槽个数
+
+    static constexpr int NO_LOCATION = -0x7fffffff;
+
+    // 操作数对应的虚拟寄存器，不是变量/临时变量时为-1
+    int vregOf(Operand o) const {
+        if (o.kind() == OPD_VAR) return o.index();
+        if (o.kind() == OPD_TEMP) return varSlots + (o.index() - firstTemp);
+        return -1;
+    }
+};
+
+// exitVars 为程序结束时仍要读取的变量（如需要输出终值的源程序变量）
+RegisterAllocation allocateRegisters(const IRProgram& ir, const CFG& cfg, int registerCount,
+                                     const std::vector<int>& exitVars);
+
+#endif
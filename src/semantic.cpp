@@ -1,53 +1,183 @@
 #include "semantic.h"
-#include <iostream>
-#include <unordered_map>
-#include <functional>
-
-bool checkSemantics(const ASTPtr& root) {
-    std::unordered_map<std::string, std::string> symbolTable;
-
-    // 表达式类型推断
-    std::function<std::string(const ASTPtr&)> exprType = [&](const ASTPtr& node) -> std::string {
-        if (!node) return "";
-        if (node->type == "Int") return "int";
-        if (node->type == "Str") return "String";
-        if (node->type == "Var") {
-            if (symbolTable.count(node->value)) return symbolTable[node->value];
-            return "";
-        }
-        if (node->type == "Add" || node->type == "Sub" || node->type == "Mul" ||
-            node->type == "Lt" || node->type == "Eq") {
-            return "int";
+#include "context.h"
+#include <vector>
+
+// 语义检查器：按节点种类 switch 分派，先解析名字再检查类型，类型用 ValueType 表示
+class SemanticChecker {
+public:
+    SemanticChecker(CompilationContext& ctx, AST& ast, SymbolTable& symbols) : ctx(ctx), ast(ast), symbols(symbols) {}
+
+    // 先序遍历 id 为根的子树，用显式栈代替递归
+    void visit(NodeId id);
+
+private:
+    ValueType exprType(NodeId id);
+    void checkInit(const ASTNode& node, ValueType varType, NodeId rhs);
+    // 检查一个节点，需要继续遍历的子节点压入 stack
+    void visitNode(NodeId id, std::vector<NodeId>& stack);
+    // 解析表达式子树中的全部变量引用
+    void resolveExpr(NodeId id);
+    // 变量引用或赋值的名字对应的槽位，未声明时报错并返回 NO_SLOT
+    uint32_t resolveUse(const ASTNode& node);
+    // 为声明分配槽位并在当前作用域中可见
+    uint32_t declare(const ASTNode& node);
+    void grow();
+    ValueType& slotType(uint32_t slot);
+
+    CompilationContext& ctx;
+    AST& ast;
+    SymbolTable& symbols;
+    std::vector<NodeId> exprStack;
+};
+
+static const NodeId LEAVE_SCOPE = NO_NODE - 1; // 栈中的标记：语句块的子节点已遍历完，离开其作用域
+
+// 流式分析中标识符表在各语句之间增长，按标识符id索引的表随之扩展
+void SemanticChecker::grow() {
+    size_t n = ctx.identifierTable.size();
+    if (symbols.visible.size() >= n) return;
+    symbols.visible.resize(n, NO_SLOT);
+    symbols.slotTypes.resize(n, TYPE_UNKNOWN);
+    symbols.otherSlot.resize(n, NO_SLOT);
+}
+
+ValueType& SemanticChecker::slotType(uint32_t slot) {
+    return ctx.isExtraSlot(slot) ? symbols.extraTypes[slot - ctx.firstExtraSlot] : symbols.slotTypes[slot];
+}
+
+// 表达式类型推断
+ValueType SemanticChecker::exprType(NodeId id) {
+    if (id == NO_NODE) return TYPE_UNKNOWN;
+    const ASTNode& node = ast[id];
+    switch (node.kind) {
+        case NK_INT:
+            return TYPE_INT;
+        case NK_STR:
+            return TYPE_STRING;
+        case NK_VAR:
+            return node.slot == NO_SLOT ? TYPE_UNKNOWN : slotType(node.slot);
+        case NK_ADD:
+        case NK_SUB:
+        case NK_MUL:
+        case NK_LT:
+        case NK_EQ:
+            return TYPE_INT;
+        default:
+            return TYPE_UNKNOWN;
+    }
+}
+
+// 检查赋值/初始化表达式类型是否与变量类型一致
+void SemanticChecker::checkInit(const ASTNode& node, ValueType varType, NodeId rhs) {
+    ValueType rhsType = exprType(rhs);
+    if (rhsType != TYPE_UNKNOWN && rhsType != varType) {
+        ++ctx.semanticErrors;
+        *ctx.diagnostics << "[语义错误] 变量 " << nodeText(ctx, node) << " 类型不匹配 (行: " << node.line << ")\n";
+    }
+}
+
+uint32_t SemanticChecker::resolveUse(const ASTNode& node) {
+    uint32_t slot = symbols.visible[node.value];
+    if (slot == NO_SLOT) {
+        ++ctx.semanticErrors;
+        *ctx.diagnostics << "[语义错误] 未定义变量: " << nodeText(ctx, node) << " (行: " << node.line << ")\n";
+    }
+    return slot;
+}
+
+uint32_t SemanticChecker::declare(const ASTNode& node) {
+    int name = node.value;
+    if (symbols.visible[name] != NO_SLOT) {
+        ++ctx.semanticErrors;
+        *ctx.diagnostics << "[语义错误] 变量 " << nodeText(ctx, node) << " 重复声明 (行: " << node.line << ")\n";
+        return symbols.visible[name];
+    }
+    uint32_t slot = name;
+    if (symbols.slotTypes[slot] != TYPE_UNKNOWN && symbols.slotTypes[slot] != node.varType) {
+        // 名字本身的槽位已被另一类型的同名变量占用
+        if (symbols.otherSlot[name] == NO_SLOT) {
+            // 对同一 ctx 重复分析时沿用已分配的槽位
+            uint32_t other = ctx.findSlot(SLOT_SPLIT, ctx.identifierTable[name]);
+            symbols.otherSlot[name] = other != NO_SLOT ? other : ctx.addSlot(SLOT_SPLIT, ctx.identifierTable[name]);
+            symbols.extraTypes.resize(ctx.extraSlots.size(), TYPE_UNKNOWN);
         }
-        return "";
-    };
+        slot = symbols.otherSlot[name];
+    }
+    slotType(slot) = node.varType;
+    symbols.visible[name] = slot;
+    symbols.declared.push_back(name);
+    return slot;
+}
+
+void SemanticChecker::resolveExpr(NodeId root) {
+    exprStack.assign(1, root);
+    while (!exprStack.empty()) {
+        NodeId id = exprStack.back();
+        exprStack.pop_back();
+        if (id == NO_NODE) continue;
+        ASTNode& node = ast.nodes[id];
+        if (node.kind == NK_VAR) node.slot = resolveUse(node);
+        for (const NodeId* c = ast.childBegin(node); c != ast.childEnd(node); ++c) exprStack.push_back(*c);
+    }
+}
+
+void SemanticChecker::visit(NodeId root) {
+    grow();
+    std::vector<NodeId> stack = {root};
+    while (!stack.empty()) {
+        NodeId id = stack.back();
+        stack.pop_back();
+        if (id == LEAVE_SCOPE) symbols.leaveScope();
+        else if (id != NO_NODE) visitNode(id, stack);
+    }
+}
 
-    std::function<void(const ASTPtr&)> visit = [&](const ASTPtr& node) {
-        if (!node) return;
-        if (node->type == "VarDecl") {
-            symbolTable[node->value] = node->varType;
+void SemanticChecker::visitNode(NodeId id, std::vector<NodeId>& stack) {
+    ASTNode& node = ast.nodes[id];
+    switch (node.kind) {
+        case NK_VAR_DECL:
+            // 初始化表达式在声明生效之前解析
+            if (node.childCount > 0) resolveExpr(ast.child(node, 0));
+            node.slot = declare(node);
             // 检查初始化表达式类型
-            if (!node->children.empty()) {
-                std::string rhsType = exprType(node->children[0]);
-                if (!rhsType.empty() && rhsType != node->varType) {
-                    std::cerr << "[语义错误] 变量 " << node->value << " 类型不匹配 (行: " << node->line << ")\n";
-                }
+            if (node.childCount > 0) checkInit(node, node.varType, ast.child(node, 0));
+            break;
+        case NK_ASSIGN:
+            resolveExpr(ast.child(node, 0));
+            node.slot = resolveUse(node);
+            if (node.slot != NO_SLOT) checkInit(node, slotType(node.slot), ast.child(node, 0));
+            break;
+        case NK_IF:
+        case NK_WHILE:
+            resolveExpr(ast.child(node, 0));
+            for (const NodeId* c = ast.childEnd(node); c != ast.childBegin(node) + 1;) stack.push_back(*--c);
+            break;
+        case NK_BLOCK:
+        case NK_PROGRAM:
+            if (node.kind == NK_BLOCK) {
+                symbols.enterScope();
+                stack.push_back(LEAVE_SCOPE);
             }
-        }
-        if (node->type == "Assign") {
-            if (symbolTable.count(node->value) == 0) {
-                std::cerr << "[语义错误] 未定义变量: " << node->value << " (行: " << node->line << ")\n";
-            } else {
-                std::string varType = symbolTable[node->value];
-                std::string rhsType = exprType(node->children[0]);
-                if (!rhsType.empty() && rhsType != varType) {
-                    std::cerr << "[语义错误] 变量 " << node->value << " 类型不匹配 (行: " << node->line << ")\n";
-                }
-            }
-        }
-        for (const auto& child : node->children) visit(child);
-    };
+            // 子节点逆序入栈，按原顺序出栈
+            for (const NodeId* c = ast.childEnd(node); c != ast.childBegin(node);) stack.push_back(*--c);
+            break;
+        default:
+            // 表达式节点由所在的语句解析
+            break;
+    }
+}
+
+bool checkSemantics(CompilationContext& ctx, AST& ast) {
+    ctx.semanticErrors = 0;
+    SymbolTable symbols;
+    SemanticChecker checker(ctx, ast, symbols);
+    checker.visit(ast.root);
+    return ctx.semanticErrors == 0;
+}
 
-    visit(root);
-    return true;
-}
\ No newline at end of file
+void checkStatement(CompilationContext& ctx, AST& ast, NodeId stmt, SymbolTable& symbols) {
+    if (stmt == STREAM_BLOCK_BEGIN) return symbols.enterScope();
+    if (stmt == STREAM_BLOCK_END) return symbols.leaveScope();
+    SemanticChecker checker(ctx, ast, symbols);
+    checker.visit(stmt);
+}
@@ -3,6 +3,32 @@
 
 #include "parser.h"
 
-bool checkSemantics(const ASTPtr& root);
+/** 作用域符号表：名字解析不做字符串哈希，全部按标识符id与槽位下标查表
+ *   每个 {} 块是一层作用域；与 Java 相同，局部变量不能与外层作用域中可见的变量同名
+ *   变量的槽位即 IR 中 OPD_VAR 的下标：声明优先使用名字本身的id，先后出现在不相交作用域中的同名同类型变量共用这个槽位，
+ *   同名但类型不同时另分配一个额外槽位（ctx.addSlot，不驻留到标识符表），各后端按槽位分配存储，终值按源名字输出
+ */
+struct SymbolTable {
+    std::vector<uint32_t> visible; // 标识符id -> 当前可见声明的槽位，NO_SLOT 表示不可见
+    std::vector<ValueType> slotTypes; // 标识符id -> 名字本身槽位的类型，TYPE_UNKNOWN 表示尚未分配
+    std::vector<ValueType> extraTypes; // 第 k 个额外槽位 -> 类型
+    std::vector<uint32_t> otherSlot; // 标识符id -> 与名字本身槽位类型不同的另一个槽位
+    std::vector<int> declared; // 按声明顺序记录的标识符id，离开作用域时撤销
+    std::vector<size_t> scopes; // 各层作用域在 declared 中的起点
 
-#endif
\ No newline at end of file
+    void enterScope() { scopes.push_back(declared.size()); }
+    void leaveScope() {
+        for (size_t i = scopes.back(); i < declared.size(); ++i) visible[declared[i]] = NO_SLOT;
+        declared.resize(scopes.back());
+        scopes.pop_back();
+    }
+};
+
+// 解析每个变量引用所指的声明并把槽位写入节点，同时检查类型；语义错误计入 ctx.semanticErrors 并输出到 ctx.diagnostics
+// 没有语义错误时返回 true，否则不能生成IR
+bool checkSemantics(CompilationContext& ctx, AST& ast);
+
+// 流式分析中逐条检查语句，symbols 在各语句之间保留，stmt 为 STREAM_BLOCK_BEGIN/END 时进入/离开一层作用域；错误计数不清零
+void checkStatement(CompilationContext& ctx, AST& ast, NodeId stmt, SymbolTable& symbols);
+
+#endif
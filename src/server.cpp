@@ -0,0 +1,350 @@
+#include "server.h"
+#include "context.h"
+#include "driver.h"
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/** 服务器流程：
+ * 1.绑定并监听套接字，accept 到的每个连接交给一个分离线程
+ * 2.连接线程循环读取请求帧，handleRequest 编译后写回回复帧，对方关闭连接时结束
+ * 3.收到 shutdown 请求后关闭监听套接字使 accept 返回，并关闭其余连接的读端，使空闲连接上阻塞的 read 返回、
+ *   正在编译的请求写回回复后结束；等所有连接线程结束后删除套接字文件
+ */
+
+static const uint32_t MAX_FRAME = 64u << 20; // 单帧上限，防止错误的长度字段导致巨量分配
+
+// ---------------- 帧读写 ----------------
+
+static bool readFull(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = read(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool writeFull(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = send(fd, data, size, MSG_NOSIGNAL); // 对方已关闭时返回错误而不是触发 SIGPIPE
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool writeFrame(int fd, const std::string& payload) {
+    uint32_t size = payload.size();
+    unsigned char header[4] = {(unsigned char)size, (unsigned char)(size >> 8), (unsigned char)(size >> 16),
+                               (unsigned char)(size >> 24)};
+    return writeFull(fd, (const char*)header, 4) && writeFull(fd, payload.data(), payload.size());
+}
+
+static bool readFrame(int fd, std::string& payload) {
+    unsigned char header[4];
+    if (!readFull(fd, (char*)header, 4)) return false;
+    uint32_t size = header[0] | header[1] << 8 | header[2] << 16 | (uint32_t)header[3] << 24;
+    if (size > MAX_FRAME) return false;
+    payload.resize(size);
+    return readFull(fd, &payload[0], size);
+}
+
+// ---------------- 请求与回复的编码 ----------------
+
+static const char* const PHASE_NAMES[] = {"tokens", "diagnostics", "ir"};
+
+bool parsePhases(const std::string& list, int& phases) {
+    phases = 0;
+    for (size_t pos = 0; pos <= list.size();) {
+        size_t comma = list.find(',', pos);
+        if (comma == std::string::npos) comma = list.size();
+        std::string name = list.substr(pos, comma - pos);
+        pos = comma + 1;
+        if (name.empty()) continue;
+        int bit = -1;
+        for (int i = 0; i < 3; ++i) {
+            if (name == PHASE_NAMES[i]) bit = i;
+        }
+        if (bit < 0) return false;
+        phases |= 1 << bit;
+    }
+    return true;
+}
+
+static std::string joinList(const std::vector<std::string>& items) {
+    std::string list;
+    for (size_t i = 0; i < items.size(); ++i) list += (i ? "," : "") + items[i];
+    return list;
+}
+
+static std::string encodeRequest(const CompileRequest& request) {
+    std::string payload;
+    if (!request.path.empty()) payload += "path " + request.path + "\n";
+    std::vector<std::string> phases;
+    for (int i = 0; i < 3; ++i) {
+        if (request.phases & (1 << i)) phases.push_back(PHASE_NAMES[i]);
+    }
+    payload += "phases " + joinList(phases) + "\n";
+    if (!request.passes.empty()) payload += "passes " + joinList(request.passes) + "\n";
+    if (request.shutdown) payload += "shutdown\n";
+    payload += "\n";
+    return payload + request.source;
+}
+
+// 格式错误时返回false并设置error
+static bool decodeRequest(const std::string& payload, CompileRequest& request, std::string& error) {
+    size_t pos = 0;
+    while (true) {
+        size_t newline = payload.find('\n', pos);
+        if (newline == std::string::npos) {
+            error = "请求缺少结束头部的空行";
+            return false;
+        }
+        std::string line = payload.substr(pos, newline - pos);
+        pos = newline + 1;
+        if (line.empty()) break;
+        size_t space = line.find(' ');
+        std::string key = line.substr(0, space), value = space == std::string::npos ? "" : line.substr(space + 1);
+        if (key == "path") request.path = value;
+        else if (key == "phases") {
+            if (!parsePhases(value, request.phases)) {
+                error = "未知的阶段: " + value;
+                return false;
+            }
+        } else if (key == "passes") {
+            request.passes.clear();
+            for (size_t p = 0; p <= value.size();) {
+                size_t comma = value.find(',', p);
+                if (comma == std::string::npos) comma = value.size();
+                if (comma > p) request.passes.push_back(value.substr(p, comma - p));
+                p = comma + 1;
+            }
+        } else if (key == "shutdown") request.shutdown = true;
+        else {
+            error = "未知的请求字段: " + key;
+            return false;
+        }
+    }
+    request.source = payload.substr(pos);
+    return true;
+}
+
+static void appendSection(std::string& payload, const char* name, const std::string& content) {
+    payload += std::string(name) + " " + std::to_string(content.size()) + "\n";
+    payload += content;
+}
+
+static std::string encodeResponse(const CompileResponse& response, int phases) {
+    std::string payload = "status " + std::to_string(response.status) + "\n";
+    if (phases & PHASE_TOKENS) appendSection(payload, "tokens", response.tokens);
+    if (phases & PHASE_DIAGNOSTICS) appendSection(payload, "diagnostics", response.diagnostics);
+    if (phases & PHASE_IR) appendSection(payload, "ir", response.ir);
+    return payload;
+}
+
+static bool decodeResponse(const std::string& payload, CompileResponse& response) {
+    size_t pos = payload.find('\n');
+    if (payload.compare(0, 7, "status ") != 0 || pos == std::string::npos) return false;
+    response.status = std::atoi(payload.c_str() + 7);
+    ++pos;
+    while (pos < payload.size()) {
+        size_t newline = payload.find('\n', pos);
+        if (newline == std::string::npos) return false;
+        std::string header = payload.substr(pos, newline - pos);
+        size_t space = header.find(' ');
+        if (space == std::string::npos) return false;
+        std::string name = header.substr(0, space);
+        size_t size = std::strtoull(header.c_str() + space + 1, nullptr, 10);
+        pos = newline + 1;
+        if (size > payload.size() - pos) return false;
+        std::string content = payload.substr(pos, size);
+        pos += size;
+        if (name == "tokens") response.tokens = std::move(content);
+        else if (name == "diagnostics") response.diagnostics = std::move(content);
+        else if (name == "ir") response.ir = std::move(content);
+    }
+    return true;
+}
+
+// ---------------- 编译 ----------------
+
+CompileResponse handleRequest(const CompileRequest& request) {
+    CompileResponse response;
+    std::ostringstream diagnostics;
+    CompilationContext ctx;
+    ctx.diagnostics = &diagnostics;
+
+    std::string fileSource;
+    if (!request.path.empty()) {
+        std::ifstream fin(request.path, std::ios::binary);
+        if (!fin) {
+            response.status = 1;
+            response.diagnostics = "无法打开源文件: " + request.path + "\n";
+            return response;
+        }
+        std::ostringstream buffer;
+        buffer << fin.rdbuf();
+        fileSource = buffer.str();
+    }
+    FrontEnd front;
+    front.tokens = runLexerBuffer(ctx, request.path.empty() ? request.source : fileSource);
+    if (request.phases & PHASE_TOKENS) {
+        std::ostringstream out;
+        writeTokens(front.tokens, out);
+        response.tokens = out.str();
+    }
+
+    // 只要 token流时不做后续阶段；只要错误输出时同样生成并优化IR，与直接编译报告相同的错误
+    if (request.phases & (PHASE_DIAGNOSTICS | PHASE_IR)) {
+        compileFrontEnd(ctx, front);
+        std::vector<PassStats> stats;
+        std::string optError;
+        if (front.parseFailed || front.semanticsFailed) {
+            response.status = 1;
+        } else if (!optimizeIR(front.ir, request.passes, stats, optError)) {
+            diagnostics << optError << "\n";
+            response.status = 1;
+        } else if (request.phases & PHASE_IR) {
+            std::ostringstream out;
+            writeIR(front.ir, out);
+            response.ir = out.str();
+        }
+    }
+    response.diagnostics = diagnostics.str();
+    return response;
+}
+
+// ---------------- 服务器 ----------------
+
+static bool makeAddress(const std::string& socketPath, sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) return false;
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    return true;
+}
+
+// 所有连接线程共享的服务器状态
+struct ServerState {
+    int listenFd = -1;
+    std::atomic<bool> stopping{false};
+    std::atomic<size_t> requests{0};
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::unordered_set<int> connections; // 未关闭的连接，由 mutex 保护
+};
+
+// 停止服务器：唤醒阻塞在 accept 上的主线程，其他连接读完当前请求后结束
+static void stopServer(ServerState& state, int self) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.stopping = true;
+    shutdown(state.listenFd, SHUT_RDWR);
+    for (int fd : state.connections) {
+        if (fd != self) shutdown(fd, SHUT_RD);
+    }
+}
+
+static void serveConnection(ServerState& state, int fd) {
+    std::string payload;
+    while (readFrame(fd, payload)) {
+        CompileRequest request;
+        CompileResponse response;
+        std::string error;
+        if (decodeRequest(payload, request, error)) {
+            response = handleRequest(request);
+        } else {
+            response.status = 1;
+            response.diagnostics = error + "\n";
+            request.phases = PHASE_DIAGNOSTICS;
+        }
+        ++state.requests;
+        if (!writeFrame(fd, encodeResponse(response, request.phases))) break;
+        if (request.shutdown) {
+            stopServer(state, fd);
+            break;
+        }
+    }
+    std::lock_guard<std::mutex> lock(state.mutex);
+    close(fd);
+    state.connections.erase(fd);
+    if (state.connections.empty()) state.idle.notify_all();
+}
+
+int runServer(const std::string& socketPath, std::ostream& log) {
+    sockaddr_un addr;
+    if (!makeAddress(socketPath, addr)) {
+        log << "套接字路径过长: " << socketPath << "\n";
+        return 1;
+    }
+    ServerState state;
+    state.listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath.c_str()); // 上次异常退出遗留的套接字文件
+    if (state.listenFd < 0 || bind(state.listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(state.listenFd, SOMAXCONN) != 0) {
+        log << "无法监听 " << socketPath << ": " << std::strerror(errno) << "\n";
+        if (state.listenFd >= 0) close(state.listenFd);
+        return 1;
+    }
+    log << "编译服务器已启动: " << socketPath << std::endl;
+
+    while (!state.stopping) {
+        int fd = accept(state.listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            // 停止之后才取出的连接不再服务
+            if (state.stopping) {
+                close(fd);
+                break;
+            }
+            state.connections.insert(fd);
+        }
+        std::thread(serveConnection, std::ref(state), fd).detach();
+    }
+
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.idle.wait(lock, [&] { return state.connections.empty(); });
+    close(state.listenFd);
+    unlink(socketPath.c_str());
+    log << "编译服务器已停止，共处理 " << state.requests << " 个请求\n";
+    return 0;
+}
+
+// ---------------- 客户端 ----------------
+
+bool sendRequest(const std::string& socketPath, const CompileRequest& request, CompileResponse& response,
+                 std::string& error) {
+    sockaddr_un addr;
+    if (!makeAddress(socketPath, addr)) {
+        error = "套接字路径过长: " + socketPath;
+        return false;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        error = "无法连接编译服务器 " + socketPath + ": " + std::strerror(errno);
+        if (fd >= 0) close(fd);
+        return false;
+    }
+    std::string payload;
+    bool ok = writeFrame(fd, encodeRequest(request)) && readFrame(fd, payload) && decodeResponse(payload, response);
+    close(fd);
+    if (!ok) error = "与编译服务器通信失败";
+    return ok;
+}
@@ -0,0 +1,54 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/** 编译服务器：常驻进程在 Unix 域套接字上接受编译请求，省去每次启动进程和建立输出文件的开销
+ * 每个请求使用独立的 CompilationContext，每个连接一个线程，多个连接可以同时编译
+ * 协议：一个连接上可以依次发送多个请求，请求与回复都是一帧：4字节小端长度 + 内容
+ *   请求内容：若干 "键 值" 行，空行结束，其后直到帧尾为内联源码
+ *     path <源文件路径>      在服务器进程中打开，客户端应传绝对路径；没有 path 时编译内联源码
+ *     phases tokens,diagnostics,ir   需要返回的部分，默认全部
+ *     passes sccp,dse        优化遍，默认不优化
+ *     shutdown               回复后停止服务器
+ *   回复内容："status <退出码>" 一行，其后为请求的各部分，每部分是 "<名称> <字节数>" 一行加上该部分的原始内容
+ */
+
+// 请求需要返回的部分
+enum RequestPhase {
+    PHASE_TOKENS = 1, // token流，格式同 tokens.txt
+    PHASE_DIAGNOSTICS = 2, // 词法/语法/语义错误与优化遍配置错误
+    PHASE_IR = 4 // 优化后的四元式，格式同 ir.txt
+};
+
+struct CompileRequest {
+    std::string path;
+    std::string source; // path 为空时编译的内联源码
+    int phases = PHASE_TOKENS | PHASE_DIAGNOSTICS | PHASE_IR;
+    std::vector<std::string> passes;
+    bool shutdown = false;
+};
+
+struct CompileResponse {
+    int status = 0; // 含义同 compileFile 的返回值
+    std::string tokens;
+    std::string diagnostics;
+    std::string ir;
+};
+
+// 解析 "tokens,diagnostics,ir" 形式的列表，有未知名称时返回false
+bool parsePhases(const std::string& list, int& phases);
+
+// 在当前进程中执行一个请求，服务器对每个请求调用它
+CompileResponse handleRequest(const CompileRequest& request);
+
+// 监听 socketPath 直到收到 shutdown 请求，返回进程退出码；启动与退出信息输出到 log
+int runServer(const std::string& socketPath, std::ostream& log);
+
+// 客户端：连接服务器并发送一个请求，等待回复；连接或通信失败时返回false并设置error
+bool sendRequest(const std::string& socketPath, const CompileRequest& request, CompileResponse& response,
+                 std::string& error);
+
+#endif
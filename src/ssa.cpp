@@ -0,0 +1,199 @@
+#include "ssa.h"
+#include <algorithm>
+
+/** SSA构建流程：
+ * 1.由支配树计算支配边界
+ * 2.在每个变量定义块的迭代支配边界上放置 phi（临时变量只定义一次且定义支配所有使用，无需 phi）
+ * 3.沿支配树先序遍历重命名：current[槽位] 记录当前可见的SSA值，离开块时按撤销日志恢复
+ */
+
+// 计算支配边界
+static std::vector<std::vector<int>> dominanceFrontiers(const CFG& cfg) {
+    std::vector<std::vector<int>> df(cfg.blocks.size());
+    for (size_t b = 0; b < cfg.blocks.size(); ++b) {
+        const BasicBlock& block = cfg.blocks[b];
+        if (block.idom < 0 || block.preds.size() < 2) continue;
+        for (int p : block.preds) {
+            int runner = p;
+            while (runner >= 0 && cfg.blocks[runner].idom >= 0 && runner != block.idom) {
+                if (df[runner].empty() || df[runner].back() != (int)b) df[runner].push_back(b);
+                if (runner == cfg.blocks[runner].idom) break;
+                runner = cfg.blocks[runner].idom;
+            }
+        }
+    }
+    return df;
+}
+
+// 重命名过程的状态
+class SSARenamer {
+public:
+    SSARenamer(IRProgram& ir, const CFG& cfg, SSAForm& ssa, bool propagateCopies)
+        : ir(ir), cfg(cfg), ssa(ssa), propagateCopies(propagateCopies),
+          current(ssa.varSlots + ir.tempCount - ssa.firstTemp, -1),
+          entryValue(current.size(), -1) {}
+
+    void run();
+
+private:
+    int newValue(ValueSource source, int slot, int index) {
+        ssa.values.push_back({source, slot, index});
+        return ssa.values.size() - 1;
+    }
+    // 当前可见的值，尚未定义过则为入口初值
+    int currentValue(int slot) {
+        if (current[slot] >= 0) return current[slot];
+        if (entryValue[slot] < 0) entryValue[slot] = newValue(VAL_ENTRY, slot, -1);
+        return entryValue[slot];
+    }
+    void define(int slot, int value) {
+        undoLog.push_back({slot, current[slot]});
+        current[slot] = value;
+    }
+    int useOperand(size_t q, int k);
+    void renameBlock(int b);
+
+    IRProgram& ir;
+    const CFG& cfg;
+    SSAForm& ssa;
+    bool propagateCopies;
+    std::vector<int> current; // 槽位 -> 当前值，-1 表示仍为入口初值
+    std::vector<int> entryValue; // 槽位 -> 入口初值（按需创建）
+    std::vector<std::pair<int, int>> undoLog; // (槽位, 旧值)
+};
+
+// 处理四元式 q 的第 k 个操作数，返回其SSA值
+int SSARenamer::useOperand(size_t q, int k) {
+    Operand& o = k == 0 ? ir.arg1[q] : ir.arg2[q];
+    int slot = ssa.slotOf(o);
+    if (slot < 0) return -1;
+    int value = currentValue(slot);
+    if (propagateCopies) {
+        // 沿复写链向前追溯，只要源操作数此处仍持有复写时的值就替换
+        while (ssa.values[value].source == VAL_DEF) {
+            int d = ssa.values[value].index;
+            if (ir.ops[d] != OP_ASSIGN) break;
+            int srcSlot = ssa.slotOf(ir.arg1[d]);
+            if (srcSlot < 0) break;
+            int srcValue = ssa.useValue[0][d];
+            if (currentValue(srcSlot) != srcValue) break;
+            o = ir.arg1[d];
+            value = srcValue;
+        }
+    }
+    return value;
+}
+
+void SSARenamer::renameBlock(int b) {
+    for (int p : ssa.blockPhis[b]) define(ssa.phis[p].slot, ssa.phis[p].value);
+    const BasicBlock& block = cfg.blocks[b];
+    for (size_t q = block.begin; q < block.end; ++q) {
+        if (ir.ops[q] == OP_LABEL) continue;
+        ssa.useValue[0][q] = useOperand(q, 0);
+        ssa.useValue[1][q] = useOperand(q, 1);
+        if (isJump(ir.ops[q])) continue;
+        int slot = ssa.slotOf(ir.result[q]);
+        if (slot < 0) continue;
+        int value = newValue(VAL_DEF, slot, q);
+        ssa.defValue[q] = value;
+        define(slot, value);
+    }
+    // 填写后继块中 phi 对应本块的操作数
+    for (int s : block.succs) {
+        const std::vector<int>& preds = cfg.blocks[s].preds;
+        size_t predIndex = std::find(preds.begin(), preds.end(), b) - preds.begin();
+        for (int p : ssa.blockPhis[s]) ssa.phis[p].operands[predIndex] = currentValue(ssa.phis[p].slot);
+    }
+    // 最后一个块执行完（末尾不是 jmp）即程序结束，记录源程序变量的终值；优化器引入的变量不输出，结束时不活跃
+    bool exits = b + 1 == (int)cfg.blocks.size() && (block.end == block.begin || ir.ops[block.end - 1] != OP_JMP);
+    if (exits) {
+        for (int slot = 0; slot < ssa.varSlots; ++slot) {
+            if (current[slot] >= 0 && !ir.context->isSynthetic(slot)) ssa.exitValues.push_back(current[slot]);
+        }
+    }
+}
+
+void SSARenamer::run() {
+    // 支配树先序遍历，栈元素为 (块, 进入时撤销日志长度)，块为 ~b 表示离开
+    std::vector<std::pair<int, size_t>> stack;
+    stack.push_back({0, 0});
+    while (!stack.empty()) {
+        std::pair<int, size_t> top = stack.back();
+        stack.pop_back();
+        if (top.first < 0) {
+            while (undoLog.size() > top.second) {
+                current[undoLog.back().first] = undoLog.back().second;
+                undoLog.pop_back();
+            }
+            continue;
+        }
+        int b = top.first;
+        stack.push_back({~b, undoLog.size()});
+        renameBlock(b);
+        const std::vector<int>& children = ssa.domChildren[b];
+        for (auto it = children.rbegin(); it != children.rend(); ++it) stack.push_back({*it, 0});
+    }
+}
+
+SSAForm buildSSA(IRProgram& ir, const CFG& cfg, bool propagateCopies) {
+    SSAForm ssa;
+    size_t n = ir.size();
+    ssa.varSlots = ir.context->slotCount();
+    ssa.firstTemp = ir.tempCount;
+    for (size_t q = 0; q < n; ++q) {
+        for (Operand o : {ir.arg1[q], ir.arg2[q], ir.result[q]}) {
+            if (o.kind() == OPD_TEMP) ssa.firstTemp = std::min<int>(ssa.firstTemp, o.index());
+        }
+    }
+    ssa.defValue.assign(n, -1);
+    ssa.useValue[0].assign(n, -1);
+    ssa.useValue[1].assign(n, -1);
+    ssa.blockOf.assign(n, -1);
+    ssa.blockPhis.resize(cfg.blocks.size());
+    ssa.domChildren.resize(cfg.blocks.size());
+    for (int b : cfg.order) {
+        if (b != 0) ssa.domChildren[cfg.blocks[b].idom].push_back(b);
+        for (size_t q = cfg.blocks[b].begin; q < cfg.blocks[b].end; ++q) ssa.blockOf[q] = b;
+    }
+
+    // 收集每个变量的定义块
+    std::vector<std::vector<int>> defBlocks(ssa.varSlots);
+    for (size_t q = 0; q < n; ++q) {
+        if (ssa.blockOf[q] < 0 || isJump(ir.ops[q]) || ir.result[q].kind() != OPD_VAR) continue;
+        std::vector<int>& blocks = defBlocks[ir.result[q].index()];
+        if (blocks.empty() || blocks.back() != ssa.blockOf[q]) blocks.push_back(ssa.blockOf[q]);
+    }
+
+    // 在迭代支配边界放置 phi
+    std::vector<std::vector<int>> df = dominanceFrontiers(cfg);
+    std::vector<int> hasPhi(cfg.blocks.size(), -1), queued(cfg.blocks.size(), -1);
+    std::vector<int> work;
+    for (int slot = 0; slot < ssa.varSlots; ++slot) {
+        // 只在一个块中定义的变量也可能需要 phi（如循环中先使用后定义，与入口初值汇合）
+        work.clear();
+        for (int b : defBlocks[slot]) {
+            queued[b] = slot;
+            work.push_back(b);
+        }
+        while (!work.empty()) {
+            int b = work.back();
+            work.pop_back();
+            for (int f : df[b]) {
+                if (hasPhi[f] == slot) continue;
+                hasPhi[f] = slot;
+                int value = ssa.values.size();
+                ssa.values.push_back({VAL_PHI, slot, (int)ssa.phis.size()});
+                ssa.phis.push_back({f, slot, value, std::vector<int>(cfg.blocks[f].preds.size(), -1)});
+                ssa.blockPhis[f].push_back(ssa.phis.size() - 1);
+                if (queued[f] != slot) {
+                    queued[f] = slot;
+                    work.push_back(f);
+                }
+            }
+        }
+    }
+
+    SSARenamer renamer(ir, cfg, ssa, propagateCopies);
+    renamer.run();
+    return ssa;
+}
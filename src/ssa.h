@@ -0,0 +1,57 @@
+#ifndef SSA_H
+#define SSA_H
+
+#include "cfg.h"
+#include <vector>
+
+/** SSA 分析：
+ * 不改写四元式本身，只为每个变量/临时变量的每次定义分配一个SSA值，
+ * 在汇合点放置 phi，并记录每个操作数使用的是哪个SSA值。
+ * 各优化遍基于这些信息判断"两个操作数是否一定相等"，再直接修改原四元式。
+ */
+
+// SSA值的来源
+enum ValueSource : uint8_t {
+    VAL_ENTRY, // 程序入口时的初值（未初始化，视为未知）
+    VAL_DEF,   // 某条四元式的定义
+    VAL_PHI    // 汇合点的 phi
+};
+
+struct SSAValue {
+    ValueSource source;
+    int slot; // 所属槽位
+    int index; // VAL_DEF 为四元式下标，VAL_PHI 为 phi 下标，VAL_ENTRY 为-1
+};
+
+struct Phi {
+    int block; // 所在块
+    int slot; // 所属槽位
+    int value; // phi 定义的SSA值
+    std::vector<int> operands; // 与所在块的 preds 一一对应，-1 表示该前驱不可达
+};
+
+struct SSAForm {
+    int varSlots = 0; // 槽位 [0, varSlots) 为变量，下标即 OPD_VAR 的槽位
+    int firstTemp = 0; // 槽位 varSlots + k 对应临时变量 t(firstTemp + k)
+    std::vector<SSAValue> values;
+    std::vector<Phi> phis;
+    std::vector<std::vector<int>> blockPhis; // 块 -> 该块的 phi 下标
+    std::vector<int> defValue; // 四元式下标 -> 定义的SSA值，-1 表示不定义
+    std::vector<int> useValue[2]; // 四元式下标 -> arg1/arg2 使用的SSA值，-1 表示不是变量/临时变量
+    std::vector<int> exitValues; // 程序结束（执行完最后一个块）时各源程序变量的SSA值，变量的终值可被观察
+    std::vector<int> blockOf; // 四元式下标 -> 所在块，不可达块中的四元式为-1
+    std::vector<std::vector<int>> domChildren; // 支配树
+
+    // 操作数对应的槽位，不是变量/临时变量时为-1
+    int slotOf(Operand o) const {
+        if (o.kind() == OPD_VAR) return o.index();
+        if (o.kind() == OPD_TEMP) return varSlots + (o.index() - firstTemp);
+        return -1;
+    }
+};
+
+// 构建SSA信息。propagateCopies 为真时顺带做复写传播：
+// 若某操作数的值来自复写 "= a x"，且此处 a 仍持有当时的值，则把该操作数直接改写为 a
+SSAForm buildSSA(IRProgram& ir, const CFG& cfg, bool propagateCopies = false);
+
+#endif
@@ -0,0 +1,96 @@
+#include "stats.h"
+#include <iomanip>
+#include <sys/resource.h>
+
+thread_local uint64_t threadAllocations = 0;
+thread_local uint64_t threadAllocBytes = 0;
+bool allocationHookInstalled = false;
+
+void CompileStats::add(const PhaseStats& phase) {
+    for (PhaseStats& p : phases) {
+        if (p.name == phase.name) {
+            p.wallMs += phase.wallMs;
+            p.cpuMs += phase.cpuMs;
+            p.allocations += phase.allocations;
+            p.allocBytes += phase.allocBytes;
+            return;
+        }
+    }
+    phases.push_back(phase);
+}
+
+PhaseTimer::PhaseTimer(CompileStats* stats, const char* name) : stats(stats), name(name) {
+    if (!stats) return;
+    allocStart = threadAllocations;
+    bytesStart = threadAllocBytes;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuStart);
+    wallStart = std::chrono::steady_clock::now();
+}
+
+PhaseTimer::~PhaseTimer() {
+    if (!stats) return;
+    auto wallEnd = std::chrono::steady_clock::now();
+    timespec cpuEnd;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuEnd);
+    PhaseStats phase;
+    phase.name = name;
+    phase.wallMs = std::chrono::duration<double, std::milli>(wallEnd - wallStart).count();
+    phase.cpuMs = (cpuEnd.tv_sec - cpuStart.tv_sec) * 1e3 + (cpuEnd.tv_nsec - cpuStart.tv_nsec) / 1e6;
+    phase.allocations = threadAllocations - allocStart;
+    phase.allocBytes = threadAllocBytes - bytesStart;
+    stats->add(phase);
+}
+
+void recordPeakRss(CompileStats& stats) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    stats.peakRssKB = usage.ru_maxrss;
+}
+
+void writeTimeReport(const CompileStats& stats, std::ostream& out) {
+    PhaseStats total;
+    total.name = "total";
+    // 表头的汉字在 UTF-8 中占3字节、显示为2列，宽度按字节数补齐
+    out << std::left << std::setw(12) << "阶段" << std::right << std::setw(14) << "墙钟(ms)" << std::setw(12)
+        << "CPU(ms)" << std::setw(16) << "分配次数" << std::setw(14) << "分配(KB)" << "\n";
+    auto row = [&](const PhaseStats& p) {
+        out << std::left << std::setw(10) << p.name << std::right << std::fixed << std::setprecision(3)
+            << std::setw(12) << p.wallMs << std::setw(12) << p.cpuMs;
+        if (allocationHookInstalled) {
+            out << std::setw(12) << p.allocations << std::setw(12) << std::setprecision(1) << p.allocBytes / 1024.0;
+        } else {
+            out << std::setw(12) << "-" << std::setw(12) << "-";
+        }
+        out << "\n";
+    };
+    for (const PhaseStats& p : stats.phases) {
+        row(p);
+        total.wallMs += p.wallMs;
+        total.cpuMs += p.cpuMs;
+        total.allocations += p.allocations;
+        total.allocBytes += p.allocBytes;
+    }
+    row(total);
+    out << "token " << stats.tokens << "，AST节点 " << stats.astNodes << "，标识符 " << stats.identifiers << "，常量 "
+        << stats.constants << "，四元式 " << stats.quads << "（优化后 " << stats.optimizedQuads << "），峰值RSS "
+        << stats.peakRssKB << " KB\n";
+}
+
+void writeStatsJson(const CompileStats& stats, std::ostream& out) {
+    auto alloc = [&](uint64_t n) -> std::ostream& {
+        if (allocationHookInstalled) out << n;
+        else out << "null";
+        return out;
+    };
+    out << std::fixed << std::setprecision(3) << "{\"phases\":[";
+    for (size_t i = 0; i < stats.phases.size(); ++i) {
+        const PhaseStats& p = stats.phases[i];
+        out << (i ? "," : "") << "{\"name\":\"" << p.name << "\",\"wall_ms\":" << p.wallMs << ",\"cpu_ms\":" << p.cpuMs
+            << ",\"allocations\":";
+        alloc(p.allocations) << ",\"alloc_bytes\":";
+        alloc(p.allocBytes) << "}";
+    }
+    out << "],\"tokens\":" << stats.tokens << ",\"ast_nodes\":" << stats.astNodes << ",\"identifiers\":"
+        << stats.identifiers << ",\"constants\":" << stats.constants << ",\"quads\":" << stats.quads
+        << ",\"optimized_quads\":" << stats.optimizedQuads << ",\"peak_rss_kb\":" << stats.peakRssKB << "}\n";
+}
@@ -0,0 +1,70 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <cstdint>
+#include <ctime>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/** 编译过程的计时与计数（--time-report 输出表格，--stats=json 输出JSON）：
+ * 每个阶段记录墙钟时间、本线程CPU时间与本线程的堆分配次数/字节数，另记录 token、AST节点、符号、四元式个数与进程峰值常驻内存
+ * 分配计数来自 alloc_hook.cpp 替换的全局 operator new，只在链接了该文件的程序中可用
+ */
+
+// 当前线程累计的分配次数与字节数，由 alloc_hook.cpp 更新
+extern thread_local uint64_t threadAllocations;
+extern thread_local uint64_t threadAllocBytes;
+// alloc_hook.cpp 已链接时为 true
+extern bool allocationHookInstalled;
+
+struct PhaseStats {
+    std::string name; // lex、parse、semantic、irgen、optimize、output 等
+    double wallMs = 0;
+    double cpuMs = 0;
+    uint64_t allocations = 0;
+    uint64_t allocBytes = 0;
+};
+
+struct CompileStats {
+    std::vector<PhaseStats> phases; // 按首次进入的顺序，同名阶段多次进入时累加
+    uint64_t tokens = 0;
+    uint64_t astNodes = 0;
+    uint64_t identifiers = 0; // 标识符表大小（符号个数）
+    uint64_t constants = 0;
+    uint64_t quads = 0; // IR生成后的四元式条数
+    uint64_t optimizedQuads = 0; // 优化后的四元式条数
+    long peakRssKB = 0;
+
+    void add(const PhaseStats& phase);
+};
+
+/* 作用域计时器：构造时取时间与分配计数，析构时把差值累加到 stats 的 name 阶段
+ * stats 为空时不做任何事，可以留在发布版本中
+ */
+class PhaseTimer {
+public:
+    PhaseTimer(CompileStats* stats, const char* name);
+    ~PhaseTimer();
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    CompileStats* stats;
+    const char* name;
+    std::chrono::steady_clock::time_point wallStart;
+    timespec cpuStart;
+    uint64_t allocStart = 0;
+    uint64_t bytesStart = 0;
+};
+
+// 读取进程峰值常驻内存，写入 stats.peakRssKB
+void recordPeakRss(CompileStats& stats);
+
+// 人读的表格：每阶段一行，末尾为合计与各项计数
+void writeTimeReport(const CompileStats& stats, std::ostream& out);
+// 一行JSON，未链接分配钩子时分配字段为 null
+void writeStatsJson(const CompileStats& stats, std::ostream& out);
+
+#endif
@@ -0,0 +1,47 @@
+#include "threadpool.h"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<size_t> jobs;
+};
+
+void runWorkStealing(size_t jobCount, int threadCount, const std::function<void(size_t)>& job) {
+    threadCount = std::max(1, threadCount);
+    std::vector<WorkerQueue> queues(threadCount);
+    for (size_t j = 0; j < jobCount; ++j) queues[j % threadCount].jobs.push_back(j);
+
+    auto worker = [&](int self) {
+        for (;;) {
+            size_t next = 0;
+            bool found = false;
+            {
+                std::lock_guard<std::mutex> lock(queues[self].mutex);
+                if (!queues[self].jobs.empty()) {
+                    next = queues[self].jobs.back();
+                    queues[self].jobs.pop_back();
+                    found = true;
+                }
+            }
+            for (int k = 1; !found && k < threadCount; ++k) {
+                WorkerQueue& victim = queues[(self + k) % threadCount];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.jobs.empty()) {
+                    next = victim.jobs.front();
+                    victim.jobs.pop_front();
+                    found = true;
+                }
+            }
+            if (!found) return;
+            job(next);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; ++t) threads.emplace_back(worker, t);
+    worker(0);
+    for (std::thread& t : threads) t.join();
+}
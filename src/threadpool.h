@@ -0,0 +1,14 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <cstddef>
+#include <functional>
+
+/** 工作窃取线程池：
+ * 任务编号 0..jobCount-1 开始前轮流分到各工作线程的双端队列，线程从自己队列的尾部取任务，
+ * 自己的队列空了就从其他线程队列的头部窃取；执行中不再新增任务，所有队列都空时线程退出
+ * 调用线程也作为0号工作线程参与执行，返回时所有任务都已完成
+ */
+void runWorkStealing(size_t jobCount, int threadCount, const std::function<void(size_t)>& job);
+
+#endif
@@ -0,0 +1,238 @@
+#include "vm.h"
+#include <climits>
+
+/** 字节码生成流程：
+ * 1.逐条翻译四元式，标号不占指令，记录标号对应的指令下标
+ * 2.开启超指令时做窥孔合并：
+ *   - 运算结果只被紧随的复写使用：Op a b t; = t x 合并为 Op a b x，x 为 x±k 时进一步变为 ADDI x k
+ *   - 比较结果只被紧随的条件跳转使用：Lt a b t; jeq t 1 L 合并为 JLT a b L（按假跳转为 JGE，Eq 同理）
+ *   - ADDI x k 后紧跟 JLT x n L（旋转后的 While 回边）：ADDI 改为 ADDI_JLT，原 JLT 保留作为标号的落点
+ * 3.回填跳转目标
+ */
+
+static const char* vmOpName(VMOpCode op) {
+    static const char* const names[] = {"mov", "add", "sub", "mul", "lt",  "eq",  "shl",  "jmp",
+                                        "jlt", "jeq", "jne", "halt", "jge", "addi", "addi_jlt"};
+    return names[op];
+}
+
+static bool isVMJump(VMOpCode op) {
+    return (op >= VM_JMP && op <= VM_JNE) || op == VM_JGE || op == VM_ADDI_JLT;
+}
+
+static_assert(VM_SHL - VM_ADD == OP_SHL - OP_ADD, "运算类指令须与 OpCode 顺序一致");
+
+Bytecode compileBytecode(const IRProgram& ir, bool superinstructions) {
+    Bytecode bc;
+    size_t n = ir.size();
+    bc.varSlots = ir.context->slotCount();
+    bc.initialRegisters.assign(bc.varSlots + ir.tempCount, 0);
+    std::vector<int32_t> intReg(ir.intPool.size(), -1), strReg(ir.context->constantTable.size(), -1);
+    auto constReg = [&](int32_t& r, int64_t value) {
+        if (r < 0) {
+            r = bc.initialRegisters.size();
+            bc.initialRegisters.push_back(value);
+        }
+        return r;
+    };
+    auto reg = [&](Operand o) -> int32_t {
+        switch (o.kind()) {
+            case OPD_VAR: return o.index();
+            case OPD_TEMP: return bc.varSlots + o.index();
+            case OPD_INT: return constReg(intReg[o.index()], ir.intPool[o.index()]);
+            case OPD_STR: return constReg(strReg[o.index()], o.index() + 1);
+            default: return 0;
+        }
+    };
+
+    // 临时变量的读取次数，只被读一次的才能在合并后省去
+    std::vector<int> tempUses(ir.tempCount, 0);
+    for (size_t q = 0; q < n; ++q) {
+        for (Operand o : {ir.arg1[q], ir.arg2[q]}) {
+            if (o.kind() == OPD_TEMP) ++tempUses[o.index()];
+        }
+    }
+    auto usedOnlyBy = [&](size_t q, size_t next) {
+        return next < n && ir.result[q].kind() == OPD_TEMP && tempUses[ir.result[q].index()] == 1 &&
+               ir.arg1[next] == ir.result[q];
+    };
+    auto smallInt = [&](Operand o, int64_t& value) {
+        if (o.kind() != OPD_INT) return false;
+        value = ir.intPool[o.index()];
+        return value > INT32_MIN && value <= INT32_MAX;
+    };
+
+    std::vector<int32_t> labelPc(ir.labelCount, 0);
+    for (size_t q = 0; q < n; ++q) {
+        OpCode op = ir.ops[q];
+        VMInstr ins;
+        switch (op) {
+            case OP_LABEL:
+                labelPc[ir.result[q].index()] = bc.code.size();
+                continue;
+            case OP_ASSIGN:
+                ins.op = VM_MOV;
+                ins.a = reg(ir.arg1[q]);
+                ins.c = reg(ir.result[q]);
+                break;
+            case OP_JMP:
+                ins.op = VM_JMP;
+                ins.d = ir.result[q].index();
+                break;
+            case OP_JLT:
+            case OP_JEQ:
+            case OP_JNE:
+                ins.op = op == OP_JLT ? VM_JLT : op == OP_JEQ ? VM_JEQ : VM_JNE;
+                ins.a = reg(ir.arg1[q]);
+                ins.b = reg(ir.arg2[q]);
+                ins.d = ir.result[q].index();
+                break;
+            default: {
+                ins.op = (VMOpCode)(VM_ADD + (op - OP_ADD));
+                ins.a = reg(ir.arg1[q]);
+                ins.b = reg(ir.arg2[q]);
+                ins.c = reg(ir.result[q]);
+                if (!superinstructions) break;
+                int64_t k;
+                if ((op == OP_LT || op == OP_EQ) && usedOnlyBy(q, q + 1) &&
+                    (ir.ops[q + 1] == OP_JEQ || ir.ops[q + 1] == OP_JNE) && smallInt(ir.arg2[q + 1], k) &&
+                    (k == 0 || k == 1)) {
+                    bool jumpIfTrue = (ir.ops[q + 1] == OP_JEQ) == (k == 1);
+                    ins.op = op == OP_LT ? (jumpIfTrue ? VM_JLT : VM_JGE) : (jumpIfTrue ? VM_JEQ : VM_JNE);
+                    ins.d = ir.result[++q].index();
+                } else if (usedOnlyBy(q, q + 1) && ir.ops[q + 1] == OP_ASSIGN) {
+                    Operand x = ir.result[++q];
+                    ins.c = reg(x);
+                    if (op == OP_ADD && ir.arg1[q - 1] == x && smallInt(ir.arg2[q - 1], k)) {
+                        ins = {VM_ADDI, ins.c, (int32_t)k};
+                    } else if (op == OP_ADD && ir.arg2[q - 1] == x && smallInt(ir.arg1[q - 1], k)) {
+                        ins = {VM_ADDI, ins.c, (int32_t)k};
+                    } else if (op == OP_SUB && ir.arg1[q - 1] == x && smallInt(ir.arg2[q - 1], k)) {
+                        ins = {VM_ADDI, ins.c, (int32_t)-k};
+                    }
+                }
+                break;
+            }
+        }
+        bc.code.push_back(ins);
+    }
+    bc.code.push_back(VMInstr());
+    if (superinstructions) {
+        for (size_t p = 0; p + 1 < bc.code.size(); ++p) {
+            VMInstr& inc = bc.code[p];
+            const VMInstr& branch = bc.code[p + 1];
+            if (inc.op == VM_ADDI && branch.op == VM_JLT && branch.a == inc.a) {
+                inc.op = VM_ADDI_JLT;
+                inc.c = branch.b;
+                inc.d = branch.d;
+            }
+        }
+    }
+    for (VMInstr& ins : bc.code) {
+        if (isVMJump(ins.op)) ins.d = labelPc[ins.d];
+    }
+    return bc;
+}
+
+// 按64位补码回绕的运算
+static inline int64_t wrapAdd(int64_t a, int64_t b) { return (int64_t)((uint64_t)a + (uint64_t)b); }
+static inline int64_t wrapSub(int64_t a, int64_t b) { return (int64_t)((uint64_t)a - (uint64_t)b); }
+static inline int64_t wrapMul(int64_t a, int64_t b) { return (int64_t)((uint64_t)a * (uint64_t)b); }
+static inline int64_t wrapShl(int64_t a, int64_t b) { return (int64_t)((uint64_t)a << (b & 63)); }
+
+std::vector<int64_t> runBytecode(const Bytecode& bc) {
+    struct Threaded {
+        const void* handler;
+        int32_t a, b, c, d;
+    };
+    // 与 VMOpCode 顺序一致
+    static const void* const handlers[VM_OP_COUNT] = {&&op_mov, &&op_add,  &&op_sub, &&op_mul, &&op_lt,
+                                                      &&op_eq,  &&op_shl,  &&op_jmp, &&op_jlt, &&op_jeq,
+                                                      &&op_jne, &&op_halt, &&op_jge, &&op_addi, &&op_addi_jlt};
+    std::vector<Threaded> code(bc.code.size());
+    for (size_t p = 0; p < code.size(); ++p) {
+        const VMInstr& ins = bc.code[p];
+        code[p] = {handlers[ins.op], ins.a, ins.b, ins.c, ins.d};
+    }
+    std::vector<int64_t> registers = bc.initialRegisters;
+    int64_t* r = registers.data();
+    const Threaded* base = code.data();
+    const Threaded* ip = base;
+
+#define DISPATCH() goto *ip->handler
+#define NEXT() \
+    ++ip;      \
+    DISPATCH()
+
+    DISPATCH();
+op_mov:
+    r[ip->c] = r[ip->a];
+    NEXT();
+op_add:
+    r[ip->c] = wrapAdd(r[ip->a], r[ip->b]);
+    NEXT();
+op_sub:
+    r[ip->c] = wrapSub(r[ip->a], r[ip->b]);
+    NEXT();
+op_mul:
+    r[ip->c] = wrapMul(r[ip->a], r[ip->b]);
+    NEXT();
+op_shl:
+    r[ip->c] = wrapShl(r[ip->a], r[ip->b]);
+    NEXT();
+op_lt:
+    r[ip->c] = r[ip->a] < r[ip->b];
+    NEXT();
+op_eq:
+    r[ip->c] = r[ip->a] == r[ip->b];
+    NEXT();
+op_jmp:
+    ip = base + ip->d;
+    DISPATCH();
+op_jlt:
+    ip = r[ip->a] < r[ip->b] ? base + ip->d : ip + 1;
+    DISPATCH();
+op_jeq:
+    ip = r[ip->a] == r[ip->b] ? base + ip->d : ip + 1;
+    DISPATCH();
+op_jne:
+    ip = r[ip->a] != r[ip->b] ? base + ip->d : ip + 1;
+    DISPATCH();
+op_jge:
+    ip = r[ip->a] >= r[ip->b] ? base + ip->d : ip + 1;
+    DISPATCH();
+op_addi:
+    r[ip->a] = wrapAdd(r[ip->a], ip->b);
+    NEXT();
+op_addi_jlt:
+    r[ip->a] = wrapAdd(r[ip->a], ip->b);
+    ip = r[ip->a] < r[ip->c] ? base + ip->d : ip + 2;
+    DISPATCH();
+op_halt:
+#undef NEXT
+#undef DISPATCH
+    return registers;
+}
+
+void writeFinalValues(const IRProgram& ir, const std::vector<int64_t>& registers, std::ostream& out) {
+    std::vector<char> stringVar = stringVariables(ir);
+    for (int id : sourceVariables(ir)) {
+        out << ir.context->slotName(id) << " = ";
+        if (stringVar[id]) {
+            if (registers[id] != 0) out << ir.context->constantTable[registers[id] - 1];
+        } else {
+            out << registers[id];
+        }
+        out << "\n";
+    }
+}
+
+void writeBytecode(const Bytecode& bc, std::ostream& out) {
+    for (size_t p = 0; p < bc.code.size(); ++p) {
+        const VMInstr& ins = bc.code[p];
+        out << p << ": " << vmOpName(ins.op) << " " << ins.a << " " << ins.b << " " << ins.c << " " << ins.d << "\n";
+    }
+    for (size_t i = bc.varSlots; i < bc.initialRegisters.size(); ++i) {
+        if (bc.initialRegisters[i] != 0) out << "r" << i << " = " << bc.initialRegisters[i] << "\n";
+    }
+}
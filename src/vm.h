@@ -0,0 +1,58 @@
+#ifndef VM_H
+#define VM_H
+
+#include "irgen.h"
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/** 寄存器式字节码虚拟机：
+ * 变量、临时变量和常量统一编号为寄存器：变量为其槽位，临时变量 tk 为 varSlots + k，
+ * 其后是执行前装入取值的常量寄存器。字符串以 constantTable 中的 id+1 表示，0 为未赋值（空串）
+ * 解释器用 computed goto（GCC/Clang 扩展）直接线程化分派：执行前把每条指令的操作码换成处理代码的地址
+ */
+
+// 运算类指令与 OpCode 中 OP_ADD..OP_SHL 顺序一致
+enum VMOpCode : uint8_t {
+    VM_MOV,  // r[c] = r[a]
+    VM_ADD,  // r[c] = r[a] + r[b]
+    VM_SUB,  // r[c] = r[a] - r[b]
+    VM_MUL,  // r[c] = r[a] * r[b]
+    VM_LT,   // r[c] = r[a] < r[b]
+    VM_EQ,   // r[c] = r[a] == r[b]
+    VM_SHL,  // r[c] = r[a] << r[b]
+    VM_JMP,  // goto d
+    VM_JLT,  // if (r[a] < r[b]) goto d
+    VM_JEQ,  // if (r[a] == r[b]) goto d
+    VM_JNE,  // if (r[a] != r[b]) goto d
+    VM_HALT, // 结束
+    // 超指令
+    VM_JGE,      // if (r[a] >= r[b]) goto d，由 Lt 与按结果为假跳转合并而来
+    VM_ADDI,     // r[a] += b，由 Add x k t; = t x 合并而来
+    VM_ADDI_JLT, // r[a] += b; if (r[a] < r[c]) goto d，否则跳过下一条（即被合并的 JLT），用于循环回边
+    VM_OP_COUNT
+};
+
+struct VMInstr {
+    VMOpCode op = VM_HALT;
+    int32_t a = 0, b = 0, c = 0, d = 0;
+};
+
+struct Bytecode {
+    std::vector<VMInstr> code;
+    std::vector<int64_t> initialRegisters; // 常量寄存器为其取值，其余为0
+    int varSlots = 0;
+};
+
+// superinstructions 为 false 时逐条翻译四元式（标号不占指令），便于对比超指令的效果
+Bytecode compileBytecode(const IRProgram& ir, bool superinstructions = true);
+
+// 执行字节码，返回结束时的寄存器
+std::vector<int64_t> runBytecode(const Bytecode& bc);
+
+// 按 "名字 = 值" 逐行输出源程序变量的终值，格式与 x86-64 后端生成的程序相同
+void writeFinalValues(const IRProgram& ir, const std::vector<int64_t>& registers, std::ostream& out);
+
+void writeBytecode(const Bytecode& bc, std::ostream& out);
+
+#endif
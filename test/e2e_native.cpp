@@ -0,0 +1,165 @@
+#include "../src/lex.h"
+#include "../src/parser.h"
+#include "../src/semantic.h"
+#include "../src/irgen.h"
+#include "../src/optimizer.h"
+#include "../src/codegen.h"
+#include "../src/cgen.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+/** 端到端测试：源程序分别按 -O0/-O1/-O2 编译为 x86-64 汇编与 C 源码，用 cc（C 源码加 -O2）编译链接并运行，
+ * 把输出的变量终值与直接解释AST得到的参考结果比较
+ * 用法（在 test 目录下）：./e2e_native [源文件，默认 test_parser.txt]
+ */
+
+struct Value {
+    bool isString = false;
+    int64_t number = 0;
+    std::string text;
+
+    std::string toString() const { return isString ? text : std::to_string(number); }
+};
+
+// 参考求值：按源语义直接解释AST，整数运算按64位补码回绕
+class ReferenceEvaluator {
+public:
+    ReferenceEvaluator(const CompilationContext& ctx, const AST& ast) : ctx(ctx), ast(ast) {}
+
+    void exec(NodeId id);
+    Value eval(NodeId id);
+
+    std::map<uint32_t, Value> assigned; // 被赋过值的变量槽位 -> 终值
+
+private:
+    const CompilationContext& ctx;
+    const AST& ast;
+    std::map<uint32_t, Value> vars; // 变量槽位 -> 当前值
+};
+
+Value ReferenceEvaluator::eval(NodeId id) {
+    const ASTNode& node = ast[id];
+    Value v;
+    switch (node.kind) {
+        case NK_INT:
+            v.number = std::strtoll(ctx.constantTable[node.value].c_str(), nullptr, 10);
+            return v;
+        case NK_STR:
+            v.isString = true;
+            v.text = ctx.constantTable[node.value];
+            return v;
+        case NK_VAR:
+            return vars[node.slot];
+        default:
+            break;
+    }
+    Value a = eval(ast.child(node, 0)), b = eval(ast.child(node, 1));
+    uint64_t x = a.number, y = b.number;
+    switch (node.kind) {
+        case NK_ADD: v.number = x + y; break;
+        case NK_SUB: v.number = x - y; break;
+        case NK_MUL: v.number = x * y; break;
+        case NK_LT: v.number = a.number < b.number; break;
+        case NK_EQ: v.number = a.isString ? a.text == b.text : a.number == b.number; break;
+        default: break;
+    }
+    return v;
+}
+
+void ReferenceEvaluator::exec(NodeId id) {
+    const ASTNode& node = ast[id];
+    switch (node.kind) {
+        case NK_PROGRAM:
+        case NK_BLOCK:
+            for (const NodeId* c = ast.childBegin(node); c != ast.childEnd(node); ++c) exec(*c);
+            break;
+        case NK_VAR_DECL:
+        case NK_ASSIGN:
+            if (node.childCount == 0) {
+                vars[node.slot].isString = node.varType == TYPE_STRING;
+                break;
+            }
+            vars[node.slot] = eval(ast.child(node, 0));
+            assigned[node.slot] = vars[node.slot];
+            break;
+        case NK_IF:
+            exec(ast.child(node, eval(ast.child(node, 0)).number != 0 ? 1 : 2));
+            break;
+        case NK_WHILE:
+            while (eval(ast.child(node, 0)).number != 0) exec(ast.child(node, 1));
+            break;
+        default:
+            break;
+    }
+}
+
+/* 生成汇编（viaC 时为 C 源码）后编译、链接并运行，解析 "名字 = 值" 形式的输出：
+ * 第 i 行是 sourceVariables(ir)[i] 的终值，同名不同类型的变量按槽位区分
+ */
+static bool runNative(const IRProgram& ir, bool viaC, std::map<uint32_t, std::string>& output) {
+    std::vector<int> vars = sourceVariables(ir);
+    size_t line = 0;
+    std::string source = viaC ? "e2e_native.c" : "e2e_native.s";
+    std::ofstream fout(source);
+    if (viaC) emitC(ir, fout);
+    else emitAssembly(ir, fout);
+    fout.close();
+    std::string command = (viaC ? "cc -O2 -o e2e_native_prog " : "cc -o e2e_native_prog ") + source;
+    if (std::system(command.c_str()) != 0) return false;
+    FILE* pipe = popen("./e2e_native_prog", "r");
+    if (!pipe) return false;
+    char buffer[4096];
+    while (fgets(buffer, sizeof(buffer), pipe)) {
+        std::string text(buffer);
+        if (!text.empty() && text.back() == '\n') text.pop_back();
+        size_t sep = text.find(" = ");
+        if (sep == std::string::npos || line >= vars.size()) continue;
+        int slot = vars[line++];
+        if (text.substr(0, sep) == ir.context->slotName(slot)) output[slot] = text.substr(sep + 3);
+    }
+    bool ok = pclose(pipe) == 0;
+    std::remove(source.c_str());
+    std::remove("e2e_native_prog");
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputFile = argc > 1 ? argv[1] : "test_parser.txt";
+    CompilationContext ctx;
+    std::vector<Token> tokens = runLexer(ctx, inputFile);
+    AST ast = parse(ctx, tokens);
+    if (ast.root == NO_NODE || !ctx.parseErrors.empty() || !checkSemantics(ctx, ast)) {
+        std::cerr << inputFile << ": 源程序有误\n";
+        return 1;
+    }
+    ReferenceEvaluator reference(ctx, ast);
+    reference.exec(ast.root);
+
+    bool allPassed = true;
+    for (int level = 0; level <= 2; ++level) {
+        IRProgram ir = generateIR(ctx, ast);
+        std::vector<PassStats> stats;
+        std::string error;
+        runPasses(ir, passesForLevel(level), stats, error);
+        for (bool viaC : {false, true}) {
+            std::string label = "-O" + std::to_string(level) + (viaC ? " C" : " 汇编");
+            std::map<uint32_t, std::string> output;
+            bool passed = runNative(ir, viaC, output);
+            if (!passed) std::cerr << label << ": 编译、链接或运行失败\n";
+            for (const auto& kv : reference.assigned) {
+                auto it = output.find(kv.first);
+                if (it == output.end() || it->second != kv.second.toString()) {
+                    std::cerr << label << ": " << ctx.slotName(kv.first) << " 期望 " << kv.second.toString() << "，实际 "
+                              << (it == output.end() ? "(未输出)" : it->second) << "\n";
+                    passed = false;
+                }
+            }
+            std::cout << label << ": " << (passed ? "通过" : "失败") << "（" << reference.assigned.size()
+                      << " 个变量）\n";
+            allPassed = allPassed && passed;
+        }
+    }
+    return allPassed ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+#include "../src/lex.h"
+#include "../src/parser.h"
+#include "../src/context.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+/** 语法分析模糊测试：语料目录中的每个源文件（多为残缺、错误的程序）原样及随机变异 mutants 次后，
+ * 分别做完整语法分析与流式语法分析，检查：
+ *   在 budget 毫秒内结束（不会因某条语句不前进而死循环）
+ *   语法错误数不超过 MAX_PARSE_ERRORS+1，两种分析得到的语法错误完全相同
+ * 另外生成一个约 1MB 的随机token文件，检查它同样在时间预算内结束（错误恢复是线性的）
+ * 变异：截断、删除一段、复制一段、插入随机的关键字/符号片段，随机数由 splitmix64 按 seed 产生
+ * 超时的输入写入 fuzz_hang.txt 后立即以1退出
+ * 用法（在 test 目录下）：./fuzz_parser [--mutants=200] [--seed=1] [--budget=2000] [语料目录或文件...，默认 fuzz 与 .]
+ */
+
+static const char* const FRAGMENTS[] = {"{", "}", "(", ")", ";", "=", "+", "-", "*", "<", "if", "else", "while",
+                                        "int", "String", "x", "1", "\"", "$", "@", "class", "//", "\n"};
+
+struct Random {
+    uint64_t state;
+    uint64_t next() {
+        // splitmix64
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+    size_t below(size_t n) { return n == 0 ? 0 : next() % n; }
+};
+
+static std::string mutate(std::string source, Random& rng) {
+    for (size_t ops = 1 + rng.below(4); ops > 0; --ops) {
+        size_t pos = rng.below(source.size() + 1), len = 1 + rng.below(20);
+        switch (rng.below(4)) {
+            case 0: source.resize(pos); break;
+            case 1: source.erase(pos, len); break;
+            case 2: source.insert(pos, source.substr(pos, len)); break;
+            default:
+                for (size_t n = 1 + rng.below(3); n > 0; --n) {
+                    source.insert(pos, std::string(" ") + FRAGMENTS[rng.below(std::size(FRAGMENTS))] + " ");
+                }
+        }
+    }
+    return source;
+}
+
+static std::string describe(const std::vector<ParseError>& errors) {
+    std::ostringstream out;
+    for (const ParseError& e : errors) out << e.message << "@" << e.line << ":" << e.column << "\n";
+    return out.str();
+}
+
+// 完整分析与流式分析一次，返回发现的问题，没有问题时为空
+static std::string check(const std::string& source, const std::string& tempFile) {
+    std::ostringstream discarded;
+    CompilationContext whole;
+    whole.diagnostics = &discarded;
+    std::vector<Token> tokens = runLexerBuffer(whole, source);
+    parse(whole, tokens);
+
+    {
+        std::ofstream fout(tempFile, std::ios::binary);
+        fout << source;
+    }
+    CompilationContext streamed;
+    streamed.diagnostics = &discarded;
+    LexerCursor cursor(streamed, tempFile);
+    parseStream(streamed, cursor, [](const AST&, NodeId) {});
+
+    if (whole.parseErrors.size() > MAX_PARSE_ERRORS + 1) {
+        return "语法错误数 " + std::to_string(whole.parseErrors.size()) + " 超过上限";
+    }
+    if (describe(whole.parseErrors) != describe(streamed.parseErrors)) return "完整分析与流式分析的语法错误不同";
+    return "";
+}
+
+struct FuzzRunner {
+    std::chrono::milliseconds budget{2000};
+    size_t runs = 0;
+    size_t failures = 0;
+
+    // 在单独的线程中检查，超时说明分析不会结束，只能保存输入后退出进程
+    void run(const std::string& name, const std::string& source) {
+        ++runs;
+        auto result = std::async(std::launch::async, check, source, "fuzz_parser_tmp.txt");
+        if (result.wait_for(budget) == std::future_status::timeout) {
+            std::ofstream("fuzz_hang.txt", std::ios::binary) << source;
+            std::cerr << name << "：超过 " << budget.count() << "ms 未结束，输入已保存到 fuzz_hang.txt\n";
+            std::cerr.flush();
+            std::_Exit(1);
+        }
+        std::string problem = result.get();
+        if (!problem.empty()) {
+            ++failures;
+            std::cerr << name << "：" << problem << "\n";
+        }
+    }
+};
+
+static std::string readFile(const std::filesystem::path& path) {
+    std::ifstream fin(path, std::ios::binary);
+    std::ostringstream content;
+    content << fin.rdbuf();
+    return content.str();
+}
+
+int main(int argc, char* argv[]) {
+    size_t mutants = 200;
+    uint64_t seed = 1;
+    FuzzRunner runner;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 10, "--mutants=") == 0) mutants = std::strtoull(arg.c_str() + 10, nullptr, 10);
+        else if (arg.compare(0, 7, "--seed=") == 0) seed = std::strtoull(arg.c_str() + 7, nullptr, 10);
+        else if (arg.compare(0, 9, "--budget=") == 0) runner.budget = std::chrono::milliseconds(std::atoi(arg.c_str() + 9));
+        else inputs.push_back(arg);
+    }
+    if (inputs.empty()) inputs = {"fuzz", "."};
+
+    std::vector<std::filesystem::path> files;
+    for (const std::string& input : inputs) {
+        if (!std::filesystem::is_directory(input)) {
+            files.push_back(input);
+            continue;
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(input)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".txt") files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    Random rng{seed};
+    for (const auto& file : files) {
+        if (file.filename() == "fuzz_hang.txt" || file.filename() == "fuzz_parser_tmp.txt") continue;
+        std::string source = readFile(file);
+        runner.run(file.string(), source);
+        for (size_t i = 0; i < mutants; ++i) runner.run(file.string() + " 变异#" + std::to_string(i), mutate(source, rng));
+    }
+
+    // 约 1MB 的随机token：大量错误，检查错误上限与分析时间
+    std::string garbage = "class Main { public static void main(String[] args) {\n";
+    while (garbage.size() < (1 << 20)) {
+        garbage += FRAGMENTS[rng.below(std::size(FRAGMENTS))];
+        garbage += ' ';
+    }
+    runner.run("随机token(1MB)", garbage);
+
+    std::remove("fuzz_parser_tmp.txt");
+    std::cout << files.size() << " 个语料文件，" << runner.runs << " 次分析，" << runner.failures << " 个失败\n";
+    return runner.failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+#include "../src/lex.h"
+#include "../src/parser.h"
+#include "../src/semantic.h"
+#include "../src/irgen.h"
+#include "../src/optimizer.h"
+#include "../src/vm.h"
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+/** 优化器回归测试：每个用例的源程序分别按 -O0 与 -O2 编译后在虚拟机中运行，变量终值须逐行相同，
+ * 部分用例另外检查 -O2 的IR
+ * 用法（在 test 目录下）：./regress_optimizer
+ */
+
+struct Case {
+    const char* name;
+    const char* body; // main 的函数体
+    std::function<std::string(const IRProgram&)> check; // 返回空串表示通过，否则为错误说明；可为空
+};
+
+// 写入优化器引入的变量的四元式条数
+static int syntheticWrites(const IRProgram& ir) {
+    int count = 0;
+    for (size_t q = 0; q < ir.size(); ++q) {
+        Operand r = ir.result[q];
+        if (ir.ops[q] != OP_LABEL && !isJump(ir.ops[q]) && r.kind() == OPD_VAR &&
+            ir.context->isSynthetic(r.index())) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+static const Case CASES[] = {
+    // 强度削弱引入的累加变量不在程序结束时输出，乘法的结果无用时累加变量连同其初始化一起删除
+    {"dead-strength-reduction",
+     "int i = 0; int z = 0; while (i < 10) { z = i * 3; i = i + 1; } z = 0;",
+     [](const IRProgram& ir) {
+         int writes = syntheticWrites(ir);
+         return writes == 0 ? std::string() : "仍有 " + std::to_string(writes) + " 条四元式写入累加变量";
+     }},
+    // 累加变量仍被使用时保留
+    {"live-strength-reduction",
+     "int i = 0; int z = 0; while (i < 10) { z = z + i * 3; i = i + 1; }", nullptr},
+    // 回绕得到的 INT64_MIN/INT64_MAX 作乘数，化简 c±1 时不得有符号溢出（用 -fsanitize=undefined 构建时检查）
+    {"multiply-by-int64-extremes",
+     "int m = 0 - 9223372036854775807 - 1; int y = 5; int w = 3; int i = 0;"
+     " while (i < 3) { y = y * m + i; w = w * (m - 1) + i; i = i + 1; }",
+     nullptr},
+};
+
+static bool compile(const std::string& source, int level, CompilationContext& ctx, IRProgram& ir) {
+    std::vector<Token> tokens = runLexerBuffer(ctx, source);
+    AST ast = parse(ctx, tokens);
+    if (ast.root == NO_NODE || !ctx.parseErrors.empty() || !checkSemantics(ctx, ast)) return false;
+    ir = generateIR(ctx, ast);
+    std::vector<PassStats> stats;
+    std::string error;
+    return runPasses(ir, passesForLevel(level), stats, error);
+}
+
+int main() {
+    bool allPassed = true;
+    for (const Case& c : CASES) {
+        std::string source = std::string("class Main {\n    public static void main(String[] args) {\n        ") +
+                             c.body + "\n    }\n}\n$\n";
+        std::string values[2], failure;
+        CompilationContext ctx[2];
+        IRProgram ir[2];
+        for (int i = 0; i < 2 && failure.empty(); ++i) {
+            std::ostringstream discarded;
+            ctx[i].diagnostics = &discarded;
+            if (!compile(source, i * 2, ctx[i], ir[i])) {
+                failure = "-O" + std::to_string(i * 2) + " 编译失败";
+                break;
+            }
+            std::ostringstream out;
+            writeFinalValues(ir[i], runBytecode(compileBytecode(ir[i])), out);
+            values[i] = out.str();
+        }
+        if (failure.empty() && values[0] != values[1]) failure = "-O2 的变量终值与 -O0 不同";
+        if (failure.empty() && c.check) failure = c.check(ir[1]);
+        std::cout << c.name << ": " << (failure.empty() ? "通过" : "失败，" + failure) << "\n";
+        allPassed = allPassed && failure.empty();
+    }
+    return allPassed ? 0 : 1;
+}
@@ -0,0 +1,238 @@
+#include "../src/lex.h"
+#include "../src/parser.h"
+#include "../src/semantic.h"
+#include "../src/irgen.h"
+#include "../src/ast_visualize.h"
+#include "../src/context.h"
+#include "../src/driver.h"
+#include "../src/optimizer.h"
+#include "../src/stats.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <pthread.h>
+#include <sstream>
+
+/** 深层嵌套压力测试：生成嵌套 depth 层的 {} 块、括号、左结合长链、右嵌套乘法、if/else、while、带 {} 的 while，
+ * 1.前端：在栈只有 1MB 的线程中依次运行词法分析、语法分析、语义分析、IR生成与 ast.dot 导出，
+ *   检查没有错误、节点数与四元式数符合预期，且 depth 层的耗时不超过 depth/10 层的 30 倍（线性增长约为10倍）
+ * 2.完整编译：同样在 1MB 栈的线程中对嵌套 pipeline 层的程序调用 compileFile，分别使用默认选项、-O2、--run、--jit，
+ *   写出全部默认输出（tokens、符号表、ast.dot、ir.txt、cfg.txt 等），检查执行结果中 x 的终值，
+ *   且耗时与堆分配字节数都不超过 pipeline/10 层的 30 倍
+ * 任何一步递归深度与嵌套层数相关时都会在 1MB 的栈上溢出
+ * 用法（在 test 目录下）：./stress_nesting [depth，默认1000000] [pipeline，默认100000]
+ */
+
+static const size_t STACK_SIZE = 1 << 20;
+
+struct StressCase {
+    const char* name;
+    // 生成嵌套 depth 层的 main 方法体（不含外层 {}）
+    std::string (*body)(size_t depth);
+    // 期望的 AST 节点数与四元式数
+    size_t (*nodes)(size_t depth);
+    size_t (*quads)(size_t depth);
+    // 执行后 x 的终值
+    size_t (*value)(size_t depth);
+};
+
+static std::string repeat(const std::string& text, size_t n) {
+    std::string out;
+    out.reserve(text.size() * n);
+    for (size_t i = 0; i < n; ++i) out += text;
+    return out;
+}
+
+// 节点数：Program、main 的 Block、int x = 0 的 VarDecl 与 Int，再加上各用例自己的节点
+static const size_t BASE_NODES = 4;
+
+static size_t one(size_t) { return 1; }
+
+static const StressCase CASES[] = {
+    {"blocks", [](size_t d) { return repeat("{", d) + "x = 1;" + repeat("}", d); },
+     [](size_t d) { return BASE_NODES + d + 2; }, [](size_t) -> size_t { return 2; }, one},
+    {"parens", [](size_t d) { return "x = " + repeat("(", d) + "1" + repeat(")", d) + ";"; },
+     [](size_t) -> size_t { return BASE_NODES + 2; }, [](size_t) -> size_t { return 2; }, one},
+    {"chain", [](size_t d) { return "x = x" + repeat(" + 1", d) + ";"; },
+     [](size_t d) { return BASE_NODES + 2 * d + 2; }, [](size_t d) { return d + 2; }, [](size_t d) { return d; }},
+    {"right", [](size_t d) { return "x = " + repeat("x * (", d) + "1" + repeat(")", d) + ";"; },
+     [](size_t d) { return BASE_NODES + 2 * d + 2; }, [](size_t d) { return d + 2; },
+     [](size_t) -> size_t { return 0; }},
+    {"if", [](size_t d) { return repeat("if (x < 1) ", d) + "x = 1;" + repeat(" else x = 2;", d); },
+     [](size_t d) { return BASE_NODES + 6 * d + 2; }, [](size_t d) { return 5 * d + 2; }, one},
+    {"while", [](size_t d) { return repeat("while (x < 1) ", d) + "x = x + 1;"; },
+     [](size_t d) { return BASE_NODES + 4 * d + 4; }, [](size_t d) { return 4 * d + 3; }, one},
+    {"loops", [](size_t d) { return repeat("while (x < 1) {", d) + "x = x + 1;" + repeat("}", d); },
+     [](size_t d) { return BASE_NODES + 5 * d + 4; }, [](size_t d) { return 4 * d + 3; }, one},
+};
+
+// 完整编译使用的选项组合
+struct PipelineMode {
+    const char* name;
+    CompileOptions options;
+};
+
+static std::vector<PipelineMode> pipelineModes() {
+    std::vector<PipelineMode> modes(4);
+    modes[0].name = "默认";
+    modes[1].name = "-O2";
+    modes[1].options.passes = passesForLevel(2);
+    modes[2].name = "--run";
+    modes[2].options.run = true;
+    modes[3].name = "--jit";
+    modes[3].options.jit = true;
+    return modes;
+}
+
+struct StressRun {
+    const StressCase* test;
+    size_t depth;
+    const PipelineMode* mode = nullptr; // 为空时只运行前端
+    bool ok = false;
+    std::string error;
+    double ms = 0;
+    uint64_t allocBytes = 0;
+};
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::string programText(const StressRun& run) {
+    return "class Main {\n    public static void main(String[] args) {\n        int x = 0;\n" + run.test->body(run.depth) +
+           "\n    }\n}\n$\n";
+}
+
+static void runFrontEnd(StressRun& run) {
+    std::string source = programText(run);
+    std::ostringstream diagnostics;
+    CompilationContext ctx;
+    ctx.diagnostics = &diagnostics;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Token> tokens = runLexerBuffer(ctx, source);
+    AST ast = parse(ctx, tokens);
+    checkSemantics(ctx, ast);
+    if (!ctx.lexErrors.empty() || !ctx.parseErrors.empty() || ctx.semanticErrors > 0) {
+        printParseErrors(ctx);
+        run.error = "分析出错：" + diagnostics.str();
+        return;
+    }
+    IRProgram ir = generateIR(ctx, ast);
+    std::string dotFile = "stress_nesting_" + std::string(run.test->name) + ".dot";
+    exportASTtoDot(ctx, ast, dotFile);
+    run.ms = elapsedMs(start);
+    std::remove(dotFile.c_str());
+
+    if (ast.nodes.size() != run.test->nodes(run.depth)) {
+        run.error = "AST节点数 " + std::to_string(ast.nodes.size()) + "，期望 " +
+                    std::to_string(run.test->nodes(run.depth));
+    } else if (ir.size() != run.test->quads(run.depth)) {
+        run.error = "四元式数 " + std::to_string(ir.size()) + "，期望 " + std::to_string(run.test->quads(run.depth));
+    } else {
+        run.ok = true;
+    }
+}
+
+// 源文件与输出目录放在 test 目录下，结束后删除
+static void runPipeline(StressRun& run) {
+    std::string base = "stress_nesting_" + std::string(run.test->name);
+    std::string inputPath = base + ".txt", outDir = base + "_out";
+    {
+        std::ofstream file(inputPath, std::ios::binary);
+        file << programText(run);
+    }
+    std::filesystem::create_directories(outDir);
+    std::ostringstream out, diagnostics;
+    uint64_t bytesStart = threadAllocBytes;
+    auto start = std::chrono::steady_clock::now();
+    int status = compileFile(inputPath, outDir, run.mode->options, out, diagnostics);
+    run.ms = elapsedMs(start);
+    run.allocBytes = threadAllocBytes - bytesStart;
+    std::filesystem::remove_all(outDir);
+    std::remove(inputPath.c_str());
+
+    std::string expected = "x = " + std::to_string(run.test->value(run.depth)) + "\n";
+    bool executes = run.mode->options.run || run.mode->options.jit;
+    if (status != 0) {
+        run.error = "退出码 " + std::to_string(status) + "：" + diagnostics.str();
+    } else if (executes && out.str().compare(0, expected.size(), expected) != 0) {
+        run.error = "执行结果 " + out.str().substr(0, 64) + "，期望 " + expected;
+    } else {
+        run.ok = true;
+    }
+}
+
+// 在栈大小为 STACK_SIZE 的线程中运行
+static bool runOnSmallStack(StressRun& run) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, STACK_SIZE);
+    pthread_t thread;
+    auto entry = [](void* arg) -> void* {
+        StressRun& run = *static_cast<StressRun*>(arg);
+        if (run.mode) runPipeline(run);
+        else runFrontEnd(run);
+        return nullptr;
+    };
+    bool started = pthread_create(&thread, &attr, entry, &run) == 0;
+    pthread_attr_destroy(&attr);
+    if (started) pthread_join(thread, nullptr);
+    return started;
+}
+
+static double ratioOf(double large, double small) {
+    return large / std::max(small, 0.001);
+}
+
+int main(int argc, char* argv[]) {
+    size_t depth = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t pipeline = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000;
+    bool allPassed = true;
+    std::cout << "前端，嵌套 " << depth << " 层\n";
+    std::cout << std::left << std::setw(10) << "用例" << std::right << std::setw(14) << "depth/10(ms)"
+              << std::setw(14) << "depth(ms)" << std::setw(10) << "倍数" << "\n";
+    for (const StressCase& test : CASES) {
+        StressRun small{&test, depth / 10}, large{&test, depth};
+        if (!runOnSmallStack(small) || !runOnSmallStack(large)) {
+            std::cerr << "无法创建线程\n";
+            return 1;
+        }
+        double ratio = ratioOf(large.ms, small.ms);
+        bool passed = small.ok && large.ok && ratio < 30;
+        std::cout << std::left << std::setw(10) << test.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << small.ms << std::setw(14) << large.ms << std::setw(10) << ratio
+                  << (passed ? "  通过" : "  失败") << "\n";
+        if (!small.ok) std::cerr << test.name << " depth/10: " << small.error << "\n";
+        if (!large.ok) std::cerr << test.name << " depth: " << large.error << "\n";
+        allPassed = allPassed && passed;
+    }
+
+    std::vector<PipelineMode> modes = pipelineModes();
+    std::cout << "\n完整编译（compileFile），嵌套 " << pipeline << " 层\n";
+    std::cout << std::left << std::setw(10) << "用例" << std::setw(8) << "选项" << std::right << std::setw(14)
+              << "pipe/10(ms)" << std::setw(14) << "pipe(ms)" << std::setw(10) << "耗时倍数" << std::setw(14)
+              << "pipe(MB)" << std::setw(10) << "分配倍数" << "\n";
+    for (const StressCase& test : CASES) {
+        for (const PipelineMode& mode : modes) {
+            StressRun small{&test, pipeline / 10, &mode}, large{&test, pipeline, &mode};
+            if (!runOnSmallStack(small) || !runOnSmallStack(large)) {
+                std::cerr << "无法创建线程\n";
+                return 1;
+            }
+            double timeRatio = ratioOf(large.ms, small.ms);
+            double allocRatio = ratioOf(large.allocBytes, small.allocBytes);
+            bool passed = small.ok && large.ok && timeRatio < 30 && allocRatio < 30;
+            std::cout << std::left << std::setw(10) << test.name << std::setw(8) << mode.name << std::right
+                      << std::fixed << std::setprecision(1) << std::setw(14) << small.ms << std::setw(14) << large.ms
+                      << std::setw(10) << timeRatio << std::setw(14) << large.allocBytes / 1048576.0 << std::setw(10)
+                      << allocRatio << (passed ? "  通过" : "  失败") << "\n";
+            if (!small.ok) std::cerr << test.name << " " << mode.name << " pipeline/10: " << small.error << "\n";
+            if (!large.ok) std::cerr << test.name << " " << mode.name << " pipeline: " << large.error << "\n";
+            allPassed = allPassed && passed;
+        }
+    }
+    return allPassed ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+#include "../src/binary.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/** 二进制容器 out.mjb 的读取/转储工具：
+ * 不带节名时列出各节的记录数与字节数；带节名时按对应文本文件的格式输出该节，
+ * 输出与 --emit=text 写出的 tokens.txt、identifier_table.txt、constant_table.txt、ast.dot、ir.txt 逐字节相同
+ * 用法：./mjdump <out.mjb> [tokens|identifiers|constants|ast|ir]
+ */
+
+static void dumpTokens(const BinaryFile& file, const BinSection& s) {
+    const BinToken* tokens = file.records<BinToken>(s);
+    for (uint64_t i = 0; i < s.count; ++i) std::cout << tokens[i].type << " " << tokens[i].value << "\n";
+}
+
+static void dumpStrings(const BinaryFile& file, const BinSection& s) {
+    for (uint64_t i = 0; i < s.count; ++i) std::cout << i << ": " << file.string(s, i) << "\n";
+}
+
+// 与 exportASTtoDot 相同的先序编号，用显式栈代替递归；损坏的文件中子节点可能成环，输出的节点数不超过节点总数
+static void dumpDotNodes(const BinaryFile& file, const BinSection& nodes, const BinSection& children,
+                         const BinSection& identifiers, const BinSection& constants, uint32_t root) {
+    const uint32_t* childList = file.records<uint32_t>(children);
+    std::vector<std::pair<uint32_t, int>> stack = {{root, -1}};
+    int nodeCounter = 0;
+    while (!stack.empty() && (uint64_t)nodeCounter < nodes.count) {
+        uint32_t id = stack.back().first;
+        int parentId = stack.back().second;
+        stack.pop_back();
+        if (id == NO_NODE || id >= nodes.count) continue;
+        const BinNode& node = file.records<BinNode>(nodes)[id];
+        int myId = nodeCounter++;
+        std::cout << "  node" << myId << " [label=\"" << nodeKindName((NodeKind)node.kind);
+        if (node.value >= 0) {
+            bool constant = node.kind == NK_INT || node.kind == NK_STR;
+            const BinSection& table = constant ? constants : identifiers;
+            if ((uint64_t)node.value < table.count && !file.string(table, node.value).empty()) {
+                std::cout << "\\n" << file.string(table, node.value);
+            }
+        }
+        std::cout << "\"]\n";
+        if (parentId != -1) std::cout << "  node" << parentId << " -> node" << myId << "\n";
+        uint64_t end = std::min<uint64_t>((uint64_t)node.firstChild + node.childCount, children.count);
+        for (uint64_t i = end; i > node.firstChild; --i) stack.push_back({childList[i - 1], myId});
+    }
+}
+
+// 变量的槽位在 slots 节的范围内时取额外槽位的名字，否则为标识符；
+// 下标超出对应节的记录数时（文件损坏）返回false，并在 error 中说明
+static bool operandText(const BinaryFile& file, const BinSection& identifiers, const BinSection* slots,
+                        const BinSection& constants, const BinSection& intPool, uint32_t bits, std::string& text,
+                        std::string& error) {
+    Operand o;
+    o.bits = bits;
+    uint64_t index = o.index();
+    const BinSection* table = nullptr;
+    switch (o.kind()) {
+        case OPD_VAR:
+            if (slots && index >= slots->aux0) {
+                index -= slots->aux0;
+                table = slots;
+            } else {
+                table = &identifiers;
+            }
+            break;
+        case OPD_STR: table = &constants; break;
+        case OPD_INT:
+            if (index >= intPool.count) {
+                error = "下标 " + std::to_string(index) + " 超出 int_pool 节的 " + std::to_string(intPool.count) +
+                        " 项";
+                return false;
+            }
+            text = std::to_string(file.records<int64_t>(intPool)[index]);
+            return true;
+        case OPD_TEMP: text = "t" + std::to_string(index); return true;
+        case OPD_LABEL: text = "L" + std::to_string(index); return true;
+        default: text.clear(); return true;
+    }
+    if (index >= table->count) {
+        error = "下标 " + std::to_string(index) + " 超出 " + sectionName(table->kind) + " 节的 " +
+                std::to_string(table->count) + " 项";
+        return false;
+    }
+    text = std::string(file.string(*table, index));
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "用法: ./mjdump <out.mjb> [tokens|identifiers|constants|ast|ir]\n";
+        return 1;
+    }
+    BinaryFile file;
+    std::string error;
+    if (!file.open(argv[1], error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    std::string name = argc > 2 ? argv[2] : "";
+    if (name.empty()) {
+        std::cout << "版本 " << BIN_VERSION << "，" << file.sectionCount() << " 个节\n";
+        for (uint32_t i = 0; i < file.sectionCount(); ++i) {
+            const BinSection& s = file.sectionAt(i);
+            std::cout << sectionName(s.kind) << " " << s.count << " 项 " << s.size << " 字节\n";
+        }
+        return 0;
+    }
+
+    const BinSection* tokens = file.section(SEC_TOKENS);
+    const BinSection* identifiers = file.section(SEC_IDENTIFIERS);
+    const BinSection* constants = file.section(SEC_CONSTANTS);
+    const BinSection* nodes = file.section(SEC_AST);
+    const BinSection* children = file.section(SEC_AST_CHILDREN);
+    const BinSection* ir = file.section(SEC_IR);
+    const BinSection* intPool = file.section(SEC_INT_POOL);
+    const BinSection* slots = file.section(SEC_SLOTS);
+    if (name == "tokens" && tokens) dumpTokens(file, *tokens);
+    else if (name == "identifiers" && identifiers) dumpStrings(file, *identifiers);
+    else if (name == "constants" && constants) dumpStrings(file, *constants);
+    else if (name == "ast" && nodes && children && identifiers && constants) {
+        std::cout << "digraph AST {\n  node [shape=box, style=filled, fillcolor=lightgray];\n";
+        dumpDotNodes(file, *nodes, *children, *identifiers, *constants, nodes->aux0);
+        std::cout << "}\n";
+    } else if (name == "ir" && ir && intPool && identifiers && constants) {
+        const BinQuad* quads = file.records<BinQuad>(*ir);
+        for (uint64_t i = 0; i < ir->count; ++i) {
+            std::string text[3], error;
+            const uint32_t operands[3] = {quads[i].arg1, quads[i].arg2, quads[i].result};
+            for (int k = 0; k < 3; ++k) {
+                if (!operandText(file, *identifiers, slots, *constants, *intPool, operands[k], text[k], error)) {
+                    std::cerr << "第 " << i << " 条四元式已损坏: " << error << "\n";
+                    return 1;
+                }
+            }
+            std::cout << opName((OpCode)quads[i].op) << " " << text[0] << " " << text[1] << " " << text[2] << "\n";
+        }
+    } else {
+        std::cerr << "文件中没有节: " << name << "\n";
+        return 1;
+    }
+    return 0;
+}